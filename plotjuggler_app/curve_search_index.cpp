@@ -0,0 +1,369 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "curve_search_index.h"
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+
+#include "PlotJuggler/plotdatabase.h"
+
+namespace
+{
+uint64_t TrigramKey(const QChar* str)
+{
+  return (uint64_t(str[0].unicode()) << 32) | (uint64_t(str[1].unicode()) << 16) |
+         uint64_t(str[2].unicode());
+}
+
+QString WildcardToRegex(const QString& pattern)
+{
+  QString regex;
+  for (const QChar& c : pattern)
+  {
+    if (c == '*')
+    {
+      regex += ".*";
+    }
+    else if (c == '?')
+    {
+      regex += ".";
+    }
+    else
+    {
+      regex += QRegularExpression::escape(QString(c));
+    }
+  }
+  return regex;
+}
+
+// Literal runs of a regular expression that are mandatory in any match.
+// This is conservative: if in doubt, nothing is returned.
+QStringList RegexLiterals(const QString& regex)
+{
+  if (regex.contains('|'))
+  {
+    return {};
+  }
+  static const QString special_chars = "\\.[](){}^$?*+";
+
+  QStringList literals;
+  QString current;
+  // depth of (), [] and {} blocks: their content is ignored. The body of a {m,n}
+  // quantifier isn't part of the names; if no literal is left, the caller scans all of them
+  int depth = 0;
+
+  auto flush = [&]() {
+    if (current.size() >= 3)
+    {
+      literals.push_back(current);
+    }
+    current.clear();
+  };
+
+  for (int i = 0; i < regex.size(); i++)
+  {
+    const QChar c = regex[i];
+    const QChar next = (i + 1 < regex.size()) ? regex[i + 1] : QChar();
+    const bool next_is_quantifier = (next == '?' || next == '*' || next == '{');
+
+    if (c == '(' || c == '[' || c == '{')
+    {
+      depth++;
+      flush();
+    }
+    else if (c == ')' || c == ']' || c == '}')
+    {
+      depth = std::max(0, depth - 1);
+      flush();
+    }
+    else if (depth > 0)
+    {
+      continue;
+    }
+    else if (c == '\\')
+    {
+      // the operand of \x41, \u0041, \101, \p{L}, \k<name>, \Q...\E and similar escapes
+      // is not parsed: only the literals found before them are returned.
+      // Case insensitive, because the caller may pass the pattern in lower case
+      static const QString escapes_with_operand = "xuopnkgqc";
+      if (next.isDigit() || (!next.isNull() && escapes_with_operand.contains(next.toLower())))
+      {
+        break;
+      }
+      // escaped punctuation is a literal, anything else (\d, \w, ...) is a class
+      if (next.isPunct() && !(i + 2 < regex.size() && (regex[i + 2] == '?' ||
+                                                        regex[i + 2] == '*' ||
+                                                        regex[i + 2] == '{')))
+      {
+        current += next;
+      }
+      else
+      {
+        flush();
+      }
+      i++;
+    }
+    else if (special_chars.contains(c) || next_is_quantifier)
+    {
+      flush();
+    }
+    else
+    {
+      current += c;
+    }
+  }
+  flush();
+  return literals;
+}
+
+void IntersectSorted(std::vector<int>& a, const std::vector<int>& b)
+{
+  std::vector<int> out;
+  out.reserve(std::min(a.size(), b.size()));
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+  a.swap(out);
+}
+
+}  // namespace
+
+void CurveSearchIndex::clear()
+{
+  _names.clear();
+  _removed.clear();
+  _trigrams.clear();
+  _results.clear();
+}
+
+int CurveSearchIndex::add(const QString& name)
+{
+  const int id = int(_names.size());
+  _names.push_back(name.toLower());
+  _removed.push_back(false);
+
+  const QString& lower = _names.back();
+  std::unordered_set<uint64_t> unique_keys;
+  for (int i = 0; i + 3 <= lower.size(); i++)
+  {
+    unique_keys.insert(TrigramKey(lower.constData() + i));
+  }
+  // IDs are increasing, therefore each list stays sorted
+  for (uint64_t key : unique_keys)
+  {
+    _trigrams[key].push_back(id);
+  }
+
+  if (!isQueryEmpty() && matchesName(lower))
+  {
+    _results.push_back(id);
+  }
+  return id;
+}
+
+void CurveSearchIndex::remove(int id)
+{
+  // the trigram lists are not updated: removed IDs are skipped when verified
+  _removed[id] = true;
+  _names[id].clear();
+  auto it = std::lower_bound(_results.begin(), _results.end(), id);
+  if (it != _results.end() && *it == id)
+  {
+    _results.erase(it);
+  }
+}
+
+bool CurveSearchIndex::setQuery(const QString& query, Mode mode)
+{
+  if (query == _query && mode == _mode)
+  {
+    return false;
+  }
+  const QStringList prev_words = _words;
+  const Mode prev_mode = _mode;
+  const bool prev_empty = isQueryEmpty();
+
+  _query = query;
+  _mode = mode;
+  _words.clear();
+  _word_regex.clear();
+  _use_regex = false;
+
+  if (mode == REGEX)
+  {
+    _use_regex = !query.trimmed().isEmpty();
+    _regex = QRegularExpression(query.trimmed(), QRegularExpression::CaseInsensitiveOption);
+  }
+  else
+  {
+    _words = query.toLower().split(' ', PJ::SkipEmptyParts);
+    if (mode == WILDCARD)
+    {
+      for (const auto& word : _words)
+      {
+        _word_regex.emplace_back(WildcardToRegex(word));
+      }
+    }
+  }
+
+  if (isQueryEmpty())
+  {
+    _results.clear();
+    return true;
+  }
+
+  std::vector<int> candidates;
+  bool has_candidates = candidatesFromTrigrams(requiredLiterals(), candidates);
+
+  // typing more characters can only reduce the previous results
+  if (!prev_empty && isRefinementOf(prev_words, prev_mode))
+  {
+    if (has_candidates)
+    {
+      IntersectSorted(candidates, _results);
+    }
+    else
+    {
+      candidates = _results;
+      has_candidates = true;
+    }
+  }
+
+  std::vector<int> results;
+  if (has_candidates)
+  {
+    for (int id : candidates)
+    {
+      if (!_removed[id] && matchesName(_names[id]))
+      {
+        results.push_back(id);
+      }
+    }
+  }
+  else
+  {
+    for (int id = 0; id < int(_names.size()); id++)
+    {
+      if (!_removed[id] && matchesName(_names[id]))
+      {
+        results.push_back(id);
+      }
+    }
+  }
+  _results.swap(results);
+  return true;
+}
+
+bool CurveSearchIndex::matches(int id) const
+{
+  if (_removed[id])
+  {
+    return false;
+  }
+  if (isQueryEmpty())
+  {
+    return true;
+  }
+  return std::binary_search(_results.begin(), _results.end(), id);
+}
+
+bool CurveSearchIndex::matchesName(const QString& name) const
+{
+  if (_use_regex)
+  {
+    return _regex.isValid() && _regex.match(name).hasMatch();
+  }
+  for (int i = 0; i < _words.size(); i++)
+  {
+    const bool match = (_mode == WILDCARD) ? _word_regex[i].match(name).hasMatch() :
+                                             name.contains(_words[i]);
+    if (!match)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CurveSearchIndex::isRefinementOf(const QStringList& prev_words, Mode prev_mode) const
+{
+  // a name containing (or matching) a word also contains (matches) any part of it
+  if (_mode == REGEX || _mode != prev_mode)
+  {
+    return false;
+  }
+  for (const auto& prev_word : prev_words)
+  {
+    bool found = false;
+    for (const auto& word : _words)
+    {
+      if (word.contains(prev_word))
+      {
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+QStringList CurveSearchIndex::requiredLiterals() const
+{
+  if (_use_regex)
+  {
+    return _regex.isValid() ? RegexLiterals(_regex.pattern().toLower()) : QStringList();
+  }
+  if (_mode == CONTAINS)
+  {
+    return _words;
+  }
+  QStringList literals;
+  for (const auto& word : _words)
+  {
+    for (const auto& part : word.split(QRegularExpression("[*?]"), PJ::SkipEmptyParts))
+    {
+      literals.push_back(part);
+    }
+  }
+  return literals;
+}
+
+bool CurveSearchIndex::candidatesFromTrigrams(const QStringList& literals,
+                                              std::vector<int>& candidates) const
+{
+  std::vector<const std::vector<int>*> lists;
+  for (const auto& literal : literals)
+  {
+    for (int i = 0; i + 3 <= literal.size(); i++)
+    {
+      auto it = _trigrams.find(TrigramKey(literal.constData() + i));
+      if (it == _trigrams.end())
+      {
+        // no name contains this trigram
+        candidates.clear();
+        return true;
+      }
+      lists.push_back(&it->second);
+    }
+  }
+  if (lists.empty())
+  {
+    return false;
+  }
+
+  // start from the shortest list
+  std::sort(lists.begin(), lists.end(),
+            [](const auto* a, const auto* b) { return a->size() < b->size(); });
+  candidates = *lists.front();
+  for (size_t i = 1; i < lists.size() && !candidates.empty(); i++)
+  {
+    IntersectSorted(candidates, *lists[i]);
+  }
+  return true;
+}
@@ -0,0 +1,89 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CURVE_SEARCH_INDEX_H
+#define CURVE_SEARCH_INDEX_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+
+/**
+ * Trigram index of the names of the curves, used by the filter of the curve list.
+ *
+ * Every name gets an integer ID when it is added. A query is answered by intersecting
+ * the lists of IDs of the trigrams of the literal parts of the query, and verifying
+ * only the remaining candidates. If a query is a refinement of the previous one
+ * (i.e. characters were typed), only the previous results are verified.
+ *
+ * Matching is case-insensitive. Modes:
+ *
+ * - CONTAINS: the name contains all the space-separated words of the query.
+ * - WILDCARD: as CONTAINS, but each word may contain '*' and '?'.
+ * - REGEX:    the query is a regular expression that matches part of the name.
+ */
+class CurveSearchIndex
+{
+public:
+  enum Mode
+  {
+    CONTAINS = 0,
+    WILDCARD = 1,
+    REGEX = 2
+  };
+
+  void clear();
+
+  /// Return the ID of the new name.
+  int add(const QString& name);
+
+  void remove(int id);
+
+  /// Change the query. Return false if it is identical to the current one.
+  bool setQuery(const QString& query, Mode mode);
+
+  bool isQueryEmpty() const
+  {
+    return _words.empty() && !_use_regex;
+  }
+
+  /// Sorted IDs of the names matching the current query (not valid if isQueryEmpty()).
+  const std::vector<int>& results() const
+  {
+    return _results;
+  }
+
+  /// True if the name with this ID matches the current query.
+  bool matches(int id) const;
+
+private:
+  std::vector<QString> _names;  // lower case, empty if removed
+  std::vector<bool> _removed;
+  std::unordered_map<uint64_t, std::vector<int>> _trigrams;
+
+  QString _query;
+  Mode _mode = CONTAINS;
+  QStringList _words;
+  std::vector<QRegularExpression> _word_regex;
+  QRegularExpression _regex;
+  bool _use_regex = false;
+  std::vector<int> _results;
+
+  bool matchesName(const QString& name) const;
+
+  bool isRefinementOf(const QStringList& prev_words, Mode prev_mode) const;
+
+  /// Literal substrings that any matching name must contain.
+  QStringList requiredLiterals() const;
+
+  /// Return false if the literals don't allow to reduce the candidates.
+  bool candidatesFromTrigrams(const QStringList& literals, std::vector<int>& candidates) const;
+};
+
+#endif  // CURVE_SEARCH_INDEX_H
@@ -23,7 +23,6 @@
 #include <QWheelEvent>
 #include <QItemSelectionModel>
 #include <QScrollBar>
-#include <QTreeWidget>
 
 #include "PlotJuggler/svg_util.h"
 
@@ -34,8 +33,8 @@ CurveListPanel::CurveListPanel(PlotDataMapRef& mapped_plot_data,
   : QWidget(parent)
   , ui(new Ui::CurveListPanel)
   , _plot_data(mapped_plot_data)
-  , _custom_view(new CurveTreeView(this))
-  , _tree_view(new CurveTreeView(this))
+  , _custom_view(new CurveTreeView(mapped_plot_data, this))
+  , _tree_view(new CurveTreeView(mapped_plot_data, this))
   , _transforms_map(mapped_math_plots)
   , _column_width_dirty(true)
 {
@@ -60,6 +59,13 @@ CurveListPanel::CurveListPanel(PlotDataMapRef& mapped_plot_data,
 
   int point_size = settings.value("FilterableListWidget/table_point_size", 9).toInt();
   changeFontSize(point_size);
+  _value_precision = settings.value("Preferences::precision", 3).toInt();
+
+  int filter_mode = settings.value("FilterableListWidget/filter_mode", 0).toInt();
+  ui->comboBoxFilterMode->setCurrentIndex(filter_mode);
+  filter_mode = std::max(0, ui->comboBoxFilterMode->currentIndex());
+  _tree_view->setFilterMode(CurveSearchIndex::Mode(filter_mode));
+  _custom_view->setFilterMode(CurveSearchIndex::Mode(filter_mode));
 
   ui->splitter->setStretchFactor(0, 5);
   ui->splitter->setStretchFactor(1, 1);
@@ -73,7 +79,7 @@ CurveListPanel::CurveListPanel(PlotDataMapRef& mapped_plot_data,
   connect(_tree_view->verticalScrollBar(), &QScrollBar::valueChanged, this,
           &CurveListPanel::refreshValues);
 
-  connect(_tree_view, &QTreeWidget::itemExpanded, this, &CurveListPanel::refreshValues);
+  connect(_tree_view, &QTreeView::expanded, this, &CurveListPanel::refreshValues);
 }
 
 CurveListPanel::~CurveListPanel()
@@ -137,102 +143,9 @@ void CurveListPanel::addCustom(const QString& item_name)
 
 void CurveListPanel::updateAppearance()
 {
-  for (CurveTreeView* view : { _tree_view, _custom_view })
-  {
-    QColor default_color = view->palette().color(QPalette::Text);
-    //------------------------------------------
-    // Propagate change in color and style to the children of a group
-    std::function<void(QTreeWidgetItem*, QColor, bool)> ChangeColorAndStyle;
-    ChangeColorAndStyle = [&](QTreeWidgetItem* cell, QColor color, bool italic) {
-      cell->setForeground(0, color);
-      auto font = cell->font(0);
-      font.setItalic(italic);
-      cell->setFont(0, font);
-      for (int c = 0; c < cell->childCount(); c++)
-      {
-        ChangeColorAndStyle(cell->child(c), color, italic);
-      };
-    };
-
-    // set everything to default first
-    for (int c = 0; c < view->invisibleRootItem()->childCount(); c++)
-    {
-      ChangeColorAndStyle(view->invisibleRootItem()->child(c), default_color, false);
-    }
-    //------------- Change groups first ---------------------
-
-    auto ChangeGroupVisitor = [&](QTreeWidgetItem* cell) {
-      if (cell->data(0, CustomRoles::IsGroupName).toBool())
-      {
-        auto group_name = cell->data(0, CustomRoles::Name).toString();
-        auto it = _plot_data.groups.find(group_name.toStdString());
-        if (it != _plot_data.groups.end())
-        {
-          QVariant color_var = it->second->attribute(PJ::TEXT_COLOR);
-          QColor text_color = color_var.isValid() ? color_var.value<QColor>() : default_color;
-
-          QVariant style_var = it->second->attribute(PJ::ITALIC_FONTS);
-          bool italic = (style_var.isValid() && style_var.value<bool>());
-
-          ChangeColorAndStyle(cell, text_color, italic);
-
-          // tooltip doesn't propagate
-          QVariant tooltip = it->second->attribute(TOOL_TIP);
-          cell->setData(0, CustomRoles::ToolTip, tooltip);
-        }
-      }
-    };
-
-    view->treeVisitor(ChangeGroupVisitor);
-
-    //------------- Change leaves ---------------------
-
-    auto ChangeLeavesVisitor = [&](QTreeWidgetItem* cell) {
-      if (cell->childCount() == 0)
-      {
-        const std::string& curve_name = cell->data(0, CustomRoles::Name).toString().toStdString();
-
-        QVariant text_color;
-
-        auto GetTextColor = [&](auto& plot_data, const std::string& curve_name) {
-          auto it = plot_data.find(curve_name);
-          if (it != plot_data.end())
-          {
-            auto& series = it->second;
-            QVariant color_var = series.attribute(PJ::TEXT_COLOR);
-            if (color_var.isValid())
-            {
-              cell->setForeground(0, color_var.value<QColor>());
-            }
-
-            QVariant tooltip_var = series.attribute(PJ::TOOL_TIP);
-            cell->setData(0, CustomRoles::ToolTip, tooltip_var);
-
-            QVariant style_var = series.attribute(PJ::ITALIC_FONTS);
-            bool italic = (style_var.isValid() && style_var.value<bool>());
-            if (italic)
-            {
-              QFont font = cell->font(0);
-              font.setItalic(italic);
-              cell->setFont(0, font);
-            }
-            if (series.isTimeseries() == false)
-            {
-              cell->setIcon(0, LoadSvg("://resources/svg/xy.svg", _style_dir));
-            }
-            return true;
-          }
-          return false;
-        };
-
-        bool valid = (GetTextColor(_plot_data.numeric, curve_name) ||
-                      GetTextColor(_plot_data.scatter_xy, curve_name) ||
-                      GetTextColor(_plot_data.strings, curve_name));
-      }
-    };
-
-    view->treeVisitor(ChangeLeavesVisitor);
-  }
+  // colors and styles are read from the attributes of series and groups by the model
+  _tree_view->refreshAppearance();
+  _custom_view->refreshAppearance();
 }
 
 void CurveListPanel::refreshColumns()
@@ -279,14 +192,22 @@ void CurveListPanel::update2ndColumnValues(double tracker_time)
   refreshValues();
 }
 
+void CurveListPanel::updatePreferences()
+{
+  QSettings settings;
+  _value_precision = settings.value("Preferences::precision", 3).toInt();
+  refreshValues();
+}
+
 void CurveListPanel::refreshValues()
 {
-  auto default_foreground = _custom_view->palette().foreground();
+  if (is2ndColumnHidden())
+  {
+    return;
+  }
 
-  auto FormattedNumber = [](double value) {
-    QSettings settings;
-    int prec = settings.value("Preferences::precision", 3).toInt();
-    QString num_text = QString::number(value, 'f', prec);
+  auto FormattedNumber = [this](double value) {
+    QString num_text = QString::number(value, 'f', _value_precision);
     if (num_text.contains('.'))
     {
       int idx = num_text.length() - 1;
@@ -301,38 +222,52 @@ void CurveListPanel::refreshValues()
     return num_text + " ";
   };
 
-  auto GetValue = [&](const std::string& name) -> QString {
+  PJ::GroupIndexCache group_index(_tracker_time);
+
+  auto GetValue = [&](CurveTreeModel::Node* node) -> QString {
+    // the binding row -> series is resolved only once
+    if (!node->numeric_series && !node->string_series)
     {
-      auto it = _plot_data.numeric.find(name);
-      if (it != _plot_data.numeric.end())
+      const std::string name = node->name.toStdString();
+      auto num_it = _plot_data.numeric.find(name);
+      if (num_it != _plot_data.numeric.end())
       {
-        auto& plot_data = it->second;
-        auto val = plot_data.getYfromX(_tracker_time);
-        if (val)
+        node->numeric_series = &num_it->second;
+      }
+      else
+      {
+        auto str_it = _plot_data.strings.find(name);
+        if (str_it != _plot_data.strings.end())
         {
-          return FormattedNumber(val.value());
+          node->string_series = &str_it->second;
         }
       }
     }
 
+    if (node->numeric_series)
     {
-      auto it = _plot_data.strings.find(name);
-      if (it != _plot_data.strings.end())
+      const auto& plot_data = *node->numeric_series;
+      node->tracker_index = group_index.indexFromX(plot_data, node->tracker_index);
+      if (node->tracker_index >= 0)
       {
-        auto& plot_data = it->second;
-        auto val = plot_data.getYfromX(_tracker_time);
-        if (val)
+        return FormattedNumber(plot_data.at(node->tracker_index).y);
+      }
+    }
+    else if (node->string_series)
+    {
+      const auto& plot_data = *node->string_series;
+      node->tracker_index = group_index.indexFromX(plot_data, node->tracker_index);
+      if (node->tracker_index >= 0)
+      {
+        auto str_view = plot_data.stringAt(node->tracker_index);
+        char last_byte = str_view.data()[str_view.size() - 1];
+        if (last_byte == '\0')
+        {
+          return QString::fromLocal8Bit(str_view.data(), str_view.size() - 1);
+        }
+        else
         {
-          auto str_view = val.value();
-          char last_byte = str_view.data()[str_view.size() - 1];
-          if (last_byte == '\0')
-          {
-            return QString::fromLocal8Bit(str_view.data(), str_view.size() - 1);
-          }
-          else
-          {
-            return QString::fromLocal8Bit(str_view.data(), str_view.size());
-          }
+          return QString::fromLocal8Bit(str_view.data(), str_view.size());
         }
       }
     }
@@ -341,35 +276,13 @@ void CurveListPanel::refreshValues()
 
   for (CurveTreeView* tree_view : { _tree_view, _custom_view })
   {
-    const int vertical_height = tree_view->visibleRegion().boundingRect().height();
-
-    auto DisplayValue = [&](QTreeWidgetItem* cell) {
-      QString curve_name = cell->data(0, CustomRoles::Name).toString();
-
-      if (!curve_name.isEmpty())
-      {
-        auto rect = cell->treeWidget()->visualItemRect(cell);
-
-        if (rect.bottom() < 0 || cell->isHidden())
-        {
-          return;
-        }
-        if (rect.top() > vertical_height)
-        {
-          return;
-        }
-
-        if (!is2ndColumnHidden())
-        {
-          QString str_value = GetValue(curve_name.toStdString());
-          cell->setText(1, str_value);
-        }
-      }
+    // setValue() repaints the row only if the text changed
+    auto DisplayValue = [&](const QModelIndex& index, CurveTreeModel::Node* node) {
+      tree_view->treeModel()->setValue(index, GetValue(node));
     };
 
     tree_view->setViewResizeEnabled(false);
-    tree_view->treeVisitor(DisplayValue);
-    // tree_view->setViewResizeEnabled(true);
+    tree_view->visibleLeavesVisitor(DisplayValue);
   }
 }
 
@@ -543,21 +456,20 @@ void CurveListPanel::on_stylesheetChanged(QString theme)
   ui->buttonDeleteCustom->setIcon(LoadSvg(":/resources/svg/trash.svg", theme));
   ui->pushButtonTrash->setIcon(LoadSvg(":/resources/svg/trash.svg", theme));
 
-  auto ChangeIconVisitor = [&](QTreeWidgetItem* cell) {
-    const auto& curve_name = cell->data(0, CustomRoles::Name).toString().toStdString();
-
-    auto it = _plot_data.scatter_xy.find(curve_name);
-    if (it != _plot_data.scatter_xy.end())
-    {
-      auto& series = it->second;
-      if (series.isTimeseries() == false)
-      {
-        cell->setIcon(0, LoadSvg("://resources/svg/xy.svg", _style_dir));
-      }
-    }
-  };
+  for (CurveTreeView* view : { _tree_view, _custom_view })
+  {
+    view->treeModel()->setStyleDir(_style_dir);
+    view->refreshAppearance();
+  }
+}
 
-  _tree_view->treeVisitor(ChangeIconVisitor);
+void CurveListPanel::on_comboBoxFilterMode_currentIndexChanged(int index)
+{
+  QSettings settings;
+  settings.setValue("FilterableListWidget/filter_mode", index);
+  _tree_view->setFilterMode(CurveSearchIndex::Mode(index));
+  _custom_view->setFilterMode(CurveSearchIndex::Mode(index));
+  updateFilter();
 }
 
 void CurveListPanel::on_checkBoxShowValues_toggled(bool show)
@@ -60,6 +60,9 @@ public:
 
   void updateAppearance();
 
+  /// Read again the preferences used to format the values.
+  void updatePreferences();
+
 private slots:
 
   void on_lineEditFilter_textChanged(const QString& search_string);
@@ -76,6 +79,8 @@ private slots:
 
   void on_checkBoxShowValues_toggled(bool show);
 
+  void on_comboBoxFilterMode_currentIndexChanged(int index);
+
   void on_pushButtonTrash_clicked(bool checked);
 
 public slots:
@@ -101,6 +106,7 @@ private:
   std::unordered_set<std::string> _tree_view_items;
 
   double _tracker_time = 0;
+  int _value_precision = 3;
 
   const TransformsMap& _transforms_map;
 
@@ -0,0 +1,611 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "curvetree_model.h"
+#include "curvelist_view.h"
+#include <algorithm>
+#include <functional>
+#include <QFontDatabase>
+#include <QSettings>
+
+#include "PlotJuggler/alphanum.hpp"
+#include "PlotJuggler/svg_util.h"
+
+namespace
+{
+bool AlphanumLess(const CurveTreeModel::Node* a, const CurveTreeModel::Node* b)
+{
+  return doj::alphanum_impl(a->sort_key.c_str(), b->sort_key.c_str()) < 0;
+}
+}  // namespace
+
+CurveTreeModel::CurveTreeModel(const PJ::PlotDataMapRef& plot_data, QObject* parent)
+  : QAbstractItemModel(parent), _plot_data(plot_data)
+{
+  _root = std::make_unique<Node>();
+  _root->fetched = true;
+  QSettings settings;
+  _use_separator = settings.value("Preferences::use_separator", true).toBool();
+  setFontSize(9);
+  setStyleDir("light");
+}
+
+void CurveTreeModel::clear()
+{
+  beginResetModel();
+  _root = std::make_unique<Node>();
+  _root->fetched = true;
+  _leaves.clear();
+  _leaf_by_id.clear();
+  _search_index.clear();
+  _leaf_count = 0;
+  // the preference might have changed since the last time
+  QSettings settings;
+  _use_separator = settings.value("Preferences::use_separator", true).toBool();
+  endResetModel();
+}
+
+void CurveTreeModel::addItem(const QString& group_name, const QString& tree_name,
+                             const QString& plot_ID)
+{
+  QStringList parts;
+  if (_use_separator)
+  {
+    parts = tree_name.split('/', PJ::SkipEmptyParts);
+  }
+  else
+  {
+    parts.push_back(tree_name);
+  }
+
+  if (parts.size() == 0)
+  {
+    return;
+  }
+
+  bool prefix_is_group = tree_name.startsWith(group_name);
+  bool hasGroup = !group_name.isEmpty();
+  auto group_parts = group_name.split('/', PJ::SkipEmptyParts);
+
+  if (hasGroup && !prefix_is_group)
+  {
+    parts = group_parts + parts;
+  }
+
+  Node* node = _root.get();
+
+  for (int i = 0; i < parts.size(); i++)
+  {
+    const auto& part = parts[i];
+    auto it = node->children.find(part);
+    if (it != node->children.end())
+    {
+      node = it->second.get();
+      continue;
+    }
+
+    auto child = std::make_unique<Node>();
+    child->text = part;
+    child->sort_key = part.toStdString();
+    child->parent = node;
+    if (i < group_parts.size())
+    {
+      child->name = group_name;
+      child->is_group_name = ((i + 1) == group_parts.size());
+    }
+    node = node->children.emplace(part, std::move(child)).first->second.get();
+  }
+
+  if (node->is_leaf)
+  {
+    return;
+  }
+  node->is_leaf = true;
+  node->name = plot_ID;
+  _leaves[plot_ID] = node;
+  _leaf_count++;
+
+  node->leaf_id = _search_index.add(plot_ID);
+  _leaf_by_id.push_back(node);
+  node->matches_filter = _search_index.matches(node->leaf_id);
+  if (node->matches_filter)
+  {
+    changeVisibleLeaves(node, +1);
+  }
+}
+
+void CurveTreeModel::removeCurve(const QString& plot_ID)
+{
+  auto it = _leaves.find(plot_ID);
+  if (it == _leaves.end())
+  {
+    return;
+  }
+  Node* node = it->second;
+  _leaves.erase(it);
+  _leaf_count--;
+  _search_index.remove(node->leaf_id);
+  _leaf_by_id[node->leaf_id] = nullptr;
+  node->leaf_id = -1;
+
+  if (node->matches_filter)
+  {
+    changeVisibleLeaves(node, -1);
+  }
+  node->is_leaf = false;
+  node->matches_filter = false;
+  node->value.clear();
+  // the series is going to be destroyed
+  node->numeric_series = nullptr;
+  node->string_series = nullptr;
+  node->tracker_index = -1;
+
+  // remove the branches left empty. They have no visible leaves, so they are not listed
+  while (node != _root.get() && node->children.empty() && !node->is_leaf)
+  {
+    Node* parent = node->parent;
+    parent->children.erase(node->text);
+    node = parent;
+  }
+}
+
+bool CurveTreeModel::applyVisibilityFilter(const QString& search_string,
+                                           CurveSearchIndex::Mode mode)
+{
+  if (!_search_index.setQuery(search_string, mode))
+  {
+    return false;
+  }
+
+  // No string comparison here: the index already knows which curves match
+  std::vector<bool> matching(_leaf_by_id.size(), _search_index.isQueryEmpty());
+  for (int id : _search_index.results())
+  {
+    matching[id] = true;
+  }
+
+  std::vector<Node*> changed;
+  for (size_t id = 0; id < _leaf_by_id.size(); id++)
+  {
+    Node* leaf = _leaf_by_id[id];
+    if (leaf && leaf->matches_filter != matching[id])
+    {
+      changed.push_back(leaf);
+    }
+  }
+  if (changed.empty())
+  {
+    return false;
+  }
+
+  // Few changes (typically, the user typed one more character): update only
+  // the ancestors of those curves.
+  const size_t MAX_INCREMENTAL_CHANGES = 256;
+  if (changed.size() <= MAX_INCREMENTAL_CHANGES)
+  {
+    for (Node* leaf : changed)
+    {
+      leaf->matches_filter = !leaf->matches_filter;
+      changeVisibleLeaves(leaf, leaf->matches_filter ? +1 : -1);
+    }
+    return true;
+  }
+
+  for (Node* leaf : changed)
+  {
+    leaf->matches_filter = !leaf->matches_filter;
+  }
+
+  // Many rows might appear or disappear: rebuild the listed rows from scratch
+  beginResetModel();
+  std::function<int(Node*)> resetNode = [&](Node* node) {
+    int count = (node->is_leaf && node->matches_filter) ? 1 : 0;
+    for (auto& [text, child] : node->children)
+    {
+      count += resetNode(child.get());
+    }
+    node->visible_leaves = count;
+    node->visible_children.clear();
+    node->fetched = false;
+    node->row = -1;
+    return count;
+  };
+  resetNode(_root.get());
+
+  _root->visible_children = sortedVisibleChildren(_root.get());
+  for (size_t i = 0; i < _root->visible_children.size(); i++)
+  {
+    _root->visible_children[i]->row = int(i);
+  }
+  _root->fetched = true;
+  endResetModel();
+
+  return true;
+}
+
+bool CurveTreeModel::setValue(const QModelIndex& index, const QString& value)
+{
+  Node* node = nodeFromIndex(index);
+  if (node == _root.get() || node->value == value)
+  {
+    return false;
+  }
+  node->value = value;
+  QModelIndex value_index = indexOfNode(node, 1);
+  emit dataChanged(value_index, value_index, { Qt::DisplayRole });
+  return true;
+}
+
+QModelIndex CurveTreeModel::indexOfCurve(const QString& plot_ID)
+{
+  auto it = _leaves.find(plot_ID);
+  if (it == _leaves.end() || it->second->visible_leaves == 0)
+  {
+    return {};
+  }
+  std::vector<Node*> ancestors;
+  for (Node* node = it->second->parent; node != _root.get(); node = node->parent)
+  {
+    ancestors.push_back(node);
+  }
+  for (auto rit = ancestors.rbegin(); rit != ancestors.rend(); rit++)
+  {
+    fetchNode(*rit);
+  }
+  return indexOfNode(it->second);
+}
+
+CurveTreeModel::Node* CurveTreeModel::nodeFromIndex(const QModelIndex& index) const
+{
+  return index.isValid() ? static_cast<Node*>(index.internalPointer()) : _root.get();
+}
+
+void CurveTreeModel::setFontSize(int point_size)
+{
+  _font = QFontDatabase::systemFont(QFontDatabase::GeneralFont);
+  _font.setPointSize(point_size);
+  _font_italic = _font;
+  _font_italic.setItalic(true);
+
+  _font_value = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+  _font_value.setPointSize(point_size - 2);
+}
+
+void CurveTreeModel::setStyleDir(const QString& style_dir)
+{
+  _style_dir = style_dir;
+  _xy_icon = QIcon(LoadSvg("://resources/svg/xy.svg", _style_dir));
+}
+
+QModelIndex CurveTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+  const Node* parent_node = nodeFromIndex(parent);
+  if (row < 0 || column < 0 || column >= 2 || !parent_node->fetched ||
+      row >= int(parent_node->visible_children.size()))
+  {
+    return {};
+  }
+  return createIndex(row, column, parent_node->visible_children[row]);
+}
+
+QModelIndex CurveTreeModel::parent(const QModelIndex& index) const
+{
+  if (!index.isValid())
+  {
+    return {};
+  }
+  return indexOfNode(nodeFromIndex(index)->parent);
+}
+
+int CurveTreeModel::rowCount(const QModelIndex& parent) const
+{
+  if (parent.column() > 0)
+  {
+    return 0;
+  }
+  const Node* node = nodeFromIndex(parent);
+  return node->fetched ? int(node->visible_children.size()) : 0;
+}
+
+int CurveTreeModel::columnCount(const QModelIndex&) const
+{
+  return 2;
+}
+
+bool CurveTreeModel::hasChildren(const QModelIndex& parent) const
+{
+  if (parent.column() > 0)
+  {
+    return false;
+  }
+  return childrenVisibleLeaves(nodeFromIndex(parent)) > 0;
+}
+
+bool CurveTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+  const Node* node = nodeFromIndex(parent);
+  return !node->fetched && childrenVisibleLeaves(node) > 0;
+}
+
+void CurveTreeModel::fetchMore(const QModelIndex& parent)
+{
+  fetchNode(nodeFromIndex(parent));
+}
+
+QVariant CurveTreeModel::data(const QModelIndex& index, int role) const
+{
+  if (!index.isValid())
+  {
+    return {};
+  }
+  Node* node = nodeFromIndex(index);
+  const int column = index.column();
+
+  switch (role)
+  {
+    case Qt::DisplayRole:
+      if (column == 0)
+      {
+        return node->text;
+      }
+      if (node->is_leaf)
+      {
+        return node->value.isEmpty() ? QString("-") : node->value;
+      }
+      return QString();
+
+    case CustomRoles::Name:
+      return (column == 0) ? QVariant(node->name) : QVariant();
+
+    case CustomRoles::IsGroupName:
+      return (column == 0) ? QVariant(node->is_group_name) : QVariant();
+
+    case CustomRoles::ToolTip:
+      updateAppearance(node);
+      return node->tooltip;
+
+    case Qt::ForegroundRole:
+      if (column == 0)
+      {
+        updateAppearance(node);
+        return node->foreground;
+      }
+      break;
+
+    case Qt::FontRole:
+      if (column == 0)
+      {
+        updateAppearance(node);
+        return node->italic ? _font_italic : _font;
+      }
+      return _font_value;
+
+    case Qt::TextAlignmentRole:
+      if (column == 1)
+      {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+      }
+      break;
+
+    case Qt::DecorationRole:
+      if (column == 0)
+      {
+        updateAppearance(node);
+        return node->is_xy ? QVariant(_xy_icon) : QVariant();
+      }
+      break;
+  }
+  return {};
+}
+
+Qt::ItemFlags CurveTreeModel::flags(const QModelIndex& index) const
+{
+  if (!index.isValid())
+  {
+    return Qt::NoItemFlags;
+  }
+  const Node* node = nodeFromIndex(index);
+  return node->is_leaf ? (Qt::ItemIsEnabled | Qt::ItemIsSelectable) : Qt::ItemIsEnabled;
+}
+
+QModelIndex CurveTreeModel::indexOfNode(const Node* node, int column) const
+{
+  if (!node || node == _root.get() || node->row < 0)
+  {
+    return {};
+  }
+  return createIndex(node->row, column, const_cast<Node*>(node));
+}
+
+int CurveTreeModel::childrenVisibleLeaves(const Node* node) const
+{
+  return node->visible_leaves - ((node->is_leaf && node->matches_filter) ? 1 : 0);
+}
+
+std::vector<CurveTreeModel::Node*> CurveTreeModel::sortedVisibleChildren(const Node* node) const
+{
+  std::vector<Node*> list;
+  list.reserve(node->children.size());
+  for (const auto& [text, child] : node->children)
+  {
+    if (child->visible_leaves > 0)
+    {
+      list.push_back(child.get());
+    }
+  }
+  std::sort(list.begin(), list.end(), AlphanumLess);
+  return list;
+}
+
+void CurveTreeModel::fetchNode(Node* node)
+{
+  if (node->fetched)
+  {
+    return;
+  }
+  auto list = sortedVisibleChildren(node);
+  if (!list.empty())
+  {
+    beginInsertRows(indexOfNode(node), 0, int(list.size()) - 1);
+  }
+  node->visible_children = std::move(list);
+  for (size_t i = 0; i < node->visible_children.size(); i++)
+  {
+    node->visible_children[i]->row = int(i);
+  }
+  node->fetched = true;
+  if (!node->visible_children.empty())
+  {
+    endInsertRows();
+  }
+}
+
+void CurveTreeModel::unfetch(Node* node)
+{
+  for (Node* child : node->visible_children)
+  {
+    child->row = -1;
+    unfetch(child);
+  }
+  node->visible_children.clear();
+  node->fetched = false;
+}
+
+void CurveTreeModel::changeVisibleLeaves(Node* leaf, int delta)
+{
+  // Only the topmost node that appears (or disappears) must be inserted (removed) in
+  // the list of its parent: its descendants are not listed yet (anymore).
+  Node* topmost_changed = nullptr;
+  for (Node* node = leaf; node; node = node->parent)
+  {
+    const bool was_visible = node->visible_leaves > 0;
+    node->visible_leaves += delta;
+    if (node != _root.get() && was_visible != (node->visible_leaves > 0))
+    {
+      topmost_changed = node;
+    }
+  }
+
+  if (topmost_changed)
+  {
+    if (delta > 0)
+    {
+      showInParent(topmost_changed);
+    }
+    else
+    {
+      hideInParent(topmost_changed);
+    }
+  }
+}
+
+void CurveTreeModel::showInParent(Node* node)
+{
+  Node* parent = node->parent;
+  if (!parent->fetched || node->row >= 0)
+  {
+    return;
+  }
+  auto& list = parent->visible_children;
+  const auto insert_it = std::lower_bound(list.begin(), list.end(), node, AlphanumLess);
+  const int pos = int(insert_it - list.begin());
+
+  beginInsertRows(indexOfNode(parent), pos, pos);
+  list.insert(list.begin() + pos, node);
+  for (size_t i = pos; i < list.size(); i++)
+  {
+    list[i]->row = int(i);
+  }
+  endInsertRows();
+}
+
+void CurveTreeModel::hideInParent(Node* node)
+{
+  if (node->row < 0)
+  {
+    return;
+  }
+  Node* parent = node->parent;
+  auto& list = parent->visible_children;
+  const int pos = node->row;
+
+  beginRemoveRows(indexOfNode(parent), pos, pos);
+  list.erase(list.begin() + pos);
+  for (size_t i = pos; i < list.size(); i++)
+  {
+    list[i]->row = int(i);
+  }
+  node->row = -1;
+  unfetch(node);
+  endRemoveRows();
+}
+
+void CurveTreeModel::updateAppearance(Node* node) const
+{
+  if (node->appearance_epoch == _appearance_epoch)
+  {
+    return;
+  }
+  node->appearance_epoch = _appearance_epoch;
+
+  // color and style propagate from a group to its children, the tooltip doesn't
+  if (node->parent != _root.get())
+  {
+    updateAppearance(node->parent);
+    node->foreground = node->parent->foreground;
+    node->italic = node->parent->italic;
+  }
+  else
+  {
+    node->foreground = {};
+    node->italic = false;
+  }
+  node->tooltip = {};
+  node->is_xy = false;
+
+  if (node->is_group_name)
+  {
+    auto it = _plot_data.groups.find(node->name.toStdString());
+    if (it != _plot_data.groups.end())
+    {
+      node->foreground = it->second->attribute(PJ::TEXT_COLOR);
+      QVariant style_var = it->second->attribute(PJ::ITALIC_FONTS);
+      node->italic = (style_var.isValid() && style_var.value<bool>());
+      node->tooltip = it->second->attribute(PJ::TOOL_TIP);
+    }
+  }
+
+  if (node->is_leaf)
+  {
+    const std::string curve_name = node->name.toStdString();
+
+    auto GetAppearance = [&](const auto& plot_data) {
+      auto it = plot_data.find(curve_name);
+      if (it == plot_data.end())
+      {
+        return false;
+      }
+      const auto& series = it->second;
+      QVariant color_var = series.attribute(PJ::TEXT_COLOR);
+      if (color_var.isValid())
+      {
+        node->foreground = color_var;
+      }
+      node->tooltip = series.attribute(PJ::TOOL_TIP);
+
+      QVariant style_var = series.attribute(PJ::ITALIC_FONTS);
+      if (style_var.isValid() && style_var.value<bool>())
+      {
+        node->italic = true;
+      }
+      node->is_xy = !series.isTimeseries();
+      return true;
+    };
+
+    GetAppearance(_plot_data.numeric) || GetAppearance(_plot_data.scatter_xy) ||
+        GetAppearance(_plot_data.strings);
+  }
+}
@@ -0,0 +1,182 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CURVETREE_MODEL_H
+#define CURVETREE_MODEL_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QFont>
+#include <QIcon>
+
+#include "PlotJuggler/plotdata.h"
+#include "curve_search_index.h"
+
+/**
+ * Model of the tree of curves displayed in CurveTreeView.
+ *
+ * The tree is stored as a prefix tree with hashed children, therefore adding a curve
+ * costs O(path length), independently of the number of siblings.
+ *
+ * The rows are created lazily (canFetchMore/fetchMore): the sorted list of the children
+ * of a node is built only when the node is expanded by the view. The curves hidden by the
+ * filter are not part of the model at all. The filter is answered by a CurveSearchIndex
+ * that is updated when curves are added or removed.
+ *
+ * Colors, fonts, tooltips and icons are read from the attributes of the series and
+ * groups when the view asks for them; call invalidateAppearance() when they change.
+ */
+class CurveTreeModel : public QAbstractItemModel
+{
+public:
+  struct QStringHash
+  {
+    size_t operator()(const QString& str) const
+    {
+      return qHash(str);
+    }
+  };
+
+  struct Node
+  {
+    QString text;
+    std::string sort_key;
+    // ID of the series if this is a leaf, name of the group otherwise
+    QString name;
+    QString value;
+    bool is_leaf = false;
+    bool is_group_name = false;
+    bool matches_filter = false;
+    // ID in the CurveSearchIndex, -1 if this is not a leaf
+    int leaf_id = -1;
+
+    // number of leaves in this subtree (itself included) that pass the filter.
+    // A node is listed by its parent only if this is larger than 0.
+    int visible_leaves = 0;
+
+    bool fetched = false;
+    bool expanded = false;
+    // position in parent->visible_children, -1 if not listed
+    int row = -1;
+
+    Node* parent = nullptr;
+    std::unordered_map<QString, std::unique_ptr<Node>, QStringHash> children;
+    // sorted, valid only if fetched is true
+    std::vector<Node*> visible_children;
+
+    // series displayed in the second column, resolved the first time it is needed,
+    // and index of the point at the tracker in the last refresh
+    const PJ::PlotData* numeric_series = nullptr;
+    const PJ::StringSeries* string_series = nullptr;
+    int tracker_index = -1;
+
+    // cached appearance
+    int appearance_epoch = -1;
+    QVariant foreground;
+    QVariant tooltip;
+    bool italic = false;
+    bool is_xy = false;
+  };
+
+  CurveTreeModel(const PJ::PlotDataMapRef& plot_data, QObject* parent);
+
+  void clear();
+
+  void addItem(const QString& group_name, const QString& tree_name, const QString& plot_ID);
+
+  void removeCurve(const QString& plot_ID);
+
+  /// Return true if the visibility of any curve changed.
+  bool applyVisibilityFilter(const QString& search_string,
+                             CurveSearchIndex::Mode mode = CurveSearchIndex::CONTAINS);
+
+  int leafCount() const
+  {
+    return _leaf_count;
+  }
+
+  int hiddenCount() const
+  {
+    return _leaf_count - _root->visible_leaves;
+  }
+
+  /// Change the text of the second column. Return true if it changed.
+  bool setValue(const QModelIndex& index, const QString& value);
+
+  /// Index of a curve, creating the rows of its ancestors if needed.
+  /// Invalid if the curve doesn't exist or it is hidden by the filter.
+  QModelIndex indexOfCurve(const QString& plot_ID);
+
+  Node* nodeFromIndex(const QModelIndex& index) const;
+
+  void setFontSize(int point_size);
+
+  void setStyleDir(const QString& style_dir);
+
+  void invalidateAppearance()
+  {
+    _appearance_epoch++;
+  }
+
+  QModelIndex index(int row, int column, const QModelIndex& parent = {}) const override;
+
+  QModelIndex parent(const QModelIndex& index) const override;
+
+  int rowCount(const QModelIndex& parent = {}) const override;
+
+  int columnCount(const QModelIndex& parent = {}) const override;
+
+  bool hasChildren(const QModelIndex& parent = {}) const override;
+
+  bool canFetchMore(const QModelIndex& parent) const override;
+
+  void fetchMore(const QModelIndex& parent) override;
+
+  QVariant data(const QModelIndex& index, int role) const override;
+
+  Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+private:
+  const PJ::PlotDataMapRef& _plot_data;
+  std::unique_ptr<Node> _root;
+  std::unordered_map<QString, Node*, QStringHash> _leaves;
+  // indexed by Node::leaf_id, nullptr for the removed curves
+  std::vector<Node*> _leaf_by_id;
+  int _leaf_count = 0;
+
+  bool _use_separator = true;
+  CurveSearchIndex _search_index;
+
+  QFont _font;
+  QFont _font_italic;
+  QFont _font_value;
+  QString _style_dir;
+  QIcon _xy_icon;
+  int _appearance_epoch = 0;
+
+  QModelIndex indexOfNode(const Node* node, int column = 0) const;
+
+  int childrenVisibleLeaves(const Node* node) const;
+
+  std::vector<Node*> sortedVisibleChildren(const Node* node) const;
+
+  void fetchNode(Node* node);
+
+  void unfetch(Node* node);
+
+  void changeVisibleLeaves(Node* leaf, int delta);
+
+  void showInParent(Node* node);
+
+  void hideInParent(Node* node);
+
+  void updateAppearance(Node* node) const;
+};
+
+#endif  // CURVETREE_MODEL_H
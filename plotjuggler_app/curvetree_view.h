@@ -8,13 +8,14 @@
 #define CURVETREE_VIEW_H
 
 #include "curvelist_view.h"
-#include <QTreeWidget>
+#include "curvetree_model.h"
+#include <QTreeView>
 #include <functional>
 
-class CurveTreeView : public QTreeWidget, public CurvesView
+class CurveTreeView : public QTreeView, public CurvesView
 {
 public:
-  CurveTreeView(CurveListPanel* parent);
+  CurveTreeView(const PJ::PlotDataMapRef& plot_data, CurveListPanel* parent);
 
   void clear() override;
 
@@ -28,13 +29,18 @@ public:
 
   bool applyVisibilityFilter(const QString& filter_string) override;
 
+  void setFilterMode(CurveSearchIndex::Mode mode)
+  {
+    _filter_mode = mode;
+  }
+
   bool eventFilter(QObject* object, QEvent* event) override;
 
   void removeCurve(const QString& name) override;
 
   std::pair<int, int> hiddenItemsCount() override
   {
-    return { _hidden_count, _leaf_count };
+    return { _model->hiddenCount(), _model->leafCount() };
   }
 
   void setViewResizeEnabled(bool) override
@@ -43,18 +49,30 @@ public:
 
   virtual void hideValuesColumn(bool hide) override;
 
-  void treeVisitor(std::function<void(QTreeWidgetItem*)> visitor);
+  CurveTreeModel* treeModel()
+  {
+    return _model;
+  }
+
+  /// Visit the leaves currently displayed in the viewport.
+  void visibleLeavesVisitor(
+      std::function<void(const QModelIndex&, CurveTreeModel::Node*)> visitor);
+
+  /// Repaint colors, fonts and icons, after the attributes of the series changed.
+  void refreshAppearance();
 
   virtual void keyPressEvent(QKeyEvent*) override;
 
 private:
-  void expandChildren(bool expanded, QTreeWidgetItem* item);
+  void expandChildren(bool expanded, const QModelIndex& index);
+
+  void restoreExpandedNodes(const QModelIndex& parent);
 
-  int _hidden_count = 0;
-  int _leaf_count = 0;
+  CurveTreeModel* _model = nullptr;
+  CurveSearchIndex::Mode _filter_mode = CurveSearchIndex::CONTAINS;
 
   QTimer* _tooltip_timer = nullptr;
-  QTreeWidgetItem* _tooltip_item = nullptr;
+  QPersistentModelIndex _tooltip_index;
   QPoint _tooltip_pos;
 };
 
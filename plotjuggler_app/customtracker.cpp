@@ -13,6 +13,8 @@
 #include "qwt_symbol.h"
 #include "qwt_graphic.h"
 #include "qwt_text.h"
+#include "qwt_scale_widget.h"
+#include "qwt_widget_overlay.h"
 #include <qevent.h>
 #include <QFontDatabase>
 #include <QSettings>
@@ -25,6 +27,81 @@ struct compareX
   }
 };
 
+class TrackerOverlay : public QwtWidgetOverlay
+{
+public:
+  TrackerOverlay(const CurveTracker* tracker, QWidget* canvas)
+    : QwtWidgetOverlay(canvas), _tracker(tracker)
+  {
+    setMaskMode(QwtWidgetOverlay::MaskHint);
+  }
+
+protected:
+  void drawOverlay(QPainter* painter) const override
+  {
+    const QwtPlot* plot = _tracker->_plot;
+    const QwtScaleMap x_map = plot->canvasMap(QwtPlot::xBottom);
+    const QwtScaleMap y_map = plot->canvasMap(QwtPlot::yLeft);
+    const QRectF canvas_rect = plot->canvas()->contentsRect();
+
+    auto Draw = [&](const QwtPlotMarker* item) {
+      if (item->isVisible())
+      {
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing,
+                               item->testRenderHint(QwtPlotItem::RenderAntialiased));
+        item->draw(painter, x_map, y_map, canvas_rect);
+        painter->restore();
+      }
+    };
+
+    Draw(_tracker->_line_marker);
+    for (const auto* marker : _tracker->_marker)
+    {
+      Draw(marker);
+    }
+    Draw(_tracker->_text_marker);
+  }
+
+  // only these regions of the canvas are restored when the tracker moves
+  QRegion maskHint() const override
+  {
+    const QwtPlot* plot = _tracker->_plot;
+    const QwtScaleMap x_map = plot->canvasMap(QwtPlot::xBottom);
+    const QwtScaleMap y_map = plot->canvasMap(QwtPlot::yLeft);
+
+    auto ToPixel = [&](const QPointF& point) {
+      return QPoint(qRound(x_map.transform(point.x())), qRound(y_map.transform(point.y())));
+    };
+
+    QRegion region;
+    if (_tracker->_line_marker->isVisible())
+    {
+      const int x = ToPixel(_tracker->_line_marker->value()).x();
+      region += QRect(x - 2, 0, 5, plot->canvas()->height());
+    }
+    for (const auto* marker : _tracker->_marker)
+    {
+      if (marker->isVisible())
+      {
+        region += QRect(ToPixel(marker->value()) - QPoint(6, 6), QSize(13, 13));
+      }
+    }
+    const QwtPlotMarker* text_marker = _tracker->_text_marker;
+    if (text_marker->isVisible())
+    {
+      const QSize size = text_marker->label().textSize().toSize();
+      const QPoint pos = ToPixel(text_marker->value());
+      region += QRect(pos.x() - 4, pos.y() - size.height() / 2 - 4, size.width() + 16,
+                      size.height() + 8);
+    }
+    return region;
+  }
+
+private:
+  const CurveTracker* _tracker;
+};
+
 CurveTracker::CurveTracker(QwtPlot* plot) : QObject(plot), _plot(plot), _param(VALUE)
 {
   _line_marker = new QwtPlotMarker();
@@ -32,16 +109,64 @@ CurveTracker::CurveTracker(QwtPlot* plot) : QObject(plot), _plot(plot), _param(V
   _line_marker->setLinePen(QPen(Qt::red));
   _line_marker->setLineStyle(QwtPlotMarker::VLine);
   _line_marker->setValue(0, 0);
-  _line_marker->attach(plot);
 
   _text_marker = new QwtPlotMarker();
-  _text_marker->attach(plot);
+
+  _overlay = new TrackerOverlay(this, plot->canvas());
+  plot->canvas()->installEventFilter(this);
+
+  // the position of the markers in the canvas depends on the scales
+  for (int axis : { QwtPlot::xBottom, QwtPlot::yLeft })
+  {
+    connect(plot->axisWidget(axis), &QwtScaleWidget::scaleDivChanged, this,
+            &CurveTracker::redraw);
+  }
 
   _visible = true;
+  loadSettings();
 }
 
 CurveTracker::~CurveTracker()
 {
+  // the markers are not attached to the plot, that would delete them
+  delete _line_marker;
+  delete _text_marker;
+  for (auto* marker : _marker)
+  {
+    delete marker;
+  }
+}
+
+void CurveTracker::loadSettings()
+{
+  QSettings settings;
+  _precision = settings.value("Preferences::precision", 3).toInt();
+}
+
+bool CurveTracker::eventFilter(QObject* object, QEvent* event)
+{
+  if (object == _plot->canvas() && event->type() == QEvent::Resize)
+  {
+    redraw();
+  }
+  return QObject::eventFilter(object, event);
+}
+
+void CurveTracker::updateOverlay()
+{
+  bool any_visible = _line_marker->isVisible() || _text_marker->isVisible();
+  for (const auto* marker : _marker)
+  {
+    any_visible |= marker->isVisible();
+  }
+  if (any_visible)
+  {
+    _overlay->updateOverlay();
+  }
+  else
+  {
+    _overlay->hide();
+  }
 }
 
 QPointF CurveTracker::actualPosition() const
@@ -70,6 +195,7 @@ void CurveTracker::setEnabled(bool enable)
   {
     _marker[i]->setVisible(enable);
   }
+  updateOverlay();
 }
 
 bool CurveTracker::isEnabled() const
@@ -95,14 +221,13 @@ void CurveTracker::setPosition(const QPointF& position)
 
   while (_marker.size() > curves.size())
   {
-    _marker.back()->detach();
+    delete _marker.back();
     _marker.pop_back();
   }
 
   for (int i = _marker.size(); i < curves.size(); i++)
   {
     _marker.push_back(new QwtPlotMarker);
-    _marker[i]->attach(_plot);
   }
 
   double text_X_offset = 0;
@@ -155,16 +280,13 @@ void CurveTracker::setPosition(const QPointF& position)
 
       QString line;
 
-      QSettings settings;
-      int prec = settings.value("Preferences::precision", 3).toInt();
-
       if (_param == VALUE)
       {
         line = QString("<font color=%1>%2</font>").arg(color.name()).arg(val);
       }
       else if (_param == VALUE_NAME)
       {
-        QString value = QString::number(val, 'f', prec);
+        QString value = QString::number(val, 'f', _precision);
         int whitespaces = 8 - value.length();
         while (whitespaces-- > 0)
           value.prepend("&nbsp;");
@@ -233,6 +355,7 @@ void CurveTracker::setPosition(const QPointF& position)
   _text_marker->setVisible(visible_points > 0 && _visible && _param != LINE_ONLY);
 
   _prev_trackerpoint = position;
+  updateOverlay();
 }
 
 QLineF CurveTracker::curveLineAt(const QwtPlotCurve* curve, double x) const
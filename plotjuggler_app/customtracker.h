@@ -14,7 +14,15 @@
 #include "qwt_plot_marker.h"
 
 class QwtPlotCurve;
-
+class TrackerOverlay;
+
+/**
+ * Vertical line, markers and values of the curves at the position of the time tracker.
+ *
+ * They are not items of the plot: they are drawn on an overlay of the canvas,
+ * therefore moving the tracker doesn't require a replot. The canvas is restored from
+ * its backing store.
+ */
 class CurveTracker : public QObject
 {
   Q_OBJECT
@@ -47,7 +55,16 @@ public slots:
     setPosition(_prev_trackerpoint);
   }
 
+  /// Read again the preferences (precision of the values).
+  void loadSettings();
+
 private:
+  friend class TrackerOverlay;
+
+  bool eventFilter(QObject* object, QEvent* event) override;
+
+  void updateOverlay();
+
   QLineF curveLineAt(const QwtPlotCurve*, double x) const;
 
   QPointF transform(QPoint);
@@ -59,8 +76,10 @@ private:
   QwtPlotMarker* _line_marker;
   QwtPlotMarker* _text_marker;
   QwtPlot* _plot;
+  TrackerOverlay* _overlay;
   Parameter _param;
   bool _visible;
+  int _precision;
 };
 
 #endif  // CUSTOMTRACKER_H
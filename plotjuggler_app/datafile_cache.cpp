@@ -0,0 +1,500 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "datafile_cache.h"
+
+#include <cstring>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+namespace
+{
+// Layout of an entry:
+//
+//   Preamble  { char magic[8]; quint32 version; quint32 reserved; quint64 header_size; }
+//   Header    serialized with QDataStream (see store())
+//   padding   up to a multiple of 8 bytes
+//   Columns   for each numeric series: double x[N], double y[N]
+//             for each string series:  double x[N], quint64 end[N], char text[...], padding
+//
+// Columns are written in native byte order: the cache is never shared between machines.
+
+const char kMagic[8] = { 'P', 'J', 'D', 'C', 'A', 'C', 'H', 'E' };
+const quint32 kVersion = 1;
+const qint64 kPreambleSize = 24;
+
+enum SeriesType : quint8
+{
+  NUMERIC = 0,
+  STRINGS = 1
+};
+
+qint64 Align8(qint64 value)
+{
+  return (value + 7) & ~qint64(7);
+}
+
+void AppendCanonicalXML(const QDomNode& node, QByteArray& out)
+{
+  if (node.isElement())
+  {
+    // QDom doesn't preserve the order of the attributes, sort them
+    const QDomElement elem = node.toElement();
+    const QDomNamedNodeMap attributes = elem.attributes();
+    QStringList sorted_attributes;
+    for (int i = 0; i < attributes.count(); i++)
+    {
+      const QDomAttr attr = attributes.item(i).toAttr();
+      sorted_attributes.push_back(attr.name() + "=\"" + attr.value() + "\"");
+    }
+    sorted_attributes.sort();
+
+    out += "<" + elem.tagName().toUtf8() + " " + sorted_attributes.join(" ").toUtf8() + ">";
+    for (auto child = elem.firstChild(); !child.isNull(); child = child.nextSibling())
+    {
+      AppendCanonicalXML(child, out);
+    }
+    out += "</" + elem.tagName().toUtf8() + ">";
+  }
+  else if (node.isText() || node.isCDATASection())
+  {
+    out += node.nodeValue().toUtf8();
+  }
+}
+
+void WriteAttributes(QDataStream& out, const PJ::Attributes& attributes)
+{
+  out << quint32(attributes.size());
+  for (const auto& [id, value] : attributes)
+  {
+    out << qint32(id) << value;
+  }
+}
+
+void ReadAttributes(QDataStream& in, PJ::Attributes& attributes)
+{
+  quint32 count = 0;
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+  {
+    qint32 id;
+    QVariant value;
+    in >> id >> value;
+    attributes[static_cast<PJ::PlotAttribute>(id)] = value;
+  }
+}
+
+// Write a column, converting the points in chunks.
+template <typename Series, typename Getter>
+bool WriteColumn(QSaveFile& file, const Series& series, Getter getter)
+{
+  using Value = decltype(getter(series.at(0)));
+  std::vector<Value> buffer;
+  buffer.reserve(8192);
+
+  for (size_t i = 0; i < series.size(); i++)
+  {
+    buffer.push_back(getter(series.at(i)));
+    if (buffer.size() == buffer.capacity() || i + 1 == series.size())
+    {
+      const qint64 bytes = buffer.size() * sizeof(Value);
+      if (file.write(reinterpret_cast<const char*>(buffer.data()), bytes) != bytes)
+      {
+        return false;
+      }
+      buffer.clear();
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+DataFileCache::DataFileCache()
+{
+  _directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/datafiles";
+  _store_pool.setMaxThreadCount(1);
+  loadSettings();
+}
+
+void DataFileCache::loadSettings()
+{
+  QSettings settings;
+  _enabled = settings.value("Preferences::data_cache_enabled", false).toBool();
+  _max_size = settings.value("Preferences::data_cache_max_size", 4096).toLongLong() * 1024 * 1024;
+}
+
+QString DataFileCache::key(const QString& loader_name, const PJ::FileLoadInfo& info) const
+{
+  // the loaders always read the first element (see MainWindow::loadDataFromFile)
+  const QDomElement config = info.plugin_config.firstChildElement();
+  const QFileInfo file_info(info.filename);
+  if (config.isNull() || !file_info.exists())
+  {
+    return {};
+  }
+
+  QByteArray canonical_config;
+  AppendCanonicalXML(config, canonical_config);
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(loader_name.toUtf8());
+  hash.addData(file_info.absoluteFilePath().toUtf8());
+  hash.addData(QByteArray::number(file_info.size()));
+  hash.addData(QByteArray::number(file_info.lastModified().toMSecsSinceEpoch()));
+  hash.addData(info.prefix.toUtf8());
+  hash.addData(canonical_config);
+  return QString::fromLatin1(hash.result().toHex());
+}
+
+QString DataFileCache::entryPath(const QString& key) const
+{
+  return _directory + "/" + key + ".pjcache";
+}
+
+bool DataFileCache::load(const QString& key, PJ::PlotDataMapRef& destination)
+{
+  if (key.isEmpty())
+  {
+    return false;
+  }
+  QFile file(entryPath(key));
+  if (!file.open(QFile::ReadOnly) || file.size() < kPreambleSize)
+  {
+    return false;
+  }
+  const qint64 file_size = file.size();
+  const uchar* data = file.map(0, file_size);
+  if (!data)
+  {
+    return false;
+  }
+
+  char magic[8];
+  quint32 version;
+  quint64 header_size;
+  std::memcpy(magic, data, 8);
+  std::memcpy(&version, data + 8, 4);
+  std::memcpy(&header_size, data + 16, 8);
+
+  if (std::memcmp(magic, kMagic, 8) != 0 || version != kVersion ||
+      header_size > quint64(file_size - kPreambleSize))
+  {
+    return false;
+  }
+  const qint64 data_start = Align8(kPreambleSize + header_size);
+
+  QByteArray header = QByteArray::fromRawData(
+      reinterpret_cast<const char*>(data + kPreambleSize), int(header_size));
+  QDataStream in(header);
+  in.setVersion(QDataStream::Qt_5_9);
+
+  QString stored_key;
+  in >> stored_key;
+  if (stored_key != key)
+  {
+    return false;
+  }
+
+  quint32 group_count = 0;
+  in >> group_count;
+  for (quint32 i = 0; i < group_count && in.status() == QDataStream::Ok; i++)
+  {
+    QByteArray name;
+    in >> name;
+    auto group = destination.getOrCreateGroup(name.toStdString());
+    ReadAttributes(in, group->attributes());
+  }
+
+  quint32 series_count = 0;
+  in >> series_count;
+  for (quint32 i = 0; i < series_count && in.status() == QDataStream::Ok; i++)
+  {
+    quint8 type;
+    QByteArray name;
+    QByteArray group_name;
+    PJ::Attributes attributes;
+    quint64 count;
+    quint64 offset;
+    quint64 text_size;
+    in >> type >> name >> group_name;
+    ReadAttributes(in, attributes);
+    in >> count >> offset >> text_size;
+
+    quint64 column_bytes = count * 2 * sizeof(double) + text_size;
+    if (in.status() != QDataStream::Ok || offset % 8 != 0 ||
+        data_start + offset + column_bytes > quint64(file_size))
+    {
+      return false;
+    }
+
+    PJ::PlotGroup::Ptr group;
+    if (!group_name.isEmpty())
+    {
+      group = destination.getOrCreateGroup(group_name.toStdString());
+    }
+
+    // the alignment of the columns is guaranteed by store()
+    const double* x = reinterpret_cast<const double*>(data + data_start + offset);
+
+    if (type == NUMERIC)
+    {
+      const double* y = x + count;
+      auto& series = destination.getOrCreateNumeric(name.toStdString(), group);
+      series.attributes() = attributes;
+      series.appendSorted(x, y, count);
+    }
+    else if (type == STRINGS)
+    {
+      const quint64* end = reinterpret_cast<const quint64*>(x + count);
+      const char* text = reinterpret_cast<const char*>(end + count);
+      auto& series = destination.getOrCreateStringSeries(name.toStdString(), group);
+      series.attributes() = attributes;
+      quint64 begin = 0;
+      for (quint64 p = 0; p < count; p++)
+      {
+        if (end[p] < begin || end[p] > text_size)
+        {
+          return false;
+        }
+        series.pushBack({ x[p], PJ::StringRef(text + begin, end[p] - begin) });
+        begin = end[p];
+      }
+    }
+  }
+
+  if (in.status() != QDataStream::Ok)
+  {
+    return false;
+  }
+  file.unmap(const_cast<uchar*>(data));
+
+  // mark the entry as recently used
+  file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+  return true;
+}
+
+bool DataFileCache::store(const QString& key, const PJ::PlotDataMapRef& source,
+                          const std::unordered_set<std::string>& names)
+{
+  Entry entry;
+  return prepareEntry(key, source, names, entry) && writeEntry(entry);
+}
+
+void DataFileCache::storeInBackground(const QString& key, const PJ::PlotDataMapRef& source,
+                                      const std::unordered_set<std::string>& names)
+{
+  // the maps of source are read here: the GUI thread may add series to them later
+  auto entry = std::make_shared<Entry>();
+  if (prepareEntry(key, source, names, *entry))
+  {
+    QtConcurrent::run(&_store_pool, [this, entry]() { writeEntry(*entry); });
+  }
+}
+
+void DataFileCache::waitForStore()
+{
+  _store_pool.waitForDone();
+}
+
+bool DataFileCache::prepareEntry(const QString& key, const PJ::PlotDataMapRef& source,
+                                 const std::unordered_set<std::string>& names,
+                                 Entry& entry) const
+{
+  if (key.isEmpty())
+  {
+    return false;
+  }
+
+  auto& numeric_series = entry.numeric_series;
+  auto& string_series = entry.string_series;
+  std::vector<quint64> text_sizes;
+  std::unordered_set<PJ::PlotGroup::Ptr> groups;
+  qint64 total_size = 0;
+
+  for (const auto& name : names)
+  {
+    if (source.user_defined.count(name) != 0)
+    {
+      return false;
+    }
+    auto numeric_it = source.numeric.find(name);
+    if (numeric_it != source.numeric.end())
+    {
+      numeric_series.push_back(&numeric_it->second);
+      total_size += numeric_it->second.size() * 2 * sizeof(double);
+      if (numeric_it->second.group())
+      {
+        groups.insert(numeric_it->second.group());
+      }
+      continue;
+    }
+    auto string_it = source.strings.find(name);
+    if (string_it != source.strings.end())
+    {
+      const auto& series = string_it->second;
+      quint64 text_size = 0;
+      for (size_t p = 0; p < series.size(); p++)
+      {
+        text_size += series.stringAt(p).size();
+      }
+      string_series.push_back(&series);
+      text_sizes.push_back(text_size);
+      total_size += series.size() * 2 * sizeof(double) + Align8(text_size);
+      if (series.group())
+      {
+        groups.insert(series.group());
+      }
+    }
+  }
+
+  if (numeric_series.empty() && string_series.empty())
+  {
+    return false;
+  }
+  if (total_size > _max_size)
+  {
+    qDebug() << "DataFileCache: data too large to be cached";
+    return false;
+  }
+
+  QByteArray& header = entry.header;
+  {
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << key;
+
+    out << quint32(groups.size());
+    for (const auto& group : groups)
+    {
+      out << QByteArray::fromStdString(group->name());
+      WriteAttributes(out, group->attributes());
+    }
+
+    quint64 offset = 0;
+    auto writeSeriesHeader = [&](quint8 type, const auto& series, quint64 text_size) {
+      out << type << QByteArray::fromStdString(series.plotName())
+          << (series.group() ? QByteArray::fromStdString(series.group()->name()) : QByteArray());
+      WriteAttributes(out, series.attributes());
+      out << quint64(series.size()) << offset << text_size;
+      offset += Align8(series.size() * 2 * sizeof(double) + text_size);
+    };
+
+    out << quint32(numeric_series.size() + string_series.size());
+    for (const auto* series : numeric_series)
+    {
+      writeSeriesHeader(NUMERIC, *series, 0);
+    }
+    for (size_t i = 0; i < string_series.size(); i++)
+    {
+      writeSeriesHeader(STRINGS, *string_series[i], text_sizes[i]);
+    }
+  }
+
+  entry.path = entryPath(key);
+  return true;
+}
+
+bool DataFileCache::writeEntry(const Entry& entry)
+{
+  const auto& numeric_series = entry.numeric_series;
+  const auto& string_series = entry.string_series;
+  const QString& path = entry.path;
+  const QByteArray& header = entry.header;
+
+  QDir().mkpath(_directory);
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    return false;
+  }
+
+  auto writePadding = [&file]() {
+    static const char zeros[8] = {};
+    const qint64 padding = Align8(file.pos()) - file.pos();
+    return file.write(zeros, padding) == padding;
+  };
+
+  const quint32 reserved = 0;
+  const quint64 header_size = header.size();
+  bool ok = file.write(kMagic, 8) == 8;
+  ok = ok && file.write(reinterpret_cast<const char*>(&kVersion), 4) == 4;
+  ok = ok && file.write(reinterpret_cast<const char*>(&reserved), 4) == 4;
+  ok = ok && file.write(reinterpret_cast<const char*>(&header_size), 8) == 8;
+  ok = ok && file.write(header) == header.size();
+  ok = ok && writePadding();
+
+  for (size_t i = 0; ok && i < numeric_series.size(); i++)
+  {
+    const auto& series = *numeric_series[i];
+    ok = WriteColumn(file, series, [](const PJ::PlotData::Point& p) { return p.x; }) &&
+         WriteColumn(file, series, [](const PJ::PlotData::Point& p) { return p.y; });
+  }
+
+  for (size_t i = 0; ok && i < string_series.size(); i++)
+  {
+    const auto& series = *string_series[i];
+    quint64 end = 0;
+    ok = WriteColumn(file, series, [](const PJ::StringSeries::Sample& p) { return p.x; }) &&
+         WriteColumn(file, series, [&series, &end](const PJ::StringSeries::Sample& p) {
+           end += series.string(p.y).size();
+           return quint64(end);
+         });
+    for (size_t p = 0; ok && p < series.size(); p++)
+    {
+      const auto str = series.stringAt(p);
+      ok = file.write(str.data(), str.size()) == qint64(str.size());
+    }
+    ok = ok && writePadding();
+  }
+
+  if (!ok || !file.commit())
+  {
+    file.cancelWriting();
+    qDebug() << "DataFileCache: failed to write" << path;
+    return false;
+  }
+
+  evict(path);
+  return true;
+}
+
+void DataFileCache::evict(const QString& keep_path)
+{
+  // sorted from the most recently used
+  const auto entries = QDir(_directory).entryInfoList({ "*.pjcache" }, QDir::Files, QDir::Time);
+  const QString keep_absolute_path = QFileInfo(keep_path).absoluteFilePath();
+
+  qint64 total_size = 0;
+  for (const auto& entry : entries)
+  {
+    total_size += entry.size();
+    if (total_size > _max_size && entry.absoluteFilePath() != keep_absolute_path)
+    {
+      QFile::remove(entry.absoluteFilePath());
+      total_size -= entry.size();
+    }
+  }
+}
+
+void DataFileCache::clear()
+{
+  waitForStore();
+  const auto entries = QDir(_directory).entryInfoList({ "*.pjcache" }, QDir::Files);
+  for (const auto& entry : entries)
+  {
+    QFile::remove(entry.absoluteFilePath());
+  }
+}
@@ -0,0 +1,99 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef DATAFILE_CACHE_H
+#define DATAFILE_CACHE_H
+
+#include <unordered_set>
+#include <QString>
+#include <QThreadPool>
+#include "PlotJuggler/plotdata.h"
+#include "PlotJuggler/dataloader_base.h"
+
+/**
+ * Persistent cache of the data loaded from files, stored in the user's cache folder.
+ *
+ * An entry is identified by the absolute path, size and modification time of the file,
+ * by the data loader and by its configuration, i.e. a file is read again by the plugin
+ * only when any of them changes.
+ *
+ * Each entry is a single binary file with a small header (names, groups and attributes)
+ * followed by one contiguous column per coordinate, that is memory-mapped when loaded.
+ * The least recently used entries are removed when the total size exceeds maxSize().
+ *
+ * The series of type user_defined are not cached: their values can't be serialized.
+ */
+class DataFileCache
+{
+public:
+  DataFileCache();
+
+  /// Read the options "Preferences::data_cache_enabled" and
+  /// "Preferences::data_cache_max_size" (MB) from QSettings.
+  void loadSettings();
+
+  bool isEnabled() const
+  {
+    return _enabled;
+  }
+
+  qint64 maxSize() const
+  {
+    return _max_size;
+  }
+
+  /// Empty if the entry can not be identified, for instance because the
+  /// data loader has no configuration yet.
+  QString key(const QString& loader_name, const PJ::FileLoadInfo& info) const;
+
+  /// Return false if the entry doesn't exist or it is not valid.
+  bool load(const QString& key, PJ::PlotDataMapRef& destination);
+
+  /// Store the series of source listed in names (numeric and strings only).
+  /// Nothing is stored if any of them is a user_defined series: the entry would be incomplete.
+  bool store(const QString& key, const PJ::PlotDataMapRef& source,
+             const std::unordered_set<std::string>& names);
+
+  /// As store(), but the points are written by a worker thread.
+  /// The series must not be modified or deleted until waitForStore() returns.
+  void storeInBackground(const QString& key, const PJ::PlotDataMapRef& source,
+                         const std::unordered_set<std::string>& names);
+
+  void waitForStore();
+
+  /// Remove all the entries.
+  void clear();
+
+private:
+  QString _directory;
+  bool _enabled = false;
+  qint64 _max_size = 0;
+
+  QString entryPath(const QString& key) const;
+
+  // an entry ready to be written: the header is serialized, the columns are not
+  struct Entry
+  {
+    QString path;
+    QByteArray header;
+    std::vector<const PJ::PlotData*> numeric_series;
+    std::vector<const PJ::StringSeries*> string_series;
+  };
+
+  // also merges the pending samples of the series: afterward, they are only read
+  bool prepareEntry(const QString& key, const PJ::PlotDataMapRef& source,
+                    const std::unordered_set<std::string>& names, Entry& entry) const;
+
+  bool writeEntry(const Entry& entry);
+
+  void evict(const QString& keep_path);
+
+  // a single thread: the entries are written (and evicted) one at a time.
+  // Declared last, to be destroyed first, after the running job is completed.
+  QThreadPool _store_pool;
+};
+
+#endif  // DATAFILE_CACHE_H
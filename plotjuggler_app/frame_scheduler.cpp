@@ -0,0 +1,78 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "frame_scheduler.h"
+#include <algorithm>
+#include <QSettings>
+
+namespace
+{
+const int MIN_FRAME_INTERVAL_MS = 16;
+const int MAX_FRAME_INTERVAL_MS = 500;
+const int DEFAULT_FRAME_INTERVAL_MS = 40;
+}  // namespace
+
+FrameScheduler::FrameScheduler(QObject* parent) : QObject(parent)
+{
+  _timer.setTimerType(Qt::PreciseTimer);
+  connect(&_timer, &QTimer::timeout, this, &FrameScheduler::onTimeout);
+  loadSettings();
+}
+
+void FrameScheduler::start()
+{
+  _avg_frame_time_ms = 0;
+  _stats_frame_count = 0;
+  _stats_frame_time_ms = 0;
+  _stats_timer.start();
+  _timer.start(DEFAULT_FRAME_INTERVAL_MS);
+}
+
+void FrameScheduler::stop()
+{
+  _timer.stop();
+  _dirty = false;
+}
+
+void FrameScheduler::loadSettings()
+{
+  QSettings settings;
+  int percent = settings.value("Preferences::streaming_cpu_budget", 25).toInt();
+  _cpu_budget = std::clamp(percent, 1, 100) / 100.0;
+}
+
+void FrameScheduler::onTimeout()
+{
+  if (_dirty.exchange(false, std::memory_order_acquire))
+  {
+    QElapsedTimer frame_timer;
+    frame_timer.start();
+    emit frameRequested();
+    const double frame_time_ms = frame_timer.nsecsElapsed() * 1e-6;
+
+    _avg_frame_time_ms = (_avg_frame_time_ms == 0) ?
+                             frame_time_ms :
+                             (0.8 * _avg_frame_time_ms + 0.2 * frame_time_ms);
+    _stats_frame_count++;
+    _stats_frame_time_ms += frame_time_ms;
+
+    // if drawing takes T ms, a frame every T/budget ms keeps the CPU usage in the budget
+    const int interval = int(_avg_frame_time_ms / _cpu_budget);
+    _timer.setInterval(std::clamp(interval, MIN_FRAME_INTERVAL_MS, MAX_FRAME_INTERVAL_MS));
+  }
+
+  const qint64 elapsed_ms = _stats_timer.elapsed();
+  if (elapsed_ms >= 1000)
+  {
+    const double fps = _stats_frame_count * 1000.0 / elapsed_ms;
+    const double frame_time =
+        (_stats_frame_count > 0) ? (_stats_frame_time_ms / _stats_frame_count) : 0.0;
+    emit statisticsUpdated(fps, frame_time);
+    _stats_frame_count = 0;
+    _stats_frame_time_ms = 0;
+    _stats_timer.restart();
+  }
+}
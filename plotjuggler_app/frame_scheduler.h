@@ -0,0 +1,73 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <atomic>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+/**
+ * Decides when the plots are redrawn while streaming.
+ *
+ * The streamers call notify() from their own threads, possibly thousands of times per
+ * second: it only sets an atomic flag, no event is queued. A timer in the GUI thread checks
+ * the flag and emits frameRequested() at most once per interval.
+ *
+ * The interval adapts to the measured duration of the frames, so that drawing does not
+ * use more than a fraction ("CPU budget") of the GUI thread, within [1/60 s, 1/2 s].
+ */
+class FrameScheduler : public QObject
+{
+  Q_OBJECT
+public:
+  FrameScheduler(QObject* parent);
+
+  /// Thread-safe.
+  void notify()
+  {
+    _dirty.store(true, std::memory_order_release);
+  }
+
+  void start();
+
+  void stop();
+
+  /// Read again the budget from the settings (Preferences::streaming_cpu_budget).
+  void loadSettings();
+
+  /// Fraction of the time of the GUI thread that the frames may use.
+  double cpuBudget() const
+  {
+    return _cpu_budget;
+  }
+
+signals:
+
+  /// The handlers of this signal are part of the measured frame time.
+  void frameRequested();
+
+  /// Emitted about once per second.
+  void statisticsUpdated(double frames_per_second, double frame_time_ms);
+
+private:
+  void onTimeout();
+
+  QTimer _timer;
+  std::atomic_bool _dirty = { false };
+  double _cpu_budget = 0.25;
+
+  // exponential moving average of the duration of a frame
+  double _avg_frame_time_ms = 0;
+
+  QElapsedTimer _stats_timer;
+  int _stats_frame_count = 0;
+  double _stats_frame_time_ms = 0;
+};
+
+#endif  // FRAME_SCHEDULER_H
@@ -209,15 +209,15 @@ int main(int argc, char* argv[])
   app.setApplicationVersion(VERSION_STRING);
 
   //---------------------------
-  TransformFactory::registerTransform<FirstDerivative>();
-  TransformFactory::registerTransform<ScaleTransform>();
-  TransformFactory::registerTransform<MovingAverageFilter>();
-  TransformFactory::registerTransform<MovingRMS>();
-  TransformFactory::registerTransform<OutlierRemovalFilter>();
-  TransformFactory::registerTransform<IntegralTransform>();
-  TransformFactory::registerTransform<AbsoluteTransform>();
-  TransformFactory::registerTransform<MovingVarianceFilter>();
-  TransformFactory::registerTransform<SamplesCountFilter>();
+  TransformFactory::registerTransform<FirstDerivative>(true);
+  TransformFactory::registerTransform<ScaleTransform>(true);
+  TransformFactory::registerTransform<MovingAverageFilter>(true);
+  TransformFactory::registerTransform<MovingRMS>(true);
+  TransformFactory::registerTransform<OutlierRemovalFilter>(true);
+  TransformFactory::registerTransform<IntegralTransform>(true);
+  TransformFactory::registerTransform<AbsoluteTransform>(true);
+  TransformFactory::registerTransform<MovingVarianceFilter>(true);
+  TransformFactory::registerTransform<SamplesCountFilter>(true);
   //---------------------------
 
   QCommandLineParser parser;
@@ -16,7 +16,9 @@
 #include <QDomDocument>
 #include <QDoubleSpinBox>
 #include <QElapsedTimer>
+#include <QEventLoop>
 #include <QFileDialog>
+#include <QFutureWatcher>
 #include <QInputDialog>
 #include <QMenu>
 #include <QGroupBox>
@@ -24,6 +26,7 @@
 #include <QMimeData>
 #include <QMouseEvent>
 #include <QPluginLoader>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QKeySequence>
 #include <QScrollBar>
@@ -36,6 +39,7 @@
 #include <QHeaderView>
 #include <QStandardPaths>
 #include <QXmlStreamReader>
+#include <QtConcurrent>
 
 #include "mainwindow.h"
 #include "curvelist_panel.h"
@@ -48,7 +52,9 @@
 #include "dummy_data.h"
 #include "PlotJuggler/svg_util.h"
 #include "PlotJuggler/reactive_function.h"
+#include "PlotJuggler/profiler.h"
 #include "multifile_prefix.h"
+#include "point_series_xy.h"
 
 #include "ui_aboutdialog.h"
 #include "ui_support_dialog.h"
@@ -75,6 +81,8 @@ MainWindow::MainWindow(const QCommandLineParser& commandline_parser, QWidget* pa
   , _playback_shotcut(Qt::Key_Space, this)
   , _minimized(false)
   , _active_streamer_plugin(nullptr)
+  , _undo_history([this]() { return xmlSaveState(); },
+                  [this](const QDomDocument& doc) { xmlLoadState(doc); })
   , _disable_undo_logging(false)
   , _tracker_time(0)
   , _tracker_param(CurveTracker::VALUE)
@@ -172,6 +180,7 @@ MainWindow::MainWindow(const QCommandLineParser& commandline_parser, QWidget* pa
 
   ui->labelStreamingAnimation->setMovie(_animated_streaming_movie);
   ui->labelStreamingAnimation->setHidden(true);
+  ui->labelStreamingFps->setHidden(true);
 
   connect(this, &MainWindow::stylesheetChanged, this, &MainWindow::on_stylesheetChanged);
 
@@ -201,6 +210,10 @@ MainWindow::MainWindow(const QCommandLineParser& commandline_parser, QWidget* pa
           [this]() { ui->playbackStep->clearFocus(); });
 
   connect(_curvelist_widget, &CurveListPanel::requestDeleteAll, this, [this](int option) {
+    if (warnIfLoadingInBackground())
+    {
+      return;
+    }
     if (option == 1)
     {
       deleteAllData();
@@ -238,18 +251,34 @@ MainWindow::MainWindow(const QCommandLineParser& commandline_parser, QWidget* pa
 
   _default_streamer = commandline_parser.value("start_streamer");
 
+  // must exist before the streamers are loaded
+  _frame_scheduler = new FrameScheduler(this);
+  _show_streaming_fps = settings.value("Preferences::streaming_show_fps", true).toBool();
+  connect(_frame_scheduler, &FrameScheduler::frameRequested, this,
+          &MainWindow::onStreamingFrame);
+  connect(_frame_scheduler, &FrameScheduler::statisticsUpdated, this,
+          [this](double fps, double frame_time_ms) {
+            ui->labelStreamingFps->setText(QString("%1 fps").arg(fps, 0, 'f', 0));
+            ui->labelStreamingFps->setToolTip(
+                tr("Plots refreshed %1 times per second, %2 ms per refresh")
+                    .arg(fps, 0, 'f', 1)
+                    .arg(frame_time_ms, 0, 'f', 1));
+          });
+
+  // the profiler is shared with the plugins: it must be created before they are loaded
+  PJ::Profiler::instance();
+  _profiler_panel = new ProfilerPanel(this);
+  addDockWidget(Qt::BottomDockWidgetArea, _profiler_panel);
+  _profiler_panel->hide();
+  ui->menuTools->addAction(_profiler_panel->toggleViewAction());
+
   loadAllPlugins(plugin_extra_folders);
 
   //------------------------------------
 
-  _undo_timer.start();
-
   // save initial state
   onUndoableChange();
 
-  _replot_timer = new QTimer(this);
-  connect(_replot_timer, &QTimer::timeout, this, [this]() { updateDataAndReplot(false); });
-
   _publish_timer = new QTimer(this);
   _publish_timer->setInterval(20);
   connect(_publish_timer, &QTimer::timeout, this, &MainWindow::onPlaybackLoop);
@@ -386,59 +415,32 @@ MainWindow::~MainWindow()
   delete ui;
 }
 
+void MainWindow::waitForBackgroundJobs()
+{
+  PlotWidget::waitForBackgroundUpdates();
+  _data_cache.waitForStore();
+}
+
 void MainWindow::onUndoableChange()
 {
   if (_disable_undo_logging)
     return;
 
-  int elapsed_ms = _undo_timer.restart();
-
-  // overwrite the previous
-  if (elapsed_ms < 100)
-  {
-    if (_undo_states.empty() == false)
-      _undo_states.pop_back();
-  }
-
-  while (_undo_states.size() >= 100)
-    _undo_states.pop_front();
-  _undo_states.push_back(xmlSaveState());
-  _redo_states.clear();
-  // qDebug() << "undo " << _undo_states.size();
+  // when the sender is a plot, only its changes are recorded
+  _undo_history.recordChange(qobject_cast<PlotWidget*>(sender()));
 }
 
 void MainWindow::onRedoInvoked()
 {
   _disable_undo_logging = true;
-  if (_redo_states.size() > 0)
-  {
-    QDomDocument state_document = _redo_states.back();
-    while (_undo_states.size() >= 100)
-      _undo_states.pop_front();
-    _undo_states.push_back(state_document);
-    _redo_states.pop_back();
-
-    xmlLoadState(state_document);
-  }
-  // qDebug() << "undo " << _undo_states.size();
+  _undo_history.redo();
   _disable_undo_logging = false;
 }
 
 void MainWindow::onUndoInvoked()
 {
   _disable_undo_logging = true;
-  if (_undo_states.size() > 1)
-  {
-    QDomDocument state_document = _undo_states.back();
-    while (_redo_states.size() >= 100)
-      _redo_states.pop_front();
-    _redo_states.push_back(state_document);
-    _undo_states.pop_back();
-    state_document = _undo_states.back();
-
-    xmlLoadState(state_document);
-  }
-  // qDebug() << "undo " << _undo_states.size();
+  _undo_history.undo();
   _disable_undo_logging = false;
 }
 
@@ -475,9 +477,11 @@ void MainWindow::onTrackerTimeUpdated(double absolute_time, bool do_replot)
 
   updateReactivePlots();
 
+  // The tracker of the timeseries plots is drawn on an overlay, that doesn't
+  // need a replot. The markers of the XY plots, instead, are items of the plot.
   forEachWidget([&](PlotWidget* plot) {
     plot->setTrackerPosition(_tracker_time);
-    if (do_replot)
+    if (do_replot && plot->isXYPlot())
     {
       plot->replot();
     }
@@ -762,20 +766,14 @@ QStringList MainWindow::initializePlugins(QString directory_name)
         connect(streamer, &DataStreamer::clearBuffers, this,
                 &MainWindow::on_actionClearBuffer_triggered);
 
-        connect(streamer, &DataStreamer::dataReceived, _animated_streaming_movie, [this]() {
-          _animated_streaming_movie->start();
-          _animated_streaming_timer->start(500);
-        });
-
         connect(streamer, &DataStreamer::removeGroup, this, &MainWindow::on_deleteSerieFromGroup);
 
-        connect(streamer, &DataStreamer::dataReceived, this, [this]() {
-          if (isStreamingActive() && !_replot_timer->isActive())
-          {
-            _replot_timer->setSingleShot(true);
-            _replot_timer->start(40);
-          }
-        });
+        // dataReceived is emitted by the thread of the streamer, once per message:
+        // nothing is queued to the GUI thread, the FrameScheduler polls a flag.
+        FrameScheduler* scheduler = _frame_scheduler;
+        connect(
+            streamer, &DataStreamer::dataReceived, this, [scheduler]() { scheduler->notify(); },
+            Qt::DirectConnection);
 
         connect(streamer, &DataStreamer::notificationsChanged, this,
                 &MainWindow::on_streamingNotificationsChanged);
@@ -978,7 +976,10 @@ void MainWindow::onPlotZoomChanged(PlotWidget* modified_plot, QRectF new_range)
     this->forEachWidget(visitor);
   }
 
-  onUndoableChange();
+  if (!_disable_undo_logging)
+  {
+    _undo_history.recordChange(modified_plot);
+  }
 }
 
 void MainWindow::onPlotTabAdded(PlotDocker* docker)
@@ -987,6 +988,10 @@ void MainWindow::onPlotTabAdded(PlotDocker* docker)
 
   connect(this, &MainWindow::stylesheetChanged, docker, &PlotDocker::on_stylesheetChanged);
 
+  // the plots of a tab that was hidden are zoomed like the visible ones
+  connect(docker, &PlotDocker::outdatedPlotsUpdated, this,
+          [this](const std::unordered_set<PlotWidget*>& plots) { zoomOutPlots(&plots); });
+
   // TODO  connect(matrix, &PlotMatrix::undoableChange, this,
   // &MainWindow::onUndoableChange);
 }
@@ -1151,6 +1156,12 @@ bool MainWindow::xmlLoadState(QDomDocument state_document)
 
 void MainWindow::onDeleteMultipleCurves(const std::vector<std::string>& curve_names)
 {
+  if (warnIfLoadingInBackground())
+  {
+    return;
+  }
+  waitForBackgroundJobs();
+
   std::set<std::string> to_be_deleted;
   for (auto& name : curve_names)
   {
@@ -1268,14 +1279,14 @@ void MainWindow::updateRecentLayoutMenu(QStringList new_filenames)
 
 void MainWindow::deleteAllData()
 {
+  waitForBackgroundJobs();
   forEachWidget([](PlotWidget* plot) { plot->removeAllCurves(); });
 
   _mapped_plot_data.clear();
   _transform_functions.clear();
   _curvelist_widget->clear();
   _loaded_datafiles_history.clear();
-  _undo_states.clear();
-  _redo_states.clear();
+  _undo_history.clear();
 
   bool stopped = false;
 
@@ -1305,6 +1316,8 @@ void MainWindow::deleteAllData()
 
 void MainWindow::importPlotDataMap(PlotDataMapRef& new_data, bool remove_old)
 {
+  waitForBackgroundJobs();
+
   if (remove_old)
   {
     auto ClearOldSeries = [](auto& prev_plot_data, auto& new_plot_data) {
@@ -1337,6 +1350,164 @@ void MainWindow::importPlotDataMap(PlotDataMapRef& new_data, bool remove_old)
   }
 }
 
+bool MainWindow::readDataInBackground(DataLoaderPtr dataloader, FileLoadInfo* info,
+                                      PlotDataMapRef& loaded_data,
+                                      std::unordered_set<std::string>& added_names)
+{
+  dataloader->resetLoadingState();
+  if (!dataloader->prepareRead(info, loaded_data))
+  {
+    return false;
+  }
+
+  const std::string prefix = info->prefix.toStdString();
+  std::string error_message;
+
+  QProgressDialog progress_dialog(
+      tr("Loading %1...").arg(QFileInfo(info->filename).fileName()), tr("Stop"), 0, 1000, this);
+  progress_dialog.setWindowTitle(tr("Loading data"));
+  progress_dialog.setWindowModality(Qt::NonModal);
+  progress_dialog.setMinimumDuration(0);
+  progress_dialog.setValue(0);
+  connect(&progress_dialog, &QProgressDialog::canceled, this,
+          [dataloader]() { dataloader->cancel(); });
+
+  // The data parsed so far is displayed periodically, while the worker thread
+  // keeps reading the file.
+  QTimer publish_timer;
+  publish_timer.setInterval(500);
+  connect(&publish_timer, &QTimer::timeout, this, [&]() {
+    importPartialData(*dataloader, loaded_data, prefix, false, added_names);
+    updateDataAndReplot(true);
+    progress_dialog.setValue(static_cast<int>(1000 * dataloader->progress()));
+  });
+
+  // The nested event loop keeps the plots responsive, but the data must not be deleted
+  // or replaced meanwhile: the actions that do it are disabled, or refused by
+  // warnIfLoadingInBackground().
+  const bool clear_buffer_enabled = ui->actionClearBuffer->isEnabled();
+  const bool delete_all_enabled = ui->actionDeleteAllData->isEnabled();
+  ui->frameFile->setEnabled(false);
+  ui->actionClearBuffer->setEnabled(false);
+  ui->actionDeleteAllData->setEnabled(false);
+
+  QEventLoop event_loop;
+  QFutureWatcher<bool> watcher;
+  connect(&watcher, &QFutureWatcher<bool>::finished, &event_loop, &QEventLoop::quit);
+
+  _background_loader = dataloader;
+  watcher.setFuture(QtConcurrent::run([&]() -> bool {
+    try
+    {
+      return dataloader->readDataFromFile(info, loaded_data);
+    }
+    catch (std::exception& ex)
+    {
+      error_message = ex.what();
+      return false;
+    }
+  }));
+  publish_timer.start();
+
+  event_loop.exec();
+
+  // the event loop may also be interrupted by QApplication::quit()
+  if (!watcher.isFinished())
+  {
+    dataloader->cancel();
+    watcher.waitForFinished();
+  }
+  publish_timer.stop();
+  _background_loader.reset();
+  ui->frameFile->setEnabled(true);
+  ui->actionClearBuffer->setEnabled(clear_buffer_enabled);
+  ui->actionDeleteAllData->setEnabled(delete_all_enabled);
+
+  importPartialData(*dataloader, loaded_data, prefix, true, added_names);
+  progress_dialog.reset();
+
+  if (!error_message.empty())
+  {
+    throw std::runtime_error(error_message);
+  }
+  return watcher.result();
+}
+
+bool MainWindow::warnIfLoadingInBackground()
+{
+  if (!_background_loader)
+  {
+    return false;
+  }
+  QMessageBox::warning(this, tr("Loading data"),
+                       tr("Wait until the file being loaded is completed, or stop it."));
+  return true;
+}
+
+void MainWindow::importPartialData(DataLoader& dataloader, PlotDataMapRef& loaded_data,
+                                   const std::string& prefix, bool include_empty,
+                                   std::unordered_set<std::string>& imported_names)
+{
+  PlotDataMapRef new_data;
+  std::vector<std::string> new_names;
+
+  // Take the points out of loaded_data, leaving its series in place:
+  // the parsers used by the loader may keep pointers to them.
+  auto takePoints = [&](auto& source_series, auto& destination_series, bool add_prefix) {
+    for (auto& [name, source_plot] : source_series)
+    {
+      if (source_plot.size() == 0 && !include_empty)
+      {
+        continue;
+      }
+      std::string ID = name;
+      if (add_prefix && !prefix.empty())
+      {
+        ID = (name.front() == '/') ? (prefix + name) : (prefix + "/" + name);
+      }
+      // named after the key: only the points and the attributes are moved
+      auto& destination_plot =
+          destination_series
+              .emplace(std::piecewise_construct, std::forward_as_tuple(ID),
+                       std::forward_as_tuple(ID, source_plot.group()))
+              .first->second;
+      destination_plot.clonePoints(std::move(source_plot));
+      destination_plot.attributes() = source_plot.attributes();
+      source_plot.clear();
+
+      if (imported_names.insert(ID).second)
+      {
+        new_names.push_back(ID);
+      }
+    }
+  };
+
+  {
+    auto lock = dataloader.requestLock();
+    takePoints(loaded_data.numeric, new_data.numeric, true);
+    takePoints(loaded_data.strings, new_data.strings, true);
+    takePoints(loaded_data.user_defined, new_data.user_defined, false);
+  }
+
+  // The first time a series is received, it replaces the one with the same name
+  // that might have been loaded previously.
+  for (const auto& name : new_names)
+  {
+    auto ClearOldSeries = [&name](auto& prev_plot_data) {
+      auto it = prev_plot_data.find(name);
+      if (it != prev_plot_data.end())
+      {
+        it->second.clear();
+      }
+    };
+    ClearOldSeries(_mapped_plot_data.numeric);
+    ClearOldSeries(_mapped_plot_data.strings);
+    ClearOldSeries(_mapped_plot_data.user_defined);
+  }
+
+  importPlotDataMap(new_data, false);
+}
+
 bool MainWindow::isStreamingActive() const
 {
   return !ui->buttonStreamingPause->isChecked() && _active_streamer_plugin;
@@ -1428,6 +1599,11 @@ bool MainWindow::loadDataFromFiles(QStringList filenames)
 
 std::unordered_set<std::string> MainWindow::loadDataFromFile(const FileLoadInfo& info)
 {
+  if (warnIfLoadingInBackground())
+  {
+    return {};
+  }
+
   ui->buttonPlay->setChecked(false);
 
   const QString extension = QFileInfo(info.filename).suffix().toLower();
@@ -1511,18 +1687,44 @@ std::unordered_set<std::string> MainWindow::loadDataFromFile(const FileLoadInfo&
         dataloader->xmlLoadState(info.plugin_config.firstChildElement());
       }
 
-      if (dataloader->readDataFromFile(&new_info, mapped_data))
+      bool loaded = false;
+      bool loaded_from_cache = false;
+      PlotDataMapRef cached_data;
+
+      if (_data_cache.isEnabled() &&
+          _data_cache.load(_data_cache.key(dataloader->name(), info), cached_data))
+      {
+        added_names = cached_data.getAllNames();
+        importPlotDataMap(cached_data, true);
+        loaded = loaded_from_cache = true;
+      }
+      else if (dataloader->supportsBackgroundLoading())
+      {
+        loaded = readDataInBackground(dataloader, &new_info, mapped_data, added_names);
+      }
+      else if (dataloader->readDataFromFile(&new_info, mapped_data))
       {
         AddPrefixToPlotData(info.prefix.toStdString(), mapped_data.numeric);
         AddPrefixToPlotData(info.prefix.toStdString(), mapped_data.strings);
 
         added_names = mapped_data.getAllNames();
         importPlotDataMap(mapped_data, true);
+        loaded = true;
+      }
 
+      if (loaded)
+      {
         QDomElement plugin_elem = dataloader->xmlSaveState(new_info.plugin_config);
         new_info.plugin_config.appendChild(plugin_elem);
         _loaded_datafiles_previous.push_back(new_info);
 
+        // partially loaded files are not cached
+        if (_data_cache.isEnabled() && !loaded_from_cache && !dataloader->isCancelled())
+        {
+          _data_cache.storeInBackground(_data_cache.key(dataloader->name(), new_info),
+                                        _mapped_plot_data, added_names);
+        }
+
         bool duplicate = false;
 
         // substitute an old item of _loaded_datafiles or push_back another item.
@@ -1637,7 +1839,9 @@ void MainWindow::stopStreamingPlugin()
   ui->buttonStreamingStart->setText("Start");
   ui->buttonStreamingPause->setEnabled(false);
   ui->labelStreamingAnimation->setHidden(true);
+  ui->labelStreamingFps->setHidden(true);
   enableStreamingNotificationsButton(false);
+  _frame_scheduler->stop();
 
   // force the cleanups typically done in on_buttonStreamingPause_toggled
   if (ui->buttonStreamingPause->isChecked())
@@ -1668,6 +1872,10 @@ void MainWindow::stopStreamingPlugin()
 
 void MainWindow::startStreamingPlugin(QString streamer_name)
 {
+  if (warnIfLoadingInBackground())
+  {
+    return;
+  }
   if (_active_streamer_plugin)
   {
     _active_streamer_plugin->shutdown();
@@ -1723,6 +1931,9 @@ void MainWindow::startStreamingPlugin(QString streamer_name)
     ui->buttonStreamingPause->setChecked(false);
     ui->comboStreaming->setEnabled(false);
     ui->labelStreamingAnimation->setHidden(false);
+    ui->labelStreamingFps->setText("");
+    ui->labelStreamingFps->setHidden(!_show_streaming_fps);
+    _frame_scheduler->start();
 
     // force start
     on_buttonStreamingPause_toggled(false);
@@ -1798,7 +2009,10 @@ void MainWindow::updateReactivePlots()
   {
     if (auto reactive_function = std::dynamic_pointer_cast<PJ::ReactiveLuaFunction>(it.second))
     {
+      // the reactive functions overwrite their series
+      PlotWidget::waitForBackgroundUpdates();
       reactive_function->setTimeTracker(_tracker_time);
+      ScopedTimer timer(reactive_function->profilerScope());
       reactive_function->calculate();
 
       for (auto& name : reactive_function->createdCurves())
@@ -1953,25 +2167,32 @@ std::tuple<double, double, int> MainWindow::calculateVisibleRangeX()
   double max_time = std::numeric_limits<double>::lowest();
   int max_steps = 0;
 
+  auto addCurve = [&](const std::string& curve_name) {
+    auto plot_it = _mapped_plot_data.numeric.find(curve_name);
+    if (plot_it == _mapped_plot_data.numeric.end())
+    {
+      return;  // FIXME?
+    }
+    const auto& data = plot_it->second;
+    if (data.size() >= 1)
+    {
+      const double t0 = data.front().x;
+      const double t1 = data.back().x;
+      min_time = std::min(min_time, t0);
+      max_time = std::max(max_time, t1);
+      max_steps = std::max(max_steps, (int)data.size());
+    }
+  };
+
   forEachWidget([&](const PlotWidget* widget) {
     for (auto& it : widget->curveList())
     {
-      const auto& curve_name = it.src_name;
-
-      auto plot_it = _mapped_plot_data.numeric.find(curve_name);
-      if (plot_it == _mapped_plot_data.numeric.end())
-      {
-        continue;  // FIXME?
-      }
-      const auto& data = plot_it->second;
-      if (data.size() >= 1)
-      {
-        const double t0 = data.front().x;
-        const double t1 = data.back().x;
-        min_time = std::min(min_time, t0);
-        max_time = std::max(max_time, t1);
-        max_steps = std::max(max_steps, (int)data.size());
-      }
+      addCurve(it.src_name);
+    }
+    // plots of the tabs not shown yet
+    for (const auto& name : widget->pendingCurveNames())
+    {
+      addCurve(name);
     }
   });
 
@@ -2004,6 +2225,10 @@ std::tuple<double, double, int> MainWindow::calculateVisibleRangeX()
 
 bool MainWindow::loadLayoutFromFile(QString filename)
 {
+  if (warnIfLoadingInBackground())
+  {
+    return false;
+  }
   QSettings settings;
 
   QFile file(filename);
@@ -2238,13 +2463,21 @@ bool MainWindow::loadLayoutFromFile(QString filename)
 
   linkedZoomOut();
 
-  _undo_states.clear();
-  _undo_states.push_back(domDocument);
+  _undo_history.reset(domDocument);
   return true;
 }
 
 void MainWindow::linkedZoomOut()
 {
+  zoomOutPlots(nullptr);
+}
+
+void MainWindow::zoomOutPlots(const std::unordered_set<PlotWidget*>* updated_plots)
+{
+  auto IsUpdated = [updated_plots](PlotWidget* plot) {
+    return !updated_plots || updated_plots->count(plot) != 0;
+  };
+
   if (ui->buttonLink->isChecked())
   {
     for (const auto& it : TabbedPlotWidget::instances())
@@ -2260,7 +2493,8 @@ void MainWindow::linkedZoomOut()
           for (int index = 0; index < matrix->plotCount(); index++)
           {
             PlotWidget* plot = matrix->plotAt(index);
-            if (plot->isEmpty())
+            // hidden plots are zoomed when they are updated, see updateDataAndReplot()
+            if (plot->isEmpty() || plot->curvesOutdated())
             {
               continue;
             }
@@ -2282,7 +2516,14 @@ void MainWindow::linkedZoomOut()
           for (int index = 0; index < matrix->plotCount() && !first; index++)
           {
             PlotWidget* plot = matrix->plotAt(index);
-            if (plot->isEmpty())
+            if (plot->isEmpty() || plot->curvesOutdated())
+            {
+              continue;
+            }
+            // a plot without new data must be redrawn only if the shared range changed
+            const QRectF current_rect = plot->currentBoundingRect();
+            if (!IsUpdated(plot) && current_rect.left() == range.min &&
+                current_rect.right() == range.max)
             {
               continue;
             }
@@ -2298,7 +2539,12 @@ void MainWindow::linkedZoomOut()
   }
   else
   {
-    this->forEachWidget([](PlotWidget* plot) { plot->zoomOut(false); });
+    this->forEachWidget([&](PlotWidget* plot) {
+      if (IsUpdated(plot) && !plot->curvesOutdated())
+      {
+        plot->zoomOut(false);
+      }
+    });
   }
 }
 
@@ -2363,12 +2609,32 @@ void MainWindow::updateTimeOffset()
   }
 }
 
-void MainWindow::updateDataAndReplot(bool replot_hidden_tabs)
+void MainWindow::onStreamingFrame()
 {
-  _replot_timer->stop();
+  _animated_streaming_movie->start();
+  _animated_streaming_timer->start(500);
+
+  if (isStreamingActive())
+  {
+    updateDataAndReplot(false, true);
+  }
+}
 
+void MainWindow::updateDataAndReplot(bool replot_hidden_tabs, bool only_updated_plots)
+{
   MoveDataRet move_ret;
 
+  // the data and the transforms are about to change; the plots of a layout loaded
+  // without streaming don't need to wait
+  if (_active_streamer_plugin || !_transform_functions.empty())
+  {
+    PlotWidget::waitForBackgroundUpdates();
+  }
+  if (_active_streamer_plugin)
+  {
+    _data_cache.waitForStore();
+  }
+
   if (_active_streamer_plugin)
   {
     {
@@ -2416,11 +2682,63 @@ void MainWindow::updateDataAndReplot(bool replot_hidden_tabs)
   {
     if (dynamic_cast<ReactiveLuaFunction*>(function) == nullptr)
     {
+      ScopedTimer timer(function->profilerScope());
       function->calculate();
     }
   }
 
-  forEachWidget([](PlotWidget* plot) { plot->updateCurves(false); });
+  // the plots of the tabs that are not shown are updated when they become visible
+  // (PlotDocker::updateOutdatedPlots), unless replot_hidden_tabs is true
+  auto UpdateCurves = [replot_hidden_tabs](PlotWidget* plot, PlotDocker* matrix) {
+    if (replot_hidden_tabs || matrix->isVisible())
+    {
+      plot->updateCurves(false);
+    }
+    else
+    {
+      plot->setCurvesOutdated();
+    }
+  };
+
+  std::unordered_set<PlotWidget*> updated_plots;
+  if (only_updated_plots)
+  {
+    // the output of the transforms is assumed to change when any data is received
+    std::unordered_set<std::string> updated_curves(move_ret.updated_curves.begin(),
+                                                   move_ret.updated_curves.end());
+    if (move_ret.data_pushed)
+    {
+      for (const auto& [id, function] : _transform_functions)
+      {
+        updated_curves.insert(id);
+      }
+    }
+    // the src_name of a XY curve is its own name: match the names of its X and Y series
+    auto IsUpdated = [&](const PlotWidget::CurveInfo& curve) {
+      if (updated_curves.count(curve.src_name) != 0)
+      {
+        return true;
+      }
+      auto curve_xy = dynamic_cast<const PointSeriesXY*>(curve.curve->data());
+      return curve_xy && (updated_curves.count(curve_xy->dataX()->plotName()) != 0 ||
+                          updated_curves.count(curve_xy->dataY()->plotName()) != 0);
+    };
+    forEachWidget([&](PlotWidget* plot, PlotDocker* matrix, int) {
+      for (const auto& curve : plot->curveList())
+      {
+        if (IsUpdated(curve))
+        {
+          updated_plots.insert(plot);
+          UpdateCurves(plot, matrix);
+          break;
+        }
+      }
+    });
+  }
+  else
+  {
+    forEachWidget([&](PlotWidget* plot, PlotDocker* matrix, int) { UpdateCurves(plot, matrix); });
+  }
 
   //--------------------------------
   // trigger again the execution of this callback if steaming == true
@@ -2437,7 +2755,7 @@ void MainWindow::updateDataAndReplot(bool replot_hidden_tabs)
     updateTimeSlider();
   }
   //--------------------------------
-  linkedZoomOut();
+  zoomOutPlots(only_updated_plots ? &updated_plots : nullptr);
 }
 
 void MainWindow::on_streamingSpinBox_valueChanged(int value)
@@ -2545,6 +2863,12 @@ void MainWindow::on_buttonPlay_toggled(bool checked)
 
 void MainWindow::on_actionClearBuffer_triggered()
 {
+  if (warnIfLoadingInBackground())
+  {
+    return;
+  }
+  waitForBackgroundJobs();
+
   for (auto& it : _mapped_plot_data.numeric)
   {
     it.second.clear();
@@ -2654,9 +2978,14 @@ void MainWindow::on_buttonTimeTracker_pressed()
 
 void MainWindow::closeEvent(QCloseEvent* event)
 {
-  _replot_timer->stop();
+  _frame_scheduler->stop();
   _publish_timer->stop();
 
+  if (_background_loader)
+  {
+    _background_loader->cancel();
+  }
+
   if (_active_streamer_plugin)
   {
     _active_streamer_plugin->shutdown();
@@ -2757,12 +3086,17 @@ void MainWindow::onPlaybackLoop()
 
   forEachWidget([&](PlotWidget* plot) {
     plot->setTrackerPosition(_tracker_time);
-    plot->replot();
+    if (plot->isXYPlot())
+    {
+      plot->replot();
+    }
   });
 }
 
 void MainWindow::onCustomPlotCreated(std::vector<CustomPlotPtr> custom_plots)
 {
+  waitForBackgroundJobs();
+
   std::set<PlotWidget*> widget_to_replot;
 
   for (auto custom_plot : custom_plots)
@@ -3230,6 +3564,10 @@ void MainWindow::on_actionClearRecentLayout_triggered()
 
 void MainWindow::on_actionDeleteAllData_triggered()
 {
+  if (warnIfLoadingInBackground())
+  {
+    return;
+  }
   QMessageBox msgBox(this);
   msgBox.setWindowTitle("Warning. Can't be undone.");
   msgBox.setText(tr("Do you want to remove the previously loaded data?\n"));
@@ -3253,6 +3591,12 @@ void MainWindow::on_actionPreferences_triggered()
 
   PreferencesDialog dialog;
   dialog.exec();
+  _data_cache.loadSettings();
+  _frame_scheduler->loadSettings();
+  forEachWidget([](PlotWidget* plot) { plot->updateTrackerSettings(); });
+  _show_streaming_fps = settings.value("Preferences::streaming_show_fps", true).toBool();
+  ui->labelStreamingFps->setHidden(!_show_streaming_fps || !_active_streamer_plugin);
+  _curvelist_widget->updatePreferences();
 
   QString theme = settings.value("Preferences::theme").toString();
 
@@ -24,6 +24,10 @@
 #include "tabbedplotwidget.h"
 #include "realslider.h"
 #include "utils.h"
+#include "datafile_cache.h"
+#include "frame_scheduler.h"
+#include "profiler_panel.h"
+#include "undo_history.h"
 #include "PlotJuggler/dataloader_base.h"
 #include "PlotJuggler/statepublisher_base.h"
 #include "PlotJuggler/toolbox_base.h"
@@ -85,7 +89,10 @@ public slots:
 
   void on_tabbedAreaDestroyed(QObject* object);
 
-  void updateDataAndReplot(bool replot_hidden_tabs);
+  /// If only_updated_plots is true, the plots that don't display any series that
+  /// received new data are not refreshed. If replot_hidden_tabs is false, the plots
+  /// that are not visible are refreshed only when they are shown.
+  void updateDataAndReplot(bool replot_hidden_tabs, bool only_updated_plots = false);
 
   void onUpdateLeftTableValues();
 
@@ -133,9 +140,7 @@ private:
 
   std::shared_ptr<DataStreamer> _active_streamer_plugin;
 
-  std::deque<QDomDocument> _undo_states;
-  std::deque<QDomDocument> _redo_states;
-  QElapsedTimer _undo_timer;
+  UndoHistory _undo_history;
   bool _disable_undo_logging;
 
   bool _test_option;
@@ -149,13 +154,19 @@ private:
 
   std::vector<FileLoadInfo> _loaded_datafiles_history;
   std::vector<FileLoadInfo> _loaded_datafiles_previous;
+  DataLoaderPtr _background_loader;
+  DataFileCache _data_cache;
   CurveTracker::Parameter _tracker_param;
 
   std::map<CurveTracker::Parameter, QIcon> _tracker_button_icons;
 
   MonitoredValue _time_offset;
 
-  QTimer* _replot_timer;
+  FrameScheduler* _frame_scheduler;
+
+  ProfilerPanel* _profiler_panel;
+
+  bool _show_streaming_fps = true;
   QTimer* _publish_timer;
   PJ::DelayedCallback _tracker_delay;
 
@@ -186,6 +197,11 @@ private:
   void forEachWidget(std::function<void(PlotWidget*, PlotDocker*, int)> op);
   void forEachWidget(std::function<void(PlotWidget*)> op);
 
+  // nullptr means all the plots
+  void zoomOutPlots(const std::unordered_set<PlotWidget*>* updated_plots);
+
+  void onStreamingFrame();
+
   void rearrangeGridLayout();
 
   QDomDocument xmlSaveState() const;
@@ -193,8 +209,22 @@ private:
 
   void checkAllCurvesFromLayout(const QDomElement& root);
 
+  // the background jobs read the series: wait for them before modifying or deleting them
+  void waitForBackgroundJobs();
+
   void importPlotDataMap(PlotDataMapRef& new_data, bool remove_old);
 
+  bool readDataInBackground(DataLoaderPtr dataloader, FileLoadInfo* info,
+                            PlotDataMapRef& loaded_data,
+                            std::unordered_set<std::string>& added_names);
+
+  // true, after showing a message, if a file is being loaded by readDataInBackground()
+  bool warnIfLoadingInBackground();
+
+  void importPartialData(DataLoader& dataloader, PlotDataMapRef& loaded_data,
+                         const std::string& prefix, bool include_empty,
+                         std::unordered_set<std::string>& imported_names);
+
   bool isStreamingActive() const;
 
   void closeEvent(QCloseEvent* event);
@@ -6,98 +6,278 @@
 
 #include "nlohmann_parsers.h"
 
-#include "fmt/format.h"
+#include <algorithm>
+#include <charconv>
 
-bool NlohmannParser::parseMessageImpl(double& timestamp)
+class NlohmannParser::SaxFlattener
 {
-  if (_use_message_stamp && _stamp_fieldname.empty() == false)
+public:
+  using json = nlohmann::json;
+
+  SaxFlattener(NlohmannParser& parser) : _parser(parser)
   {
-    auto ts = _json.find(_stamp_fieldname);
-    if (ts != _json.end() && ts.value().is_number())
+  }
+
+  bool stamp_found = false;
+  double stamp_value = 0;
+  size_t leaf_count = 0;
+
+  bool null()
+  {
+    beginValue();
+    return true;
+  }
+
+  bool boolean(bool val)
+  {
+    addLeaf(val ? 1.0 : 0.0, false);
+    return true;
+  }
+
+  bool number_integer(json::number_integer_t val)
+  {
+    addLeaf(static_cast<double>(val), true);
+    return true;
+  }
+
+  bool number_unsigned(json::number_unsigned_t val)
+  {
+    addLeaf(static_cast<double>(val), true);
+    return true;
+  }
+
+  bool number_float(json::number_float_t val, const json::string_t&)
+  {
+    addLeaf(static_cast<double>(val), true);
+    return true;
+  }
+
+  bool string(json::string_t&)
+  {
+    beginValue();
+    return true;
+  }
+
+  bool binary(json::binary_t&)
+  {
+    beginValue();
+    return true;
+  }
+
+  bool start_object(std::size_t)
+  {
+    beginValue();
+    _parser._path_stack.push_back({ _parser._path.size(), -1 });
+    return true;
+  }
+
+  bool end_object()
+  {
+    _parser._path_stack.pop_back();
+    return true;
+  }
+
+  bool start_array(std::size_t)
+  {
+    beginValue();
+    _parser._path_stack.push_back({ _parser._path.size(), 0 });
+    return true;
+  }
+
+  bool end_array()
+  {
+    _parser._path_stack.pop_back();
+    return true;
+  }
+
+  bool key(json::string_t& val)
+  {
+    auto& path = _parser._path;
+    path.resize(_parser._path_stack.back().length);
+    path.push_back('/');
+    path.append(val);
+    _parser._key_hashes.push_back(std::hash<std::string>()(path));
+    _is_stamp_key = (_parser._path_stack.size() == 1 && val == _parser._stamp_fieldname);
+    return true;
+  }
+
+  bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex)
+  {
+    throw std::runtime_error(ex.what());
+  }
+
+private:
+  NlohmannParser& _parser;
+  bool _is_stamp_key = false;
+
+  // Elements of an array are named after their index "prefix[i]"
+  void beginValue()
+  {
+    auto& stack = _parser._path_stack;
+    if (!stack.empty() && stack.back().next_index >= 0)
     {
-      timestamp = ts.value().get<double>();
+      auto& path = _parser._path;
+      path.resize(stack.back().length);
+
+      char buffer[24];
+      auto res = std::to_chars(buffer, buffer + sizeof(buffer), stack.back().next_index++);
+      path.push_back('[');
+      path.append(buffer, res.ptr);
+      path.push_back(']');
     }
-    else
+  }
+
+  void addLeaf(double value, bool is_number)
+  {
+    beginValue();
+    if (_is_stamp_key && is_number && _parser._path_stack.size() == 1)
     {
-      _use_message_stamp = false;
+      stamp_found = true;
+      stamp_value = value;
+    }
+    _parser.setLeaf(leaf_count++, value);
+  }
+};
+
+namespace
+{
+nlohmann::json parseDocument(const MessageRef& msg, nlohmann::json::input_format_t format)
+{
+  using json = nlohmann::json;
+  const uint8_t* begin = msg.data();
+  const uint8_t* end = msg.data() + msg.size();
+  switch (format)
+  {
+    case json::input_format_t::cbor:
+      return json::from_cbor(begin, end);
+    case json::input_format_t::msgpack:
+      return json::from_msgpack(begin, end);
+    case json::input_format_t::bson:
+      return json::from_bson(begin, end);
+    default:
+      return json::parse(begin, end);
+  }
+}
+}  // namespace
+
+void NlohmannParser::setLeaf(size_t leaf_index, double value)
+{
+  if (leaf_index >= _leaf_cache.size())
+  {
+    _leaf_cache.resize(leaf_index + 1);
+  }
+  auto& leaf = _leaf_cache[leaf_index];
+  if (leaf.name != _path)
+  {
+    leaf.name = _path;
+    leaf.series = nullptr;
+  }
+  leaf.value = value;
+}
+
+void NlohmannParser::flattenDocument(const nlohmann::json& value, size_t& leaf_count)
+{
+  const size_t length = _path.size();
+  if (value.is_object())
+  {
+    for (const auto& element : value.items())
+    {
+      _path.resize(length);
+      _path.push_back('/');
+      _path.append(element.key());
+      flattenDocument(element.value(), leaf_count);
+    }
+  }
+  else if (value.is_array())
+  {
+    for (size_t i = 0; i < value.size(); i++)
+    {
+      _path.resize(length);
+      _path.push_back('[');
+      _path.append(std::to_string(i));
+      _path.push_back(']');
+      flattenDocument(value[i], leaf_count);
     }
   }
+  else if (value.is_boolean())
+  {
+    setLeaf(leaf_count++, value.get<bool>() ? 1.0 : 0.0);
+  }
+  else if (value.is_number())
+  {
+    setLeaf(leaf_count++, value.get<double>());
+  }
+  _path.resize(length);
+}
+
+bool NlohmannParser::parseMessageImpl(const MessageRef msg, nlohmann::json::input_format_t format,
+                                      double& timestamp)
+{
+  _path = _topic_name;
+  _path_stack.clear();
+  _key_hashes.clear();
+
+  SaxFlattener flattener(*this);
+  nlohmann::json::sax_parse(msg.data(), msg.data() + msg.size(), &flattener, format);
+
+  bool stamp_found = flattener.stamp_found;
+  double stamp_value = flattener.stamp_value;
+  size_t leaf_count = flattener.leaf_count;
+
+  std::sort(_key_hashes.begin(), _key_hashes.end());
+  if (std::adjacent_find(_key_hashes.begin(), _key_hashes.end()) != _key_hashes.end())
+  {
+    // a key is repeated (or two hashes collide): only its last value must be used
+    const auto document = parseDocument(msg, format);
+    _path = _topic_name;
+    leaf_count = 0;
+    flattenDocument(document, leaf_count);
 
-  std::function<void(const std::string&, const nlohmann::json&)> flatten;
+    auto stamp_it = document.is_object() ? document.find(_stamp_fieldname) : document.end();
+    stamp_found = (stamp_it != document.end() && stamp_it->is_number());
+    stamp_value = stamp_found ? stamp_it->get<double>() : 0;
+  }
 
-  flatten = [&](const std::string& prefix, const nlohmann::json& value) {
-    if (value.empty())
+  if (_use_message_stamp && _stamp_fieldname.empty() == false)
+  {
+    if (stamp_found)
+    {
+      timestamp = stamp_value;
+    }
+    else
     {
-      return;
+      _use_message_stamp = false;
     }
+  }
 
-    switch (value.type())
+  for (size_t i = 0; i < leaf_count; i++)
+  {
+    auto& leaf = _leaf_cache[i];
+    if (!leaf.series)
     {
-      case nlohmann::detail::value_t::array: {
-        // iterate array and use index as reference string
-        for (std::size_t i = 0; i < value.size(); ++i)
-        {
-          flatten(fmt::format("{}[{}]", prefix, i), value[i]);
-        }
-        break;
-      }
-
-      case nlohmann::detail::value_t::object: {
-        // iterate object and use keys as reference string
-        for (const auto& element : value.items())
-        {
-          flatten(fmt::format("{}/{}", prefix, element.key()), element.value());
-        }
-        break;
-      }
-
-      default: {
-        double numeric_value = 0;
-        if (value.is_boolean())
-        {
-          numeric_value = value.get<bool>();
-        }
-        else if (value.is_number())
-        {
-          numeric_value = value.get<double>();
-        }
-        else
-        {
-          return;
-        }
-
-        auto plot_data = &(getSeries(prefix));
-        plot_data->pushBack({ timestamp, numeric_value });
-
-        break;
-      }
-    }  // end switch
-  };
-
-  flatten(_topic_name, _json);
+      leaf.series = &getSeries(leaf.name);
+    }
+    leaf.series->pushBack({ timestamp, leaf.value });
+  }
   return true;
 }
 
 bool MessagePack_Parser::parseMessage(const MessageRef msg, double& timestamp)
 {
-  _json = nlohmann::json::from_msgpack(msg.data(), msg.data() + msg.size());
-  return parseMessageImpl(timestamp);
+  return parseMessageImpl(msg, nlohmann::json::input_format_t::msgpack, timestamp);
 }
 
 bool JSON_Parser::parseMessage(const MessageRef msg, double& timestamp)
 {
-  _json = nlohmann::json::parse(msg.data(), msg.data() + msg.size());
-  return parseMessageImpl(timestamp);
+  return parseMessageImpl(msg, nlohmann::json::input_format_t::json, timestamp);
 }
 
 bool CBOR_Parser::parseMessage(const MessageRef msg, double& timestamp)
 {
-  _json = nlohmann::json::from_cbor(msg.data(), msg.data() + msg.size());
-  return parseMessageImpl(timestamp);
+  return parseMessageImpl(msg, nlohmann::json::input_format_t::cbor, timestamp);
 }
 
 bool BSON_Parser::parseMessage(const MessageRef msg, double& timestamp)
 {
-  _json = nlohmann::json::from_bson(msg.data(), msg.data() + msg.size());
-  return parseMessageImpl(timestamp);
+  return parseMessageImpl(msg, nlohmann::json::input_format_t::bson, timestamp);
 }
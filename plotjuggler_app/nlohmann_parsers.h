@@ -26,11 +26,46 @@ public:
   }
 
 protected:
-  bool parseMessageImpl(double& timestamp);
+  bool parseMessageImpl(const MessageRef msg, nlohmann::json::input_format_t format,
+                        double& timestamp);
+
+  // SAX handler that flattens the message while it is being decoded,
+  // without building a nlohmann::json DOM.
+  class SaxFlattener;
+
+  // Leaves are cached by their position in the message. Messages sharing
+  // the same shape resolve their series with a string comparison only.
+  struct LeafCache
+  {
+    std::string name;
+    PlotData* series = nullptr;
+    double value = 0;
+  };
+
+  // One entry per open object/array: length of the path up to it and,
+  // for arrays, the index of the next element (-1 for objects).
+  struct PathFrame
+  {
+    size_t length;
+    int64_t next_index;
+  };
+
+  // store the value of the leaf named _path. The series are resolved only once the
+  // whole message is parsed, not to create them for a malformed message
+  void setLeaf(size_t leaf_index, double value);
+
+  // Slow path, for the messages with duplicate keys: flatten a DOM, where the last
+  // value of a duplicate key replaces the previous ones.
+  void flattenDocument(const nlohmann::json& value, size_t& leaf_count);
 
-  nlohmann::json _json;
   bool _use_message_stamp;
   std::string _stamp_fieldname;
+
+  std::string _path;
+  std::vector<PathFrame> _path_stack;
+  std::vector<LeafCache> _leaf_cache;
+  // hash of the path of each key of the message, to detect the duplicates
+  std::vector<size_t> _key_hashes;
 };
 
 class JSON_Parser : public NlohmannParser
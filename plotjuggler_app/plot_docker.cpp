@@ -11,6 +11,7 @@
 #include <QPushButton>
 #include <QBoxLayout>
 #include <QMouseEvent>
+#include <QShowEvent>
 #include <QSplitter>
 #include <QDebug>
 #include <QInputDialog>
@@ -137,6 +138,37 @@ QDomElement PlotDocker::xmlSaveState(QDomDocument& doc) const
   return containers_elem;
 }
 
+void collectChildNodesPlots(QWidget* widget, std::vector<PlotWidget*>& plots)
+{
+  if (QSplitter* splitter = qobject_cast<QSplitter*>(widget))
+  {
+    for (int i = 0; i < splitter->count(); ++i)
+    {
+      collectChildNodesPlots(splitter->widget(i), plots);
+    }
+  }
+  else if (auto dockArea = qobject_cast<ads::CDockAreaWidget*>(widget))
+  {
+    for (int i = 0; i < dockArea->dockWidgetsCount(); ++i)
+    {
+      if (auto dock_widget = dynamic_cast<DockWidget*>(dockArea->dockWidget(i)))
+      {
+        plots.push_back(dock_widget->plotWidget());
+      }
+    }
+  }
+}
+
+std::vector<PlotWidget*> PlotDocker::plotsInLayoutOrder() const
+{
+  std::vector<PlotWidget*> plots;
+  for (CDockContainerWidget* container : dockContainers())
+  {
+    collectChildNodesPlots(container->rootSplitter(), plots);
+  }
+  return plots;
+}
+
 void PlotDocker::restoreSplitter(QDomElement elem, DockWidget* widget)
 {
   QString orientation_str = elem.attribute("orientation");
@@ -185,7 +217,7 @@ void PlotDocker::restoreSplitter(QDomElement elem, DockWidget* widget)
     if (child_elem.tagName() == "DockArea")
     {
       auto plot_elem = child_elem.firstChildElement("plot");
-      widgets[index]->plotWidget()->xmlLoadState(plot_elem);
+      widgets[index]->plotWidget()->setPendingState(plot_elem);
       if (child_elem.hasAttribute("name"))
       {
         QString area_name = child_elem.attribute("name");
@@ -233,6 +265,14 @@ bool PlotDocker::xmlLoadState(QDomElement& tab_element)
   return true;
 }
 
+void PlotDocker::loadPendingPlots()
+{
+  for (PlotWidget* plot : plotsInLayoutOrder())
+  {
+    plot->loadPendingState();
+  }
+}
+
 int PlotDocker::plotCount() const
 {
   return dockAreaCount();
@@ -265,6 +305,29 @@ void PlotDocker::replot()
   }
 }
 
+void PlotDocker::updateOutdatedPlots()
+{
+  std::unordered_set<PlotWidget*> updated_plots;
+  for (int index = 0; index < plotCount(); index++)
+  {
+    if (plotAt(index)->updateOutdatedCurves())
+    {
+      updated_plots.insert(plotAt(index));
+    }
+  }
+  if (!updated_plots.empty())
+  {
+    // zoomed by MainWindow, that knows if the horizontal axes are linked
+    emit outdatedPlotsUpdated(updated_plots);
+  }
+}
+
+void PlotDocker::showEvent(QShowEvent* event)
+{
+  ads::CDockManager::showEvent(event);
+  updateOutdatedPlots();
+}
+
 void PlotDocker::on_stylesheetChanged(QString theme)
 {
   for (int index = 0; index < plotCount(); index++)
@@ -7,6 +7,7 @@
 #ifndef PLOT_DOCKER_H
 #define PLOT_DOCKER_H
 
+#include <unordered_set>
 #include <QDomElement>
 #include <QXmlStreamReader>
 #include "PlotJuggler/plotdata.h"
@@ -59,24 +60,39 @@ public:
 
   QDomElement xmlSaveState(QDomDocument& doc) const;
 
+  /// The plots are created, but their curves are loaded by loadPendingPlots().
   bool xmlLoadState(QDomElement& tab_element);
 
+  /// Load the curves of the plots, if not done yet. Call it when the tab is shown.
+  void loadPendingPlots();
+
   int plotCount() const;
 
   PlotWidget* plotAt(int index);
 
+  /// The plots in the same order used by xmlSaveState(), that is preserved by xmlLoadState().
+  std::vector<PlotWidget*> plotsInLayoutOrder() const;
+
   void setHorizontalLink(bool enabled);
 
   void zoomOut();
 
   void replot();
 
+  /// Update the plots that were hidden while the data changed, see
+  /// PlotWidget::setCurvesOutdated(). Called when the tab is shown.
+  /// The updated plots are zoomed by the receiver of outdatedPlotsUpdated().
+  void updateOutdatedPlots();
+
 public slots:
 
   void on_stylesheetChanged(QString theme);
 
   void savePlotsToFile();
 
+protected:
+  void showEvent(QShowEvent* event) override;
+
 private:
   void restoreSplitter(QDomElement elem, DockWidget* widget);
 
@@ -91,6 +107,8 @@ signals:
   void plotWidgetAdded(PlotWidget*);
 
   void undoableChange();
+
+  void outdatedPlotsUpdated(const std::unordered_set<PlotWidget*>& plots);
 };
 
 #endif  // PLOT_DOCKER_H
@@ -22,6 +22,9 @@
 #include <QSettings>
 #include <QSvgGenerator>
 #include <QClipboard>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QtConcurrent>
 #include <iostream>
 #include <limits>
 #include <set>
@@ -50,6 +53,7 @@
 
 #include "PlotJuggler/save_plot.h"
 #include "PlotJuggler/svg_util.h"
+#include "PlotJuggler/profiler.h"
 #include "point_series_xy.h"
 #include "colormap_selector.h"
 
@@ -419,6 +423,19 @@ void PlotWidget::onDataSourceRemoved(const std::string& src_name)
 {
   bool deleted = false;
 
+  QDomElement pending_el = _pending_state.documentElement();
+  const QString name = QString::fromStdString(src_name);
+  for (auto curve_el = pending_el.firstChildElement("curve"); !curve_el.isNull();)
+  {
+    auto next_el = curve_el.nextSiblingElement("curve");
+    if (curve_el.attribute("name") == name || curve_el.attribute("curve_x") == name ||
+        curve_el.attribute("curve_y") == name)
+    {
+      pending_el.removeChild(curve_el);
+    }
+    curve_el = next_el;
+  }
+
   for (auto it = curveList().begin(); it != curveList().end();)
   {
     PointSeriesXY* curve_xy = dynamic_cast<PointSeriesXY*>(it->curve->data());
@@ -452,6 +469,7 @@ void PlotWidget::onDataSourceRemoved(const std::string& src_name)
 
 void PlotWidget::removeAllCurves()
 {
+  _pending_state.clear();
   PlotWidgetBase::removeAllCurves();
   setModeXY(false);
   _tracker->redraw();
@@ -627,6 +645,11 @@ void PlotWidget::on_panned(int, int)
 
 QDomElement PlotWidget::xmlSaveState(QDomDocument& doc) const
 {
+  if (!_pending_state.isNull())
+  {
+    return doc.importNode(_pending_state.documentElement(), true).toElement();
+  }
+
   QDomElement plot_el = doc.createElement("plot");
 
   QDomElement range_el = doc.createElement("range");
@@ -689,6 +712,7 @@ QDomElement PlotWidget::xmlSaveState(QDomDocument& doc) const
       {
         curve_el.setAttribute("curve_x", QString::fromStdString(xy->dataX()->plotName()));
         curve_el.setAttribute("curve_y", QString::fromStdString(xy->dataY()->plotName()));
+        curve_el.setAttribute("join", PointSeriesXY::joinModeName(xy->joinMode()));
       }
     }
     else
@@ -721,6 +745,7 @@ QDomElement PlotWidget::xmlSaveState(QDomDocument& doc) const
 
 bool PlotWidget::xmlLoadState(QDomElement& plot_widget, bool autozoom)
 {
+  _pending_state.clear();
   std::set<std::string> added_curve_names;
 
   QString mode = plot_widget.attribute("mode");
@@ -795,11 +820,26 @@ bool PlotWidget::xmlLoadState(QDomElement& plot_widget, bool autozoom)
         {
           ts->setTransform(transform_el.attribute("name"));
           ts->transform()->xmlLoadState(transform_el);
-          ts->updateCache(true);
+          if (!_background_updates)
+          {
+            ts->updateCache(true);
+          }
           auto alias = transform_el.attribute("alias");
           ts->setAlias(alias);
           curve->setTitle(alias);
         }
+        if (ts && _background_updates)
+        {
+          if (ts->canUpdateInBackground())
+          {
+            startBackgroundUpdate(ts);
+          }
+          else
+          {
+            // the transform may read its widgets, that live in this thread
+            ts->updateCache(true);
+          }
+        }
       }
     }
     //-----------------
@@ -819,6 +859,11 @@ bool PlotWidget::xmlLoadState(QDomElement& plot_widget, bool autozoom)
         {
           continue;
         }
+        auto xy = dynamic_cast<PointSeriesXY*>(curve_it->curve->data());
+        if (xy && curve_element.hasAttribute("join"))
+        {
+          xy->setJoinMode(PointSeriesXY::joinModeFromName(curve_element.attribute("join")));
+        }
         curve_it->curve->setPen(color, 1.3);
         curve_it->marker->setSymbol(
             new QwtSymbol(QwtSymbol::Ellipse, color, QPen(Qt::black), QSize(8, 8)));
@@ -1028,6 +1073,12 @@ void PlotWidget::configureTracker(CurveTracker::Parameter val)
   _tracker->setParameter(val);
 }
 
+void PlotWidget::updateTrackerSettings()
+{
+  _tracker->loadSettings();
+  _tracker->redraw();
+}
+
 void PlotWidget::enableTracker(bool enable)
 {
   _tracker->setEnabled(enable && !isXYPlot());
@@ -1139,6 +1190,8 @@ Range PlotWidget::getVisualizationRangeY(Range range_X) const
 
 void PlotWidget::updateCurves(bool reset_older_data)
 {
+  PJ_PROFILE_SCOPE("PlotWidget::updateCurves");
+  _curves_outdated = false;
   for (auto& it : curveList())
   {
     auto series = dynamic_cast<QwtSeriesWrapper*>(it.curve->data());
@@ -1149,6 +1202,16 @@ void PlotWidget::updateCurves(bool reset_older_data)
   updateStatistics(true);
 }
 
+bool PlotWidget::updateOutdatedCurves()
+{
+  if (!_curves_outdated)
+  {
+    return false;
+  }
+  updateCurves(false);
+  return true;
+}
+
 void PlotWidget::updateStatistics(bool forceUpdate)
 {
   if (_statistics_dialog)
@@ -1387,20 +1450,8 @@ void PlotWidget::on_savePlotToFile()
 
 void PlotWidget::plotOn(const PlotSaveHelper& plot_save_helper, QRect paint_at)
 {
-  bool tracker_enabled = _tracker->isEnabled();
-  if (tracker_enabled)
-  {
-    this->enableTracker(false);
-    replot();
-  }
-
+  // the tracker is drawn on an overlay of the canvas: it is not part of the image
   plot_save_helper.paint(qwtPlot(), paint_at);
-
-  if (tracker_enabled)
-  {
-    this->enableTracker(true);
-    replot();
-  }
 }
 
 void PlotWidget::setCustomAxisLimits(Range range)
@@ -1417,13 +1468,6 @@ Range PlotWidget::customAxisLimit() const
 
 void PlotWidget::on_copyToClipboard()
 {
-  bool tracker_enabled = _tracker->isEnabled();
-  if (tracker_enabled)
-  {
-    this->enableTracker(false);
-    replot();
-  }
-
   auto documentRect = qwtPlot()->canvas()->rect();
   qDebug() << documentRect;
 
@@ -1434,12 +1478,6 @@ void PlotWidget::on_copyToClipboard()
 
   QClipboard* clipboard = QGuiApplication::clipboard();
   clipboard->setPixmap(pixmap);
-
-  if (tracker_enabled)
-  {
-    this->enableTracker(true);
-    replot();
-  }
 }
 
 void PlotWidget::on_copyAction_triggered()
@@ -1650,9 +1688,12 @@ QwtSeriesWrapper* PlotWidget::createCurveXY(const PlotData* data_x, const PlotDa
 {
   PointSeriesXY* output = nullptr;
 
+  QSettings settings;
+  const auto join_mode = PointSeriesXY::joinModeFromName(
+      settings.value("Preferences::xy_join_mode", "nearest").toString());
   try
   {
-    output = new PointSeriesXY(data_x, data_y);
+    output = new PointSeriesXY(data_x, data_y, join_mode);
   }
   catch (std::runtime_error& ex)
   {
@@ -1678,6 +1719,87 @@ QwtSeriesWrapper* PlotWidget::createTimeSeries(const PlotData* data, const QStri
   TransformedTimeseries* output = new TransformedTimeseries(data);
   output->setTransform(transform_ID);
   output->setTimeOffset(_time_offset);
-  output->updateCache(true);
+  if (!_background_updates)
+  {
+    output->updateCache(true);
+  }
   return output;
 }
+
+namespace
+{
+// separated from the global pool, used by the data loaders, to wait only for these tasks
+QThreadPool* backgroundUpdatePool()
+{
+  static QThreadPool pool;
+  return &pool;
+}
+}  // namespace
+
+void PlotWidget::setPendingState(const QDomElement& element)
+{
+  removeAllCurves();
+  _pending_state = QDomDocument();
+  _pending_state.appendChild(_pending_state.importNode(element, true));
+}
+
+void PlotWidget::loadPendingState()
+{
+  if (_pending_state.isNull())
+  {
+    return;
+  }
+  // xmlLoadState() clears _pending_state: keep the document alive
+  QDomDocument state = _pending_state;
+  QDomElement element = state.documentElement();
+  _background_updates = true;
+  xmlLoadState(element);
+  _background_updates = false;
+  replot();
+}
+
+std::vector<std::string> PlotWidget::pendingCurveNames() const
+{
+  std::vector<std::string> names;
+  const QDomElement plot_el = _pending_state.documentElement();
+  for (auto curve_el = plot_el.firstChildElement("curve"); !curve_el.isNull();
+       curve_el = curve_el.nextSiblingElement("curve"))
+  {
+    if (curve_el.hasAttribute("curve_x"))
+    {
+      names.push_back(curve_el.attribute("curve_x").toStdString());
+      names.push_back(curve_el.attribute("curve_y").toStdString());
+    }
+    else
+    {
+      names.push_back(curve_el.attribute("name").toStdString());
+    }
+  }
+  return names;
+}
+
+void PlotWidget::waitForBackgroundUpdates()
+{
+  backgroundUpdatePool()->waitForDone();
+}
+
+void PlotWidget::startBackgroundUpdate(TransformedTimeseries* series)
+{
+  auto job = series->startBackgroundUpdate();
+  auto watcher = new QFutureWatcher<void>(this);
+  connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, series]() {
+    watcher->deleteLater();
+    // the curve may have been removed in the meantime
+    for (auto& it : curveList())
+    {
+      if (it.curve->data() == series)
+      {
+        series->finishBackgroundUpdate();
+        updateMaximumZoomArea();
+        replot();
+        break;
+      }
+    }
+  });
+  watcher->setFuture(QtConcurrent::run(backgroundUpdatePool(), job));
+}
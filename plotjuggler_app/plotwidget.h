@@ -35,6 +35,7 @@
 #include "plot_background.h"
 
 class StatisticsDialog;
+class TransformedTimeseries;
 
 class PlotWidget : public PlotWidgetBase
 {
@@ -51,6 +52,44 @@ public:
 
   bool xmlLoadState(QDomElement& element, bool autozoom = true);
 
+  /**
+   * Keep the state "element" (as returned by xmlSaveState()) and load it only when
+   * loadPendingState() is called, i.e. when the plot is shown for the first time.
+   * Until then the plot is empty and xmlSaveState() returns "element".
+   */
+  void setPendingState(const QDomElement& element);
+
+  bool hasPendingState() const
+  {
+    return !_pending_state.isNull();
+  }
+
+  /// Load the state passed to setPendingState(), if any. The caches of the curves
+  /// are computed by background threads: each curve is empty until its cache is ready.
+  void loadPendingState();
+
+  /// Names of the curves of the state passed to setPendingState().
+  std::vector<std::string> pendingCurveNames() const;
+
+  /// Wait for the caches computed by the background threads.
+  /// They read the data, which must not be modified in the meantime.
+  static void waitForBackgroundUpdates();
+
+  /// Used when the plot is hidden, instead of updateCurves(false).
+  void setCurvesOutdated()
+  {
+    _curves_outdated = true;
+  }
+
+  bool curvesOutdated() const
+  {
+    return _curves_outdated;
+  }
+
+  /// Update the curves, if setCurvesOutdated() was called since the last update.
+  /// Return false if they were up to date already.
+  bool updateOutdatedCurves();
+
   Range getVisualizationRangeY(Range range_X) const override;
 
   void setZoomRectangle(QRectF rect, bool emit_signal);
@@ -125,6 +164,9 @@ public slots:
 
   void configureTracker(CurveTracker::Parameter val);
 
+  /// Read again the preferences used by the tracker.
+  void updateTrackerSettings();
+
   void enableTracker(bool enable);
 
   bool isTrackerEnabled() const;
@@ -195,6 +237,15 @@ private:
 
   StatisticsDialog* _statistics_dialog = nullptr;
 
+  QDomDocument _pending_state;
+
+  // if true, the caches of the curves loaded by xmlLoadState() are computed in background
+  bool _background_updates = false;
+
+  bool _curves_outdated = false;
+
+  void startBackgroundUpdate(TransformedTimeseries* series);
+
   struct DragInfo
   {
     enum
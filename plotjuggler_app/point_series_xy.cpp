@@ -5,11 +5,18 @@
  */
 
 #include "point_series_xy.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <limits>
 
-PointSeriesXY::PointSeriesXY(const PlotData* x_axis, const PlotData* y_axis)
-  : QwtTimeseries(nullptr), _x_axis(x_axis), _y_axis(y_axis), _cached_curve("", x_axis->group())
+PointSeriesXY::PointSeriesXY(const PlotData* x_axis, const PlotData* y_axis,
+                             JoinMode join_mode)
+  : QwtTimeseries(nullptr)
+  , _x_axis(x_axis)
+  , _y_axis(y_axis)
+  , _cached_curve("", x_axis->group())
+  , _join_mode(join_mode)
 {
   updateCache(true);
 }
@@ -21,17 +28,23 @@ size_t PointSeriesXY::size() const
 
 std::optional<QPointF> PointSeriesXY::sampleFromTime(double t)
 {
-  if (_cached_curve.size() == 0)
+  if (_cached_time.empty())
   {
     return {};
   }
 
-  int index = _y_axis->getIndexFromX(t);
-  if (index < 0)
+  // closest point in time, as PlotData::getIndexFromX()
+  auto lower = std::lower_bound(_cached_time.begin(), _cached_time.end(), t);
+  size_t index = size_t(lower - _cached_time.begin());
+  if (lower == _cached_time.end())
   {
-    return {};
+    index--;
+  }
+  else if (index > 0 && (t - _cached_time[index - 1]) < (*lower - t))
+  {
+    index--;
   }
-  const auto& p = _cached_curve.at(size_t(index));
+  const auto& p = _cached_curve.at(index);
   return QPointF(p.x, p.y);
 }
 
@@ -40,33 +53,148 @@ RangeOpt PointSeriesXY::getVisualizationRangeY(Range)
   return _cached_curve.rangeY();
 }
 
-void PointSeriesXY::updateCache(bool reset_old_data)
+void PointSeriesXY::clearCache()
 {
   _cached_curve.clear();
+  _cached_time.clear();
+  _merge_started = false;
+  _merged_count_x = 0;
+  _merged_count_y = 0;
+}
 
+double PointSeriesXY::valueAt(const PlotData& series, size_t next, double time) const
+{
+  const auto& p0 = series[next - 1];
+  // exact hit: "next" may be past the end, when the series ends at "time"
+  if (time <= p0.x || next >= series.size())
+  {
+    return p0.y;
+  }
+  const auto& p1 = series[next];
+  switch (_join_mode)
+  {
+    case JoinMode::HOLD_LAST:
+      return p0.y;
+    case JoinMode::LINEAR:
+      return p0.y + (p1.y - p0.y) * (time - p0.x) / (p1.x - p0.x);
+    case JoinMode::NEAREST:
+    default:
+      return ((time - p0.x) <= (p1.x - time)) ? p0.y : p1.y;
+  }
+}
+
+void PointSeriesXY::updateCache(bool reset_old_data)
+{
   if (_x_axis == nullptr)
   {
     throw std::runtime_error("the X axis is null");
   }
 
-  const size_t data_size = std::min(_x_axis->size(), _y_axis->size());
+  if (reset_old_data)
+  {
+    clearCache();
+  }
+
+  const PlotData& data_x = *_x_axis;
+  const PlotData& data_y = *_y_axis;
+  const size_t size_x = data_x.size();
+  const size_t size_y = data_y.size();
 
-  if (data_size == 0)
+  if (size_x == 0 || size_y == 0)
   {
+    clearCache();
     return;
   }
 
-  const double EPS = std::numeric_limits<double>::epsilon();
+  // a time can be joined only if both series have samples before and after it
+  const double start_time = std::max(data_x.front().x, data_y.front().x);
+  const double end_time = std::min(data_x.back().x, data_y.back().x);
+
+  if (_merge_started && _merged_until > end_time)
+  {
+    // samples merged already were removed from the back: the data was replaced
+    clearCache();
+  }
+
+  // drop the points of the samples removed from the front (streaming buffer)
+  auto first_kept = std::lower_bound(_cached_time.begin(), _cached_time.end(), start_time);
+  const size_t removed = size_t(first_kept - _cached_time.begin());
+  if (removed > 0)
+  {
+    _cached_curve.eraseFront(removed);
+    _cached_time.erase(_cached_time.begin(), first_kept);
+  }
+
+  // the merge cursor: first sample of each series that was not merged yet. The samples
+  // at _merged_until are counted rather than skipped, because more of them may have
+  // been received since; the index alone would be shifted by the samples removed
+  // from the front.
+  auto firstNotMerged = [this](const PlotData& series, size_t merged_count) -> size_t {
+    if (!_merge_started)
+    {
+      return 0;
+    }
+    auto it = std::lower_bound(series.begin(), series.end(), _merged_until,
+                               [](const PlotData::Point& p, double t) { return p.x < t; });
+    return std::min(size_t(it - series.begin()) + merged_count, series.size());
+  };
+  size_t ix = firstNotMerged(data_x, _merged_count_x);
+  size_t iy = firstNotMerged(data_y, _merged_count_y);
 
-  for (size_t i = 0; i < data_size; i++)
+  constexpr double INF = std::numeric_limits<double>::infinity();
+
+  while (ix < size_x || iy < size_y)
   {
-    if (std::abs(_x_axis->at(i).x - _y_axis->at(i).x) > EPS)
+    const double time_x = (ix < size_x) ? data_x[ix].x : INF;
+    const double time_y = (iy < size_y) ? data_y[iy].x : INF;
+    const double time = std::min(time_x, time_y);
+    if (time > end_time)
+    {
+      break;
+    }
+    // before the first sample of the other series, there is nothing to join
+    const bool joined = (time >= start_time);
+
+    if (!_merge_started || time != _merged_until)
+    {
+      _merged_until = time;
+      _merged_count_x = 0;
+      _merged_count_y = 0;
+    }
+    _merge_started = true;
+
+    double x = 0;
+    double y = 0;
+    if (time_x == time_y)
+    {
+      x = data_x[ix++].y;
+      y = data_y[iy++].y;
+      _merged_count_x++;
+      _merged_count_y++;
+    }
+    else if (time_x < time_y)
+    {
+      x = data_x[ix++].y;
+      y = joined ? valueAt(data_y, iy, time) : 0.0;
+      _merged_count_x++;
+    }
+    else
     {
-      throw std::runtime_error("X and Y axis don't share the same time axis");
+      y = data_y[iy++].y;
+      x = joined ? valueAt(data_x, ix, time) : 0.0;
+      _merged_count_y++;
     }
 
-    const QPointF p(_x_axis->at(i).y, _y_axis->at(i).y);
-    _cached_curve.pushBack({ p.x(), p.y() });
+    const size_t prev_size = _cached_curve.size();
+    if (joined)
+    {
+      _cached_curve.pushBack({ x, y });
+    }
+    // NaN and infinite points are skipped by pushBack()
+    if (_cached_curve.size() > prev_size)
+    {
+      _cached_time.push_back(time);
+    }
   }
 }
 
@@ -74,3 +202,39 @@ RangeOpt PointSeriesXY::getVisualizationRangeX()
 {
   return _cached_curve.rangeX();
 }
+
+void PointSeriesXY::setJoinMode(JoinMode mode)
+{
+  if (mode != _join_mode)
+  {
+    _join_mode = mode;
+    updateCache(true);
+  }
+}
+
+QString PointSeriesXY::joinModeName(JoinMode mode)
+{
+  switch (mode)
+  {
+    case JoinMode::HOLD_LAST:
+      return "hold_last";
+    case JoinMode::LINEAR:
+      return "linear";
+    case JoinMode::NEAREST:
+    default:
+      return "nearest";
+  }
+}
+
+PointSeriesXY::JoinMode PointSeriesXY::joinModeFromName(const QString& name)
+{
+  if (name == "hold_last")
+  {
+    return JoinMode::HOLD_LAST;
+  }
+  if (name == "linear")
+  {
+    return JoinMode::LINEAR;
+  }
+  return JoinMode::NEAREST;
+}
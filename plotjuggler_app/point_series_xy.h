@@ -7,12 +7,36 @@
 #ifndef POINT_SERIES_H
 #define POINT_SERIES_H
 
+#include <deque>
+#include <QString>
 #include "timeseries_qwt.h"
 
+/**
+ * XY curve of two time series, joined by time.
+ *
+ * The samples of X and Y are merged in time order: each of them is a point of the curve,
+ * and the value of the other series at that time is obtained with the JoinMode.
+ * When X and Y share their timestamps, the points are the pairs (X[i], Y[i]).
+ *
+ * A time is joined only when both series have a sample at or after it; the merge
+ * continues from that time at the next updateCache(), therefore only the new samples
+ * are processed while streaming.
+ */
 class PointSeriesXY : public QwtTimeseries
 {
 public:
-  PointSeriesXY(const PlotData* x_axis, const PlotData* y_axis);
+  enum class JoinMode
+  {
+    // the sample of the other series closest in time
+    NEAREST,
+    // the last sample of the other series, at or before the time
+    HOLD_LAST,
+    // linear interpolation of the two samples of the other series around the time
+    LINEAR
+  };
+
+  PointSeriesXY(const PlotData* x_axis, const PlotData* y_axis,
+                JoinMode join_mode = JoinMode::NEAREST);
 
   virtual QPointF sample(size_t i) const override
   {
@@ -44,10 +68,43 @@ public:
     return &_cached_curve;
   }
 
+  uint64_t rewriteCount() const override
+  {
+    return _cached_curve.rewriteCount();
+  }
+
+  JoinMode joinMode() const
+  {
+    return _join_mode;
+  }
+
+  /// Rebuild the curve, if the mode changed.
+  void setJoinMode(JoinMode mode);
+
+  /// Names used in the layout files and in the preferences.
+  static QString joinModeName(JoinMode mode);
+
+  static JoinMode joinModeFromName(const QString& name);
+
 protected:
   const PlotData* _x_axis;
   const PlotData* _y_axis;
   PlotDataXY _cached_curve;
+
+  JoinMode _join_mode;
+  // time of each point of _cached_curve
+  std::deque<double> _cached_time;
+  // the samples up to this time (included) were merged already
+  double _merged_until;
+  bool _merge_started = false;
+  // number of samples of each series at _merged_until merged already
+  size_t _merged_count_x = 0;
+  size_t _merged_count_y = 0;
+
+  void clearCache();
+
+  // value of "series" at "time". "next" is the first sample after "time"
+  double valueAt(const PlotData& series, size_t next, double time) const;
 };
 
 #endif  // POINT_SERIES_H
@@ -11,6 +11,7 @@
 #include <QFileDialog>
 #include "PlotJuggler/save_plot.h"
 #include "PlotJuggler/svg_util.h"
+#include "datafile_cache.h"
 
 PreferencesDialog::PreferencesDialog(QWidget* parent)
   : QDialog(parent), ui(new Ui::PreferencesDialog)
@@ -62,6 +63,21 @@ PreferencesDialog::PreferencesDialog(QWidget* parent)
   bool truncation_check = settings.value("Preferences::truncation_check", true).toBool();
   ui->checkBoxTruncation->setChecked(truncation_check);
 
+  bool data_cache_enabled = settings.value("Preferences::data_cache_enabled", false).toBool();
+  ui->checkBoxDataCache->setChecked(data_cache_enabled);
+  ui->spinBoxDataCacheSize->setValue(
+      settings.value("Preferences::data_cache_max_size", 4096).toInt());
+
+  ui->spinBoxStreamingCpuBudget->setValue(
+      settings.value("Preferences::streaming_cpu_budget", 25).toInt());
+  ui->checkBoxStreamingFps->setChecked(
+      settings.value("Preferences::streaming_show_fps", true).toBool());
+
+  const QStringList join_modes = { "nearest", "hold_last", "linear" };
+  int join_index =
+      join_modes.indexOf(settings.value("Preferences::xy_join_mode", "nearest").toString());
+  ui->comboBoxXYJoin->setCurrentIndex(std::max(0, join_index));
+
   QSize export_plot =
       settings.value("Preferences::export_plot_size", default_document_dimentions).toSize();
   ui->spinBoxExportX->setValue(export_plot.width());
@@ -111,6 +127,12 @@ void PreferencesDialog::on_buttonBox_accepted()
   settings.setValue("Preferences::autozoom_filter_applied",
                     ui->checkBoxAutoZoomFilter->isChecked());
   settings.setValue("Preferences::truncation_check", ui->checkBoxTruncation->isChecked());
+  settings.setValue("Preferences::data_cache_enabled", ui->checkBoxDataCache->isChecked());
+  settings.setValue("Preferences::data_cache_max_size", ui->spinBoxDataCacheSize->value());
+  settings.setValue("Preferences::streaming_cpu_budget", ui->spinBoxStreamingCpuBudget->value());
+  settings.setValue("Preferences::streaming_show_fps", ui->checkBoxStreamingFps->isChecked());
+  const QStringList join_modes = { "nearest", "hold_last", "linear" };
+  settings.setValue("Preferences::xy_join_mode", join_modes[ui->comboBoxXYJoin->currentIndex()]);
   settings.setValue("Preferences::export_plot_size",
                     QSize{ ui->spinBoxExportX->value(), ui->spinBoxExportY->value() });
 
@@ -148,3 +170,8 @@ void PreferencesDialog::on_listWidgetCustom_itemSelectionChanged()
 {
   ui->pushButtonRemove->setEnabled(!ui->listWidgetCustom->selectedItems().isEmpty());
 }
+
+void PreferencesDialog::on_pushButtonClearDataCache_clicked()
+{
+  DataFileCache().clear();
+}
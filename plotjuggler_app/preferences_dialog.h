@@ -31,6 +31,8 @@ private slots:
 
   void on_listWidgetCustom_itemSelectionChanged();
 
+  void on_pushButtonClearDataCache_clicked();
+
 private:
   Ui::PreferencesDialog* ui;
 };
@@ -0,0 +1,215 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "profiler_panel.h"
+#include <array>
+#include <sstream>
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSettings>
+#include <QVBoxLayout>
+#include "PlotJuggler/profiler.h"
+
+namespace
+{
+enum Column
+{
+  NAME = 0,
+  CALLS,
+  CALLS_PER_SEC,
+  ITEMS,
+  MEAN,
+  P50,
+  P95,
+  P99,
+  MAX,
+  TOTAL,
+  COLUMN_COUNT
+};
+}  // namespace
+
+ProfilerPanel::ProfilerPanel(QWidget* parent) : QDockWidget(tr("Profiler"), parent)
+{
+  setObjectName("ProfilerPanel");
+
+  auto widget = new QWidget(this);
+  auto main_layout = new QVBoxLayout(widget);
+  auto buttons_layout = new QHBoxLayout();
+
+  _check_measure = new QCheckBox(tr("Measure"), widget);
+  _check_measure->setToolTip(tr("Measure the time spent in the main operations"));
+  _check_trace = new QCheckBox(tr("Record trace"), widget);
+  _check_trace->setToolTip(tr("Record every measurement, to export them as a trace"));
+  _label_trace = new QLabel(widget);
+  auto button_reset = new QPushButton(tr("Reset"), widget);
+  auto button_export = new QPushButton(tr("Export trace..."), widget);
+  button_export->setToolTip(tr("Save the trace in the Chrome trace event format (JSON), "
+                               "that can be opened by chrome://tracing or ui.perfetto.dev"));
+
+  buttons_layout->addWidget(_check_measure);
+  buttons_layout->addWidget(_check_trace);
+  buttons_layout->addWidget(_label_trace);
+  buttons_layout->addStretch(1);
+  buttons_layout->addWidget(button_reset);
+  buttons_layout->addWidget(button_export);
+
+  _table = new QTableWidget(0, COLUMN_COUNT, widget);
+  _table->setHorizontalHeaderLabels({ tr("Scope"), tr("Calls"), tr("Calls/s"), tr("Items"),
+                                      tr("Mean (ms)"), tr("p50 (ms)"), tr("p95 (ms)"),
+                                      tr("p99 (ms)"), tr("Max (ms)"), tr("Total (ms)") });
+  _table->horizontalHeaderItem(MEAN)->setToolTip(tr("Statistics of the last %1 calls")
+                                                     .arg(PJ::Profiler::WINDOW));
+  _table->horizontalHeader()->setSectionResizeMode(NAME, QHeaderView::Stretch);
+  _table->verticalHeader()->setVisible(false);
+  _table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  _table->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+  main_layout->addLayout(buttons_layout);
+  main_layout->addWidget(_table);
+  setWidget(widget);
+
+  connect(_check_measure, &QCheckBox::toggled, this, [this](bool checked) {
+    PJ::Profiler::instance().setEnabled(checked);
+    _check_trace->setEnabled(checked);
+    if (!checked)
+    {
+      _check_trace->setChecked(false);
+    }
+  });
+  connect(_check_trace, &QCheckBox::toggled, this,
+          [](bool checked) { PJ::Profiler::instance().setTracing(checked); });
+  connect(button_reset, &QPushButton::clicked, this, &ProfilerPanel::onResetClicked);
+  connect(button_export, &QPushButton::clicked, this, &ProfilerPanel::onExportClicked);
+
+  _check_trace->setEnabled(false);
+  _timer.setInterval(1000);
+  connect(&_timer, &QTimer::timeout, this, &ProfilerPanel::refresh);
+}
+
+void ProfilerPanel::showEvent(QShowEvent* event)
+{
+  QDockWidget::showEvent(event);
+  _check_measure->setChecked(true);
+  _elapsed.start();
+  _timer.start();
+  refresh();
+}
+
+void ProfilerPanel::hideEvent(QHideEvent* event)
+{
+  QDockWidget::hideEvent(event);
+  _timer.stop();
+  _check_measure->setChecked(false);
+}
+
+void ProfilerPanel::refresh()
+{
+  const auto& profiler = PJ::Profiler::instance();
+  const auto statistics = profiler.statistics();
+
+  // the tracing stops by itself when the buffer is full
+  if (_check_trace->isChecked() && !profiler.isTracing())
+  {
+    _check_trace->blockSignals(true);
+    _check_trace->setChecked(false);
+    _check_trace->blockSignals(false);
+  }
+  const size_t events = profiler.traceEventCount();
+  _label_trace->setText(events > 0 ? tr("%1 events").arg(events) : QString());
+
+  const double elapsed_sec = double(_elapsed.restart()) * 1e-3;
+
+  auto number = [](double value) { return QString::number(value, 'f', 3); };
+
+  _table->setSortingEnabled(false);
+  _table->setRowCount(int(statistics.size()));
+  std::map<std::string, uint64_t> calls;
+  for (int row = 0; row < int(statistics.size()); row++)
+  {
+    const auto& stat = statistics[row];
+    calls[stat.name] = stat.calls;
+
+    double calls_per_sec = 0;
+    auto prev_it = _previous_calls.find(stat.name);
+    if (prev_it != _previous_calls.end() && elapsed_sec > 0 && stat.calls >= prev_it->second)
+    {
+      calls_per_sec = double(stat.calls - prev_it->second) / elapsed_sec;
+    }
+
+    std::array<QString, COLUMN_COUNT> values;
+    values[NAME] = QString::fromStdString(stat.name);
+    values[CALLS] = QString::number(stat.calls);
+    values[CALLS_PER_SEC] = QString::number(calls_per_sec, 'f', 1);
+    values[ITEMS] = (stat.items > 0) ? QString::number(stat.items) : QString();
+    values[MEAN] = number(stat.mean_ms);
+    values[P50] = number(stat.p50_ms);
+    values[P95] = number(stat.p95_ms);
+    values[P99] = number(stat.p99_ms);
+    values[MAX] = number(stat.max_ms);
+    values[TOTAL] = number(stat.total_ms);
+
+    for (int col = 0; col < COLUMN_COUNT; col++)
+    {
+      auto item = _table->item(row, col);
+      if (!item)
+      {
+        item = new QTableWidgetItem();
+        _table->setItem(row, col, item);
+      }
+      item->setText(values[col]);
+      if (col != NAME)
+      {
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      }
+    }
+  }
+  _previous_calls = std::move(calls);
+}
+
+void ProfilerPanel::onResetClicked()
+{
+  PJ::Profiler::instance().reset();
+  _previous_calls.clear();
+  _elapsed.restart();
+  refresh();
+}
+
+void ProfilerPanel::onExportClicked()
+{
+  QSettings settings;
+  QString directory_path =
+      settings.value("ProfilerPanel.lastDirectory", QDir::currentPath()).toString();
+
+  QString file_name = QFileDialog::getSaveFileName(this, tr("Export trace"), directory_path,
+                                                   tr("Chrome trace (*.json)"));
+  if (file_name.isEmpty())
+  {
+    return;
+  }
+  if (!file_name.endsWith(".json"))
+  {
+    file_name += ".json";
+  }
+  settings.setValue("ProfilerPanel.lastDirectory", QFileInfo(file_name).absolutePath());
+
+  std::ostringstream trace;
+  PJ::Profiler::instance().writeChromeTrace(trace);
+  const std::string content = trace.str();
+
+  QFile file(file_name);
+  if (!file.open(QIODevice::WriteOnly) ||
+      file.write(content.data(), qint64(content.size())) != qint64(content.size()))
+  {
+    QMessageBox::warning(this, tr("Export trace"),
+                         tr("Failed to write the file %1").arg(file_name));
+  }
+}
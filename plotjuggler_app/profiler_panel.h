@@ -0,0 +1,53 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef PROFILER_PANEL_H
+#define PROFILER_PANEL_H
+
+#include <map>
+#include <QCheckBox>
+#include <QDockWidget>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QTableWidget>
+#include <QTimer>
+
+/**
+ * Statistics of the scopes measured by PJ::Profiler, refreshed every second.
+ * The profiler is enabled while the panel is visible, unless "Measure" is unchecked.
+ */
+class ProfilerPanel : public QDockWidget
+{
+  Q_OBJECT
+
+public:
+  explicit ProfilerPanel(QWidget* parent = nullptr);
+
+protected:
+  void showEvent(QShowEvent* event) override;
+
+  void hideEvent(QHideEvent* event) override;
+
+private slots:
+  void refresh();
+
+  void onResetClicked();
+
+  void onExportClicked();
+
+private:
+  QCheckBox* _check_measure;
+  QCheckBox* _check_trace;
+  QLabel* _label_trace;
+  QTableWidget* _table;
+  QTimer _timer;
+
+  // to compute the calls per second
+  QElapsedTimer _elapsed;
+  std::map<std::string, uint64_t> _previous_calls;
+};
+
+#endif  // PROFILER_PANEL_H
@@ -0,0 +1,542 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "series_summary_index.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// QPointF::operator== is fuzzy
+bool samePoint(const QPointF& a, const QPointF& b)
+{
+  return a.x() == b.x() && a.y() == b.y();
+}
+
+// first index with X >= x
+size_t lowerBound(const QwtSeriesData<QPointF>& series, double x)
+{
+  size_t first = 0;
+  size_t count = series.size();
+  while (count > 0)
+  {
+    const size_t step = count / 2;
+    if (series.sample(first + step).x() < x)
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+    {
+      count = step;
+    }
+  }
+  return first;
+}
+
+// first index with X > x
+size_t upperBound(const QwtSeriesData<QPointF>& series, double x)
+{
+  size_t first = 0;
+  size_t count = series.size();
+  while (count > 0)
+  {
+    const size_t step = count / 2;
+    if (series.sample(first + step).x() <= x)
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+    {
+      count = step;
+    }
+  }
+  return first;
+}
+
+// same interpolation of TDigest::quantile() when all the centroids are single values
+double sortedQuantile(const std::vector<double>& sorted, double q)
+{
+  const double pos = q * double(sorted.size()) - 0.5;
+  if (pos <= 0)
+  {
+    return sorted.front();
+  }
+  if (pos >= double(sorted.size() - 1))
+  {
+    return sorted.back();
+  }
+  const size_t index = size_t(pos);
+  const double ratio = pos - double(index);
+  return sorted[index] + ratio * (sorted[index + 1] - sorted[index]);
+}
+}  // namespace
+
+void TDigest::add(double value, double weight)
+{
+  _buffer.push_back({ value, weight });
+  _buffer_weight += weight;
+  _min = std::min(_min, value);
+  _max = std::max(_max, value);
+  if (_buffer.size() > size_t(_compression * 10))
+  {
+    compress();
+  }
+}
+
+void TDigest::merge(const TDigest& other)
+{
+  _buffer.insert(_buffer.end(), other._centroids.begin(), other._centroids.end());
+  _buffer.insert(_buffer.end(), other._buffer.begin(), other._buffer.end());
+  _buffer_weight += other.totalWeight();
+  _min = std::min(_min, other._min);
+  _max = std::max(_max, other._max);
+  if (_buffer.size() > size_t(_compression * 10))
+  {
+    compress();
+  }
+}
+
+void TDigest::compress()
+{
+  if (_buffer.empty())
+  {
+    return;
+  }
+  _buffer.insert(_buffer.end(), _centroids.begin(), _centroids.end());
+  std::sort(_buffer.begin(), _buffer.end(),
+            [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+
+  const double total = _total_weight + _buffer_weight;
+
+  // maximum quantile of a centroid that starts at quantile "q", i.e. k(q_max) = k(q) + 1
+  // with the scale function k(q) = compression / (2 * PI) * asin(2 * q - 1)
+  auto max_quantile = [this](double q) {
+    const double k = _compression / (2.0 * M_PI) * std::asin(2.0 * q - 1.0) + 1.0;
+    if (k >= _compression / 4.0)
+    {
+      return 1.0;
+    }
+    return (std::sin(k * 2.0 * M_PI / _compression) + 1.0) / 2.0;
+  };
+
+  _centroids.clear();
+  Centroid current = _buffer.front();
+  double weight_so_far = 0;
+  double weight_limit = total * max_quantile(0);
+
+  for (size_t i = 1; i < _buffer.size(); i++)
+  {
+    const Centroid& next = _buffer[i];
+    if (weight_so_far + current.weight + next.weight <= weight_limit)
+    {
+      current.weight += next.weight;
+      current.mean += (next.mean - current.mean) * next.weight / current.weight;
+    }
+    else
+    {
+      weight_so_far += current.weight;
+      _centroids.push_back(current);
+      weight_limit = total * max_quantile(weight_so_far / total);
+      current = next;
+    }
+  }
+  _centroids.push_back(current);
+
+  _buffer.clear();
+  _total_weight = total;
+  _buffer_weight = 0;
+}
+
+double TDigest::quantile(double q)
+{
+  compress();
+  if (_centroids.empty())
+  {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  // each centroid is placed at the center of its weight. Interpolate linearly between
+  // them, and with the minimum and maximum at the ends.
+  const double target = std::clamp(q, 0.0, 1.0) * _total_weight;
+  double prev_position = 0;
+  double prev_value = _min;
+  double cumulative = 0;
+
+  auto interpolate = [&](double position, double value) {
+    if (position <= prev_position)
+    {
+      return value;
+    }
+    const double ratio = (target - prev_position) / (position - prev_position);
+    return prev_value + ratio * (value - prev_value);
+  };
+
+  for (const auto& centroid : _centroids)
+  {
+    const double position = cumulative + centroid.weight / 2;
+    if (target < position)
+    {
+      return interpolate(position, centroid.mean);
+    }
+    prev_position = position;
+    prev_value = centroid.mean;
+    cumulative += centroid.weight;
+  }
+  return interpolate(_total_weight, _max);
+}
+
+//---------------------------------------------------------
+
+void SeriesSummaryIndex::Summary::add(double value)
+{
+  if (count == 0)
+  {
+    min = value;
+    max = value;
+  }
+  else
+  {
+    min = std::min(min, value);
+    max = std::max(max, value);
+  }
+  count++;
+  const double delta = value - mean;
+  mean += delta / double(count);
+  m2 += delta * (value - mean);
+}
+
+void SeriesSummaryIndex::Summary::merge(const Summary& other)
+{
+  if (other.count == 0)
+  {
+    return;
+  }
+  if (count == 0)
+  {
+    *this = other;
+    return;
+  }
+  const double total = double(count + other.count);
+  const double delta = other.mean - mean;
+  mean += delta * double(other.count) / total;
+  m2 += other.m2 + delta * delta * double(count) * double(other.count) / total;
+  min = std::min(min, other.min);
+  max = std::max(max, other.max);
+  count += other.count;
+}
+
+void SeriesSummaryIndex::clear()
+{
+  _levels.clear();
+  _block_front.clear();
+  _begin = 0;
+  _end = 0;
+}
+
+void SeriesSummaryIndex::sync(const QwtSeriesData<QPointF>& series, uint64_t rewrite_count)
+{
+  const size_t size = series.size();
+  const bool rewritten = (&series != _series || rewrite_count != _rewrite_count);
+  _series = &series;
+  _rewrite_count = rewrite_count;
+  if (size == 0)
+  {
+    clear();
+    return;
+  }
+  size_t begin = 0;
+  if (_end == 0 || rewritten || !findBegin(series, begin))
+  {
+    clear();
+    append(series, size);
+    return;
+  }
+  if (begin > _begin)
+  {
+    removeFront(series, begin);
+  }
+  if (begin + size > _end)
+  {
+    append(series, begin + size);
+  }
+}
+
+SeriesSummaryIndex::Statistics SeriesSummaryIndex::query(const QwtSeriesData<QPointF>& series,
+                                                         double min_x, double max_x) const
+{
+  Statistics stat;
+  const size_t first_index = lowerBound(series, min_x);
+  const size_t last_index = upperBound(series, max_x);
+  if (first_index >= last_index || _end == 0)
+  {
+    return stat;
+  }
+
+  Summary summary;
+  TDigest digest;
+  std::vector<double> values;
+  bool has_nodes = false;
+
+  auto add_samples = [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++)
+    {
+      const double y = series.sample(i - _begin).y();
+      summary.add(y);
+      values.push_back(y);
+    }
+  };
+
+  auto add_node = [&](size_t level, size_t id) {
+    const Node& node = _levels[level][id - firstId(level)];
+    summary.merge(node.summary);
+    digest.merge(node.digest);
+    has_nodes = true;
+  };
+
+  const size_t first = _begin + first_index;
+  const size_t last = _begin + last_index;
+  // complete blocks in the range
+  size_t first_id = (first + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  size_t last_id = last / BLOCK_SIZE;
+
+  if (first_id >= last_id)
+  {
+    add_samples(first, last);
+  }
+  else
+  {
+    add_samples(first, first_id * BLOCK_SIZE);
+    add_samples(last_id * BLOCK_SIZE, last);
+
+    for (size_t level = 0; first_id < last_id; level++)
+    {
+      if (level + 1 >= _levels.size())
+      {
+        for (size_t id = first_id; id < last_id; id++)
+        {
+          add_node(level, id);
+        }
+        break;
+      }
+      while (first_id < last_id && first_id % FAN_OUT != 0)
+      {
+        add_node(level, first_id++);
+      }
+      while (first_id < last_id && last_id % FAN_OUT != 0)
+      {
+        add_node(level, --last_id);
+      }
+      first_id /= FAN_OUT;
+      last_id /= FAN_OUT;
+    }
+  }
+
+  stat.count = summary.count;
+  stat.min = summary.min;
+  stat.max = summary.max;
+  stat.mean = summary.mean;
+  stat.stddev = std::sqrt(summary.m2 / double(summary.count));
+  stat.rms = std::sqrt(summary.m2 / double(summary.count) + summary.mean * summary.mean);
+  stat.first_x = series.sample(first_index).x();
+  stat.last_x = series.sample(last_index - 1).x();
+
+  if (has_nodes)
+  {
+    for (double value : values)
+    {
+      digest.add(value);
+    }
+    stat.median = digest.quantile(0.5);
+    stat.percentile_5 = digest.quantile(0.05);
+    stat.percentile_95 = digest.quantile(0.95);
+  }
+  else
+  {
+    // few samples: exact values
+    std::sort(values.begin(), values.end());
+    stat.median = sortedQuantile(values, 0.5);
+    stat.percentile_5 = sortedQuantile(values, 0.05);
+    stat.percentile_95 = sortedQuantile(values, 0.95);
+  }
+  return stat;
+}
+
+size_t SeriesSummaryIndex::firstId(size_t level) const
+{
+  size_t id = _begin / BLOCK_SIZE;
+  for (size_t i = 0; i < level; i++)
+  {
+    id /= FAN_OUT;
+  }
+  return id;
+}
+
+bool SeriesSummaryIndex::findBegin(const QwtSeriesData<QPointF>& series, size_t& begin) const
+{
+  const size_t size = series.size();
+  const QPointF front = series.sample(0);
+  begin = _begin;
+
+  if (!samePoint(front, _front))
+  {
+    // Samples were removed from the front. The first block that starts after the new
+    // front is still complete: find where its first sample is now.
+    auto block_it = std::upper_bound(
+        _block_front.begin(), _block_front.end(), front.x(),
+        [](double x, const QPointF& block_front) { return x < block_front.x(); });
+    if (block_it == _block_front.end())
+    {
+      return false;
+    }
+    const size_t block_begin =
+        (firstId(0) + size_t(block_it - _block_front.begin())) * BLOCK_SIZE;
+
+    bool found = false;
+    for (size_t i = lowerBound(series, block_it->x());
+         i < size && i <= block_begin && series.sample(i).x() == block_it->x(); i++)
+    {
+      if (samePoint(series.sample(i), *block_it))
+      {
+        begin = block_begin - i;
+        found = true;
+        break;
+      }
+    }
+    if (!found || begin < _begin)
+    {
+      return false;
+    }
+  }
+  // the last sample indexed must be still in the same position
+  if (begin >= _end || _end - 1 - begin >= size)
+  {
+    return false;
+  }
+  return samePoint(series.sample(_end - 1 - begin), _back);
+}
+
+void SeriesSummaryIndex::removeFront(const QwtSeriesData<QPointF>& series, size_t new_begin)
+{
+  const size_t first_block = new_begin / BLOCK_SIZE;
+  size_t first_id = first_block;
+  for (size_t level = 0; level < _levels.size(); level++)
+  {
+    auto& nodes = _levels[level];
+    for (size_t id = firstId(level); id < first_id && !nodes.empty(); id++)
+    {
+      nodes.pop_front();
+      if (level == 0)
+      {
+        _block_front.pop_front();
+      }
+    }
+    first_id /= FAN_OUT;
+  }
+  _begin = new_begin;
+  _front = series.sample(0);
+
+  // the first block may be incomplete now, and its ancestors for sure
+  if (new_begin % BLOCK_SIZE != 0)
+  {
+    _levels[0].front() = makeBlock(series, first_block, _end);
+    _block_front.front() = _front;
+  }
+  updateParents(first_block, first_block);
+}
+
+void SeriesSummaryIndex::append(const QwtSeriesData<QPointF>& series, size_t new_end)
+{
+  if (_levels.empty())
+  {
+    _levels.resize(1);
+    _front = series.sample(0);
+  }
+  // the last block, if incomplete, and the new ones
+  const size_t first_block = _end / BLOCK_SIZE;
+  const size_t last_block = (new_end - 1) / BLOCK_SIZE;
+  auto& blocks = _levels[0];
+
+  for (size_t id = first_block; id <= last_block; id++)
+  {
+    Node block = makeBlock(series, id, new_end);
+    const size_t index = id - firstId(0);
+    if (index < blocks.size())
+    {
+      blocks[index] = std::move(block);
+    }
+    else
+    {
+      blocks.push_back(std::move(block));
+      _block_front.push_back(series.sample(std::max(id * BLOCK_SIZE, _begin) - _begin));
+    }
+  }
+  _end = new_end;
+  _back = series.sample(_end - 1 - _begin);
+  updateParents(first_block, last_block);
+}
+
+SeriesSummaryIndex::Node SeriesSummaryIndex::makeBlock(const QwtSeriesData<QPointF>& series,
+                                                       size_t block_id, size_t end) const
+{
+  const size_t first = std::max(block_id * BLOCK_SIZE, _begin);
+  const size_t last = std::min((block_id + 1) * BLOCK_SIZE, end);
+  Node block;
+  for (size_t i = first; i < last; i++)
+  {
+    const double y = series.sample(i - _begin).y();
+    block.summary.add(y);
+    block.digest.add(y);
+  }
+  block.digest.compress();
+  return block;
+}
+
+void SeriesSummaryIndex::updateParents(size_t first_block, size_t last_block)
+{
+  size_t first = first_block;
+  size_t last = last_block;
+
+  for (size_t level = 1; level < _levels.size() || _levels[level - 1].size() > 1; level++)
+  {
+    if (level == _levels.size())
+    {
+      _levels.emplace_back();
+    }
+    const auto& children = _levels[level - 1];
+    auto& nodes = _levels[level];
+    const size_t children_first_id = firstId(level - 1);
+    const size_t children_end_id = children_first_id + children.size();
+    const size_t first_id = firstId(level);
+
+    // nodes missing before "first" are created too (i.e. a new level)
+    first = std::min(first / FAN_OUT, first_id + nodes.size());
+    last = last / FAN_OUT;
+
+    for (size_t id = first; id <= last; id++)
+    {
+      Node node;
+      const size_t child_end = std::min((id + 1) * FAN_OUT, children_end_id);
+      for (size_t child = std::max(id * FAN_OUT, children_first_id); child < child_end; child++)
+      {
+        const Node& child_node = children[child - children_first_id];
+        node.summary.merge(child_node.summary);
+        node.digest.merge(child_node.digest);
+      }
+      node.digest.compress();
+
+      const size_t index = id - first_id;
+      if (index < nodes.size())
+      {
+        nodes[index] = std::move(node);
+      }
+      else
+      {
+        nodes.push_back(std::move(node));
+      }
+    }
+  }
+}
@@ -0,0 +1,171 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SERIES_SUMMARY_INDEX_H
+#define SERIES_SUMMARY_INDEX_H
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+#include <QPointF>
+#include "qwt_series_data.h"
+
+/**
+ * Mergeable sketch of a distribution, used to estimate its quantiles
+ * (t-digest, Dunning and Ertl, with the arcsine scale function).
+ *
+ * The values are clustered in at most ~"compression" centroids, smaller near the tails,
+ * therefore the error of extreme quantiles is small. Two digests can be merged.
+ */
+class TDigest
+{
+public:
+  explicit TDigest(double compression = 100) : _compression(compression)
+  {
+  }
+
+  void add(double value, double weight = 1.0);
+
+  void merge(const TDigest& other);
+
+  /// Merge the values added since the last call. Called by quantile(), if needed.
+  void compress();
+
+  /// "q" in the range [0, 1]. NaN if empty.
+  double quantile(double q);
+
+  double totalWeight() const
+  {
+    return _total_weight + _buffer_weight;
+  }
+
+  size_t centroidCount() const
+  {
+    return _centroids.size();
+  }
+
+private:
+  struct Centroid
+  {
+    double mean;
+    double weight;
+  };
+
+  double _compression;
+  std::vector<Centroid> _centroids;
+  std::vector<Centroid> _buffer;
+  double _total_weight = 0;
+  double _buffer_weight = 0;
+  double _min = std::numeric_limits<double>::max();
+  double _max = std::numeric_limits<double>::lowest();
+};
+
+/**
+ * Statistics of the Y values of a time series in any range of X, computed from
+ * summaries of blocks of samples rather than from the samples themselves.
+ *
+ * The samples are grouped in blocks of BLOCK_SIZE; a block stores count, min, max,
+ * mean and variance (mergeable with the formula of Chan et al.) and a TDigest.
+ * The blocks are the leaves of a tree with FAN_OUT children per node. A query merges
+ * the O(log N) nodes that cover the range, plus the samples of the two incomplete
+ * blocks at its boundaries, read from the series.
+ *
+ * sync() updates the index incrementally when samples are appended, or removed from
+ * the front, as it happens while streaming. Any other change rebuilds it: it is detected
+ * through the rewrite count of the series, or when the series is another object.
+ */
+class SeriesSummaryIndex
+{
+public:
+  struct Statistics
+  {
+    size_t count = 0;
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+    // population standard deviation
+    double stddev = 0;
+    double rms = 0;
+    double median = 0;
+    double percentile_5 = 0;
+    double percentile_95 = 0;
+    // X of the first and last sample
+    double first_x = 0;
+    double last_x = 0;
+  };
+
+  static constexpr size_t BLOCK_SIZE = 1024;
+  static constexpr size_t FAN_OUT = 16;
+
+  void clear();
+
+  /// Update the index to the current content of "series", that must be sorted by X.
+  /// "rewrite_count" changes when the samples already indexed may have changed
+  /// (see PlotDataBase::rewriteCount()).
+  void sync(const QwtSeriesData<QPointF>& series, uint64_t rewrite_count);
+
+  /// Statistics of the samples with X in [min_x, max_x]. sync() must be called first.
+  Statistics query(const QwtSeriesData<QPointF>& series, double min_x, double max_x) const;
+
+private:
+  struct Summary
+  {
+    size_t count = 0;
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+    // sum of the squared differences from the mean
+    double m2 = 0;
+
+    void add(double value);
+
+    void merge(const Summary& other);
+  };
+
+  struct Node
+  {
+    Summary summary;
+    TDigest digest;
+  };
+
+  // _levels[0] are the blocks. Node "id" of level L covers the blocks
+  // [id * FAN_OUT^L, (id + 1) * FAN_OUT^L)
+  std::vector<std::deque<Node>> _levels;
+
+  // first sample of each block, used to find them again when the front is removed
+  std::deque<QPointF> _block_front;
+
+  // the samples are numbered from the first one ever indexed: the series contains the
+  // samples [_begin, _end), and the block "id" contains the samples
+  // [id * BLOCK_SIZE, (id + 1) * BLOCK_SIZE)
+  size_t _begin = 0;
+  size_t _end = 0;
+  QPointF _front;
+  QPointF _back;
+
+  // what was indexed, to detect the changes that the samples at the ends can't show
+  const QwtSeriesData<QPointF>* _series = nullptr;
+  uint64_t _rewrite_count = 0;
+
+  size_t firstId(size_t level) const;
+
+  // number of the sample at index 0 of the series, or false if the series changed
+  // in a way that can't be updated incrementally
+  bool findBegin(const QwtSeriesData<QPointF>& series, size_t& begin) const;
+
+  void removeFront(const QwtSeriesData<QPointF>& series, size_t new_begin);
+
+  void append(const QwtSeriesData<QPointF>& series, size_t new_end);
+
+  // summary of the samples of the block, up to the sample "end" (excluded)
+  Node makeBlock(const QwtSeriesData<QPointF>& series, size_t block_id, size_t end) const;
+
+  // recompute the ancestors of the blocks [first_block, last_block]
+  void updateParents(size_t first_block, size_t last_block);
+};
+
+#endif  // SERIES_SUMMARY_INDEX_H
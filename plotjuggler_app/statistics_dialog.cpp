@@ -6,6 +6,7 @@
 
 #include "statistics_dialog.h"
 #include "ui_statistics_dialog.h"
+#include <limits>
 #include <QTableWidgetItem>
 #include "qwt_text.h"
 
@@ -37,52 +38,31 @@ bool StatisticsDialog::calcVisibleRange()
 
 void StatisticsDialog::update(PJ::Range range)
 {
-  std::map<QString, Statistics> statistics;
+  std::map<QString, SeriesSummaryIndex::Statistics> statistics;
+  std::map<const QwtPlotCurve*, SeriesSummaryIndex> indices;
 
-  for (const auto& info : _parent->curveList())
+  // the X of a XY curve is not sorted: use always the full range
+  if (!calcVisibleRange() || _parent->isXYPlot())
   {
-    Statistics stat;
-    double start_time;
-    double end_time;
-    const auto ts = info.curve->data();
+    range.min = std::numeric_limits<double>::lowest();
+    range.max = std::numeric_limits<double>::max();
+  }
 
-    bool first = true;
+  for (const auto& info : _parent->curveList())
+  {
+    const auto ts = dynamic_cast<const QwtSeriesWrapper*>(info.curve->data());
 
-    for (size_t i = 0; i < ts->size(); i++)
+    auto index_it = _indices.find(info.curve);
+    SeriesSummaryIndex& index = indices[info.curve];
+    if (index_it != _indices.end())
     {
-      const auto p = ts->sample(i);
-      if (calcVisibleRange())
-      {
-        if (p.x() < range.min)
-        {
-          continue;
-        }
-        if (p.x() > range.max)
-        {
-          break;
-        }
-      }
-      stat.count++;
-      if (first)
-      {
-        start_time = p.x();
-        end_time = p.x();
-        stat.min = p.y();
-        stat.max = p.y();
-        first = false;
-      }
-      else
-      {
-        start_time = std::min(start_time, p.x());
-        end_time = std::max(end_time, p.x());
-        stat.min = std::min(stat.min, p.y());
-        stat.max = std::max(stat.max, p.y());
-      }
-      stat.mean_tot += p.y();
+      index = std::move(index_it->second);
     }
-    stat.mean_interval = (end_time - start_time) / double(stat.count);
-    statistics[info.curve->title().text()] = stat;
+    index.sync(*ts, ts->rewriteCount());
+    statistics[info.curve->title().text()] = index.query(*ts, range.min, range.max);
   }
+  // forget the curves that were removed
+  _indices = std::move(indices);
 
   ui->tableWidget->setRowCount(statistics.size());
   int row = 0;
@@ -90,14 +70,22 @@ void StatisticsDialog::update(PJ::Range range)
   {
     const auto& stat = it.second;
 
-    std::array<QString, 6> row_values;
+    std::array<QString, 11> row_values;
     row_values[0] = it.first;
     row_values[1] = QString::number(stat.count);
-    row_values[2] = QString::number(stat.min, 'f');
-    row_values[3] = QString::number(stat.max, 'f');
-    double mean = stat.mean_tot / double(stat.count);
-    row_values[4] = QString::number(mean, 'f');
-    row_values[5] = QString::number(stat.mean_interval, 'f');
+    if (stat.count > 0)
+    {
+      row_values[2] = QString::number(stat.min, 'f');
+      row_values[3] = QString::number(stat.max, 'f');
+      row_values[4] = QString::number(stat.mean, 'f');
+      row_values[5] = QString::number(stat.stddev, 'f');
+      row_values[6] = QString::number(stat.rms, 'f');
+      row_values[7] = QString::number(stat.median, 'f');
+      row_values[8] = QString::number(stat.percentile_5, 'f');
+      row_values[9] = QString::number(stat.percentile_95, 'f');
+      double mean_interval = (stat.last_x - stat.first_x) / double(stat.count);
+      row_values[10] = QString::number(mean_interval, 'f');
+    }
 
     for (size_t col = 0; col < row_values.size(); col++)
     {
@@ -11,21 +11,13 @@
 #include <QCloseEvent>
 #include "PlotJuggler/plotdata.h"
 #include "plotwidget.h"
+#include "series_summary_index.h"
 
 namespace Ui
 {
 class statistics_dialog;
 }
 
-struct Statistics
-{
-  size_t count = 0;
-  double min = 0;
-  double max = 0;
-  double mean_tot = 0;
-  double mean_interval = 0;
-};
-
 class StatisticsDialog : public QDialog
 {
   Q_OBJECT
@@ -46,6 +38,9 @@ private:
   Ui::statistics_dialog* ui;
 
   PlotWidget* _parent;
+
+  // updated incrementally, while the dialog is open
+  std::map<const QwtPlotCurve*, SeriesSummaryIndex> _indices;
 };
 
 #endif  // STATISTICS_DIALOG_H
@@ -200,6 +200,7 @@ QDomElement TabbedPlotWidget::xmlSaveState(QDomDocument& doc) const
 bool TabbedPlotWidget::xmlLoadState(QDomElement& tabbed_area)
 {
   int prev_count = tabWidget()->count();
+  _loading_state = true;
 
   for (auto docker_elem = tabbed_area.firstChildElement("Tab"); !docker_elem.isNull();
        docker_elem = docker_elem.nextSiblingElement("Tab"))
@@ -211,6 +212,7 @@ bool TabbedPlotWidget::xmlLoadState(QDomElement& tabbed_area)
 
     if (!success)
     {
+      _loading_state = false;
       return false;
     }
   }
@@ -230,6 +232,13 @@ bool TabbedPlotWidget::xmlLoadState(QDomElement& tabbed_area)
     tabWidget()->setCurrentIndex(current_index);
   }
 
+  // only the visible tab is loaded now, the others when they are shown
+  _loading_state = false;
+  if (currentTab())
+  {
+    currentTab()->loadPendingPlots();
+  }
+
   emit undoableChange();
   return true;
 }
@@ -287,8 +296,9 @@ void TabbedPlotWidget::on_tabWidget_currentChanged(int index)
   }
 
   PlotDocker* tab = dynamic_cast<PlotDocker*>(tabWidget()->widget(index));
-  if (tab)
+  if (tab && !_loading_state)
   {
+    tab->loadPendingPlots();
     tab->replot();
   }
   for (int i = 0; i < tabWidget()->count(); i++)
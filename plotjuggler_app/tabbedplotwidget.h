@@ -101,6 +101,9 @@ private:
 
   QString _parent_type;
 
+  // while loading a layout, the tabs that become current are not loaded
+  bool _loading_state = false;
+
   virtual void closeEvent(QCloseEvent* event) override;
 
   // void printPlotsNames();
@@ -1,10 +1,16 @@
 #include "absolute_transform.h"
 #include <QFormLayout>
 #include <QDoubleValidator>
+#include <algorithm>
 
-std::optional<PlotData::Point> AbsoluteTransform::calculateNextPoint(size_t index)
+bool AbsoluteTransform::calculateBlock(const double* x, const double* y, size_t count,
+                                       Output& output)
 {
-  const auto& p = dataSource()->at(index);
-  PlotData::Point out = { p.x, std::abs(p.y) };
-  return out;
+  output.resize(count);
+  std::copy(x, x + count, output.x.begin());
+  for (size_t i = 0; i < count; i++)
+  {
+    output.y[i] = std::abs(y[i]);
+  }
+  return true;
 }
@@ -23,7 +23,7 @@ public:
   }
 
 private:
-  std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+  bool calculateBlock(const double* x, const double* y, size_t count, Output& output) override;
 };
 
 #endif  // ABSOLUTE_TRANSFORM_H
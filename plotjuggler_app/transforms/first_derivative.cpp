@@ -39,26 +39,39 @@ FirstDerivative::~FirstDerivative()
   delete _widget;
 }
 
-std::optional<PlotData::Point> FirstDerivative::calculateNextPoint(size_t index)
+void FirstDerivative::reset()
 {
-  if (index == 0)
+  _has_previous = false;
+  TransformFunction_SISO::reset();
+}
+
+bool FirstDerivative::calculateBlock(const double* x, const double* y, size_t count,
+                                     Output& output)
+{
+  output.resize(count);
+  size_t out_count = 0;
+
+  auto Derivative = [&](double prev_x, double prev_y, double px, double py) {
+    const double dt = (_dT == 0.0) ? (px - prev_x) : _dT;
+    output.x[out_count] = prev_x;
+    output.y[out_count] = (py - prev_y) / dt;
+    // the point is overwritten by the next one if the time doesn't increase
+    out_count += (dt > 0) ? 1 : 0;
+  };
+
+  if (_has_previous)
   {
-    return {};
+    Derivative(_previous.x, _previous.y, x[0], y[0]);
   }
-
-  const auto& prev = dataSource()->at(index - 1);
-  const auto& p = dataSource()->at(index);
-
-  double dt = (_dT == 0.0) ? (p.x - prev.x) : _dT;
-
-  if (dt <= 0)
+  for (size_t i = 1; i < count; i++)
   {
-    return {};
+    Derivative(x[i - 1], y[i - 1], x[i], y[i]);
   }
+  output.resize(out_count);
 
-  double der = (p.y - prev.y) / dt;
-  PlotData::Point out = { prev.x, der };
-  return out;
+  _previous = { x[count - 1], y[count - 1] };
+  _has_previous = true;
+  return true;
 }
 
 QWidget* FirstDerivative::optionsWidget()
@@ -108,6 +121,8 @@ bool FirstDerivative::xmlLoadState(const QDomElement& parent_element)
   {
     ui->radioCustom->setChecked(true);
   }
+  // the line edit doesn't notify setText(), nor the radio buttons an unchanged state
+  _dT = ui->radioCustom->isChecked() ? ui->lineEditCustom->text().toDouble() : 0.0;
   return true;
 }
 
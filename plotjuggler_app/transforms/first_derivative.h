@@ -32,12 +32,18 @@ public:
 
   void on_buttonCompute_clicked();
 
+  void reset() override;
+
 private:
-  std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+  bool calculateBlock(const double* x, const double* y, size_t count, Output& output) override;
 
   QWidget* _widget;
   Ui::FirstDerivariveForm* ui;
   double _dT;
+
+  // last sample of the previous block
+  PlotData::Point _previous;
+  bool _has_previous = false;
 };
 
 #endif  // FIRST_DERIVATIVE_H
@@ -39,27 +39,32 @@ IntegralTransform::~IntegralTransform()
   delete _widget;
 }
 
-std::optional<PlotData::Point> IntegralTransform::calculateNextPoint(size_t index)
+bool IntegralTransform::calculateBlock(const double* x, const double* y, size_t count,
+                                       Output& output)
 {
-  if (index == 0)
-  {
-    return {};
-  }
-
-  const auto& prev = dataSource()->at(index - 1);
-  const auto& p = dataSource()->at(index);
+  output.x.reserve(count);
+  output.y.reserve(count);
 
-  double dt = (_dT == 0.0) ? (p.x - prev.x) : _dT;
-
-  if (dt <= 0)
+  double prev_x = _previous.x;
+  double prev_y = _previous.y;
+  for (size_t i = (_has_previous ? 0 : 1); i < count; i++)
   {
-    return {};
+    if (i > 0)
+    {
+      prev_x = x[i - 1];
+      prev_y = y[i - 1];
+    }
+    const double dt = (_dT == 0.0) ? (x[i] - prev_x) : _dT;
+    if (dt > 0)
+    {
+      _accumulated_value += (y[i] + prev_y) * dt / (2.0);
+      output.push_back(x[i], _accumulated_value);
+    }
   }
 
-  double val = (p.y + prev.y) * dt / (2.0);
-  _accumulated_value += val;
-  PlotData::Point out = { p.x, _accumulated_value };
-  return out;
+  _previous = { x[count - 1], y[count - 1] };
+  _has_previous = true;
+  return true;
 }
 
 QWidget* IntegralTransform::optionsWidget()
@@ -76,6 +81,7 @@ QWidget* IntegralTransform::optionsWidget()
 void IntegralTransform::reset()
 {
   _accumulated_value = 0.0;
+  _has_previous = false;
   TransformFunction_SISO::reset();
 }
 
@@ -114,6 +120,8 @@ bool IntegralTransform::xmlLoadState(const QDomElement& parent_element)
   {
     ui->radioCustom->setChecked(true);
   }
+  // the line edit doesn't notify setText(), nor the radio buttons an unchanged state
+  _dT = ui->radioCustom->isChecked() ? ui->lineEditCustom->text().toDouble() : 0.0;
   return true;
 }
 
@@ -35,13 +35,17 @@ public:
   void on_buttonCompute_clicked();
 
 private:
-  std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+  bool calculateBlock(const double* x, const double* y, size_t count, Output& output) override;
 
   QWidget* _widget;
   Ui::IntegralTransform* ui;
   double _dT;
 
   double _accumulated_value;
+
+  // last sample of the previous block
+  PlotData::Point _previous;
+  bool _has_previous = false;
 };
 
 #endif  // INTEGRAL_TRANSFORM_H
@@ -9,11 +9,18 @@ MovingAverageFilter::MovingAverageFilter()
   , _ring_view(_buffer.begin(), _buffer.end())
 {
   ui->setupUi(_widget);
-
-  connect(ui->spinBoxSamples, qOverload<int>(&QSpinBox::valueChanged), this,
-          [=](int) { emit parametersChanged(); });
-
-  connect(ui->checkBoxTimeOffset, &QCheckBox::toggled, this, [=]() { emit parametersChanged(); });
+  _samples = ui->spinBoxSamples->value();
+  _time_offset = ui->checkBoxTimeOffset->isChecked();
+
+  connect(ui->spinBoxSamples, qOverload<int>(&QSpinBox::valueChanged), this, [=](int value) {
+    _samples = value;
+    emit parametersChanged();
+  });
+
+  connect(ui->checkBoxTimeOffset, &QCheckBox::toggled, this, [=](bool checked) {
+    _time_offset = checked;
+    emit parametersChanged();
+  });
 }
 
 MovingAverageFilter::~MovingAverageFilter()
@@ -28,38 +35,52 @@ void MovingAverageFilter::reset()
   TransformFunction_SISO::reset();
 }
 
-std::optional<PlotData::Point> MovingAverageFilter::calculateNextPoint(size_t index)
+bool MovingAverageFilter::calculateBlock(const double* x, const double* y, size_t count,
+                                         Output& output)
 {
-  size_t buffer_size = std::min(size_t(ui->spinBoxSamples->value()), size_t(dataSource()->size()));
+  size_t buffer_size = std::min(size_t(_samples), size_t(dataSource()->size()));
   if (buffer_size != _buffer.size())
   {
     _buffer.resize(buffer_size);
     _ring_view = nonstd::ring_span<PlotData::Point>(_buffer.begin(), _buffer.end());
   }
+  const bool time_offset = _time_offset;
 
-  const auto& p = dataSource()->at(index);
-  _ring_view.push_back(p);
-
-  while (_ring_view.size() < buffer_size)
-  {
-    _ring_view.push_back(p);
-  }
-
-  double total = 0;
-
-  for (size_t i = 0; i < buffer_size; i++)
-  {
-    total += _ring_view[i].y;
-  }
-
-  double time = p.x;
-  if (ui->checkBoxTimeOffset->isChecked())
+  output.resize(count);
+  for (size_t i = 0; i < count; i++)
   {
-    time = (_ring_view.back().x + _ring_view.front().x) / 2.0;
+    const PlotData::Point p = { x[i], y[i] };
+    if (_ring_view.empty())
+    {
+      // the first sample fills the whole window
+      while (_ring_view.size() < buffer_size)
+      {
+        _ring_view.push_back(p);
+      }
+      _samples_since_sum = buffer_size;
+    }
+    else
+    {
+      _total += p.y - _ring_view.front().y;
+      _ring_view.push_back(p);
+      _samples_since_sum++;
+    }
+
+    // otherwise the rounding errors of the running sum would accumulate
+    if (_samples_since_sum >= buffer_size)
+    {
+      _total = 0;
+      for (const auto& point : _ring_view)
+      {
+        _total += point.y;
+      }
+      _samples_since_sum = 0;
+    }
+
+    output.x[i] = time_offset ? ((_ring_view.back().x + _ring_view.front().x) / 2.0) : p.x;
+    output.y[i] = _total / double(buffer_size);
   }
-
-  PlotData::Point out = { time, total / _ring_view.size() };
-  return out;
+  return true;
 }
 
 QWidget* MovingAverageFilter::optionsWidget()
@@ -88,5 +109,7 @@ bool MovingAverageFilter::xmlLoadState(const QDomElement& parent_element)
   ui->spinBoxSamples->setValue(widget_el.attribute("value").toInt());
   bool checked = widget_el.attribute("compensate_offset") == "true";
   ui->checkBoxTimeOffset->setChecked(checked);
+  _samples = ui->spinBoxSamples->value();
+  _time_offset = checked;
   return true;
 }
@@ -45,5 +45,13 @@ private:
   std::vector<PlotData::Point> _buffer;
   nonstd::ring_span_lite::ring_span<PlotData::Point> _ring_view;
 
-  std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+  // copy of the options, calculateBlock() may run outside the GUI thread
+  int _samples = 1;
+  bool _time_offset = false;
+
+  // running sum of the window, recomputed once per window
+  double _total = 0;
+  size_t _samples_since_sum = 0;
+
+  bool calculateBlock(const double* x, const double* y, size_t count, Output& output) override;
 };
@@ -8,9 +8,12 @@ MovingRMS::MovingRMS()
   , _ring_view(_buffer.begin(), _buffer.end())
 {
   ui->setupUi(_widget);
+  _samples = ui->spinBoxSamples->value();
 
-  connect(ui->spinBoxSamples, qOverload<int>(&QSpinBox::valueChanged), this,
-          [=](int) { emit parametersChanged(); });
+  connect(ui->spinBoxSamples, qOverload<int>(&QSpinBox::valueChanged), this, [=](int value) {
+    _samples = value;
+    emit parametersChanged();
+  });
 }
 
 MovingRMS::~MovingRMS()
@@ -46,36 +49,52 @@ bool MovingRMS::xmlLoadState(const QDomElement& parent_element)
     return false;
   }
   ui->spinBoxSamples->setValue(widget_el.attribute("value").toInt());
+  _samples = ui->spinBoxSamples->value();
   return true;
 }
 
-std::optional<PJ::PlotData::Point> MovingRMS::calculateNextPoint(size_t index)
+bool MovingRMS::calculateBlock(const double* x, const double* y, size_t count, Output& output)
 {
-  size_t buffer_size = std::min(size_t(ui->spinBoxSamples->value()), size_t(dataSource()->size()));
+  size_t buffer_size = std::min(size_t(_samples), size_t(dataSource()->size()));
   if (buffer_size != _buffer.size())
   {
     _buffer.resize(buffer_size);
     _ring_view = nonstd::ring_span<PJ::PlotData::Point>(_buffer.begin(), _buffer.end());
   }
 
-  const auto& p = dataSource()->at(index);
-  _ring_view.push_back(p);
-
-  while (_ring_view.size() < buffer_size)
+  output.resize(count);
+  std::copy(x, x + count, output.x.begin());
+  for (size_t i = 0; i < count; i++)
   {
-    _ring_view.push_back(p);
-  }
+    const PJ::PlotData::Point p = { x[i], y[i] };
+    if (_ring_view.empty())
+    {
+      // the first sample fills the whole window
+      while (_ring_view.size() < buffer_size)
+      {
+        _ring_view.push_back(p);
+      }
+      _samples_since_sum = buffer_size;
+    }
+    else
+    {
+      const double old_val = _ring_view.front().y;
+      _total_sqr += p.y * p.y - old_val * old_val;
+      _ring_view.push_back(p);
+      _samples_since_sum++;
+    }
 
-  double total_sqr = 0;
-
-  for (size_t i = 0; i < buffer_size; i++)
-  {
-    double val = _ring_view[i].y;
-    total_sqr += val * val;
+    // otherwise the rounding errors of the running sum would accumulate
+    if (_samples_since_sum >= buffer_size)
+    {
+      _total_sqr = 0;
+      for (const auto& point : _ring_view)
+      {
+        _total_sqr += point.y * point.y;
+      }
+      _samples_since_sum = 0;
+    }
+    output.y[i] = sqrt(std::max(0.0, _total_sqr) / double(buffer_size));
   }
-
-  double time = p.x;
-
-  PJ::PlotData::Point out = { time, sqrt(total_sqr / _ring_view.size()) };
-  return out;
+  return true;
 }
@@ -45,7 +45,14 @@ private:
   std::vector<PJ::PlotData::Point> _buffer;
   nonstd::ring_span_lite::ring_span<PJ::PlotData::Point> _ring_view;
 
-  std::optional<PJ::PlotData::Point> calculateNextPoint(size_t index) override;
+  // value of spinBoxSamples
+  int _samples = 1;
+
+  // running sum of squares of the window, recomputed once per window
+  double _total_sqr = 0;
+  size_t _samples_since_sum = 0;
+
+  bool calculateBlock(const double* x, const double* y, size_t count, Output& output) override;
 };
 
 #endif  // MOVING_RMS_H
@@ -9,11 +9,18 @@ MovingVarianceFilter::MovingVarianceFilter()
   , _ring_view(_buffer.begin(), _buffer.end())
 {
   ui->setupUi(_widget);
+  _samples = ui->spinBoxSamples->value();
+  _std_dev = ui->checkBoxStdDev->isChecked();
 
-  connect(ui->spinBoxSamples, qOverload<int>(&QSpinBox::valueChanged), this,
-          [=](int) { emit parametersChanged(); });
+  connect(ui->spinBoxSamples, qOverload<int>(&QSpinBox::valueChanged), this, [=](int value) {
+    _samples = value;
+    emit parametersChanged();
+  });
 
-  connect(ui->checkBoxStdDev, &QCheckBox::toggled, this, [=]() { emit parametersChanged(); });
+  connect(ui->checkBoxStdDev, &QCheckBox::toggled, this, [=](bool checked) {
+    _std_dev = checked;
+    emit parametersChanged();
+  });
 }
 
 MovingVarianceFilter::~MovingVarianceFilter()
@@ -28,43 +35,65 @@ void MovingVarianceFilter::reset()
   TransformFunction_SISO::reset();
 }
 
-std::optional<PlotData::Point> MovingVarianceFilter::calculateNextPoint(size_t index)
+bool MovingVarianceFilter::calculateBlock(const double* x, const double* y, size_t count,
+                                          Output& output)
 {
-  size_t buffer_size = std::min(size_t(ui->spinBoxSamples->value()), size_t(dataSource()->size()));
+  size_t buffer_size = std::min(size_t(_samples), size_t(dataSource()->size()));
   if (buffer_size != _buffer.size())
   {
     _buffer.resize(buffer_size);
     _ring_view = nonstd::ring_span<PlotData::Point>(_buffer.begin(), _buffer.end());
   }
+  const bool std_dev = _std_dev;
+  const double N = double(buffer_size);
 
-  const auto& p = dataSource()->at(index);
-  _ring_view.push_back(p);
-
-  while (_ring_view.size() < buffer_size)
+  output.resize(count);
+  std::copy(x, x + count, output.x.begin());
+  for (size_t i = 0; i < count; i++)
   {
-    _ring_view.push_back(p);
-  }
+    const PlotData::Point p = { x[i], y[i] };
+    if (_ring_view.empty())
+    {
+      // the first sample fills the whole window
+      while (_ring_view.size() < buffer_size)
+      {
+        _ring_view.push_back(p);
+      }
+      _samples_since_sum = buffer_size;
+    }
+    else
+    {
+      const double old_val = _ring_view.front().y;
+      const double old_mean = _mean;
+      _mean += (p.y - old_val) / N;
+      _sum_sqr_dev += (p.y - old_val) * (p.y - _mean + old_val - old_mean);
+      _ring_view.push_back(p);
+      _samples_since_sum++;
+    }
 
-  double total = 0;
-  for (const auto& point : _ring_view)
-  {
-    total += point.y;
-  }
-  const double N = double(_ring_view.size());
-  const double avg = total / N;
+    // otherwise the rounding errors of the running sums would accumulate
+    if (_samples_since_sum >= buffer_size)
+    {
+      double total = 0;
+      for (const auto& point : _ring_view)
+      {
+        total += point.y;
+      }
+      _mean = total / N;
 
-  double total_sqr = 0;
-  for (const auto& point : _ring_view)
-  {
-    const auto v = point.y - avg;
-    total_sqr += v * v;
-  }
+      _sum_sqr_dev = 0;
+      for (const auto& point : _ring_view)
+      {
+        const auto v = point.y - _mean;
+        _sum_sqr_dev += v * v;
+      }
+      _samples_since_sum = 0;
+    }
 
-  if (ui->checkBoxStdDev->isChecked())
-  {
-    return PlotData::Point{ p.x, std::sqrt(total_sqr / N) };
+    const double variance = std::max(0.0, _sum_sqr_dev) / N;
+    output.y[i] = std_dev ? std::sqrt(variance) : variance;
   }
-  return PlotData::Point{ p.x, total_sqr / N };
+  return true;
 }
 
 QWidget* MovingVarianceFilter::optionsWidget()
@@ -91,5 +120,7 @@ bool MovingVarianceFilter::xmlLoadState(const QDomElement& parent_element)
   ui->spinBoxSamples->setValue(widget_el.attribute("value").toInt());
   bool checked = widget_el.attribute("apply_sqrt") == "true";
   ui->checkBoxStdDev->setChecked(checked);
+  _samples = ui->spinBoxSamples->value();
+  _std_dev = checked;
   return true;
 }
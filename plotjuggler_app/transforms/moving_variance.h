@@ -45,5 +45,15 @@ private:
   std::vector<PlotData::Point> _buffer;
   nonstd::ring_span_lite::ring_span<PlotData::Point> _ring_view;
 
-  std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+  // values of the widgets, updated in the GUI thread
+  int _samples = 1;
+  bool _std_dev = false;
+
+  // mean and sum of squared deviations of the window, updated when a sample replaces
+  // the oldest one and recomputed once per window
+  double _mean = 0;
+  double _sum_sqr_dev = 0;
+  size_t _samples_since_sum = 0;
+
+  bool calculateBlock(const double* x, const double* y, size_t count, Output& output) override;
 };
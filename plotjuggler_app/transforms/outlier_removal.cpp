@@ -2,15 +2,16 @@
 #include "ui_outlier_removal.h"
 
 OutlierRemovalFilter::OutlierRemovalFilter()
-  : ui(new Ui::OutlierRemovalFilter)
-  , _widget(new QWidget())
-  , _buffer(4)
-  , _ring_view(_buffer.begin(), _buffer.end())
+  : ui(new Ui::OutlierRemovalFilter), _widget(new QWidget())
 {
   ui->setupUi(_widget);
+  _factor = ui->spinBoxFactor->value();
 
   connect(ui->spinBoxFactor, qOverload<double>(&QDoubleSpinBox::valueChanged), this,
-          [=](int) { emit parametersChanged(); });
+          [=](double value) {
+            _factor = value;
+            emit parametersChanged();
+          });
 }
 
 OutlierRemovalFilter::~OutlierRemovalFilter()
@@ -40,31 +41,50 @@ bool OutlierRemovalFilter::xmlLoadState(const QDomElement& parent_element)
     return false;
   }
   ui->spinBoxFactor->setValue(widget_el.attribute("value", "100.0").toDouble());
+  _factor = ui->spinBoxFactor->value();
   return true;
 }
 
-std::optional<PJ::PlotData::Point> OutlierRemovalFilter::calculateNextPoint(size_t index)
+void OutlierRemovalFilter::reset()
 {
-  const auto& p = dataSource()->at(index);
-  _ring_view.push_back(p.y);
+  _samples_count = 0;
+  TransformFunction_SISO::reset();
+}
 
-  if (index < 3)
-  {
-    return p;
-  }
+bool OutlierRemovalFilter::calculateBlock(const double* x, const double* y, size_t count,
+                                          Output& output)
+{
+  const double thresh = _factor;
+  output.x.reserve(count);
+  output.y.reserve(count);
 
-  double d1 = (_ring_view[1] - _ring_view[2]);
-  double d2 = (_ring_view[2] - _ring_view[3]);
-  if (d1 * d2 < 0)  // spike
+  for (size_t i = 0; i < count; i++)
   {
-    double d0 = (_ring_view[0] - _ring_view[1]);
-    double thresh = ui->spinBoxFactor->value();
+    _window = { _window[1], _window[2], _window[3], y[i] };
+    _samples_count++;
 
-    double jump = std::max(std::abs(d1), std::abs(d2));
-    if (jump / std::abs(d0) > thresh)
+    if (_samples_count <= 2)
     {
-      return {};
+      output.push_back(x[i], y[i]);
     }
+    else if (_samples_count > 3)
+    {
+      // is the previous sample a spike?
+      bool discard = false;
+      double d1 = (_window[1] - _window[2]);
+      double d2 = (_window[2] - _window[3]);
+      if (d1 * d2 < 0)
+      {
+        double d0 = (_window[0] - _window[1]);
+        double jump = std::max(std::abs(d1), std::abs(d2));
+        discard = (jump / std::abs(d0) > thresh);
+      }
+      if (!discard)
+      {
+        output.push_back(_previous.x, _previous.y);
+      }
+    }
+    _previous = { x[i], y[i] };
   }
-  return dataSource()->at(index - 1);
+  return true;
 }
@@ -1,10 +1,10 @@
 #pragma once
 
+#include <array>
 #include <QWidget>
 #include <QDoubleSpinBox>
 #include "PlotJuggler/transform_function.h"
 #include "ui_outlier_removal.h"
-#include "PlotJuggler/contrib/ring_span.hpp"
 
 using namespace PJ;
 
@@ -30,6 +30,8 @@ public:
     return transformName();
   }
 
+  void reset() override;
+
   QWidget* optionsWidget() override;
 
   bool xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const override;
@@ -39,8 +41,13 @@ public:
 private:
   Ui::OutlierRemovalFilter* ui;
   QWidget* _widget;
-  std::vector<double> _buffer;
-  nonstd::ring_span_lite::ring_span<double> _ring_view;
-
-  std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+  // value of spinBoxFactor
+  double _factor = 0;
+  // last 4 values, the oldest first.
+  // A sample is accepted or discarded when the next one is received
+  std::array<double, 4> _window = {};
+  PlotData::Point _previous;
+  size_t _samples_count = 0;
+
+  bool calculateBlock(const double* x, const double* y, size_t count, Output& output) override;
 };
@@ -2,13 +2,18 @@
 #include "ui_samples_count.h"
 
 #include <QSpinBox>
+#include <algorithm>
 
 SamplesCountFilter::SamplesCountFilter() : ui(new Ui::SamplesCount), _widget(new QWidget())
 {
   ui->setupUi(_widget);
+  _milliseconds = ui->spinBoxMilliseconds->value();
 
   connect(ui->spinBoxMilliseconds, qOverload<int>(&QSpinBox::valueChanged), this,
-          [=](int) { emit parametersChanged(); });
+          [=](int value) {
+            _milliseconds = value;
+            emit parametersChanged();
+          });
 }
 
 SamplesCountFilter::~SamplesCountFilter()
@@ -39,9 +44,16 @@ bool SamplesCountFilter::xmlLoadState(const QDomElement& parent_element)
   }
   int ms = widget_el.attribute("milliseconds", "1000").toInt();
   ui->spinBoxMilliseconds->setValue(ms);
+  _milliseconds = ui->spinBoxMilliseconds->value();
   return true;
 }
 
+void SamplesCountFilter::reset()
+{
+  _min_index = 0;
+  TransformFunction_SISO::reset();
+}
+
 std::optional<PJ::PlotData::Point> SamplesCountFilter::calculateNextPoint(size_t index)
 {
   if (dataSource()->size() == 0)
@@ -50,8 +62,9 @@ std::optional<PJ::PlotData::Point> SamplesCountFilter::calculateNextPoint(size_t
   }
 
   const auto& point = dataSource()->at(index);
-  const double delta = 0.001 * double(ui->spinBoxMilliseconds->value());
+  const double delta = 0.001 * double(_milliseconds);
   const double min_time = point.x - delta;
-  auto min_index = dataSource()->getIndexFromX(min_time);
+  auto min_index = dataSource()->getIndexFromX(min_time, _min_index);
+  _min_index = std::max(min_index, 0);
   return PJ::PlotData::Point{ point.x, double(index - min_index) };
 }
@@ -27,6 +27,8 @@ public:
     return transformName();
   }
 
+  void reset() override;
+
   QWidget* optionsWidget() override;
 
   bool xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const override;
@@ -37,8 +39,14 @@ private:
   Ui::SamplesCount* ui;
   QWidget* _widget;
 
+  // value of spinBoxMilliseconds
+  int _milliseconds = 0;
+
   int count_ = 0;
   double interval_end_ = 0;
 
+  // result of the previous search, the next one starts from it
+  int _min_index = 0;
+
   std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
 };
@@ -9,25 +9,30 @@ ScaleTransform::ScaleTransform() : _widget(new QWidget()), ui(new Ui::ScaleTrans
   ui->lineEditTimeOffset->setValidator(new QDoubleValidator());
   ui->lineEditValueOffset->setValidator(new QDoubleValidator());
   ui->lineEditValueScale->setValidator(new QDoubleValidator());
+  readOptions();
 
   connect(ui->buttonDegRad, &QPushButton::clicked, this, [=]() {
     const double deg_rad = 3.14159265359 / 180;
     ui->lineEditValueScale->setText(QString::number(deg_rad, 'g', 5));
+    readOptions();
     emit parametersChanged();
   });
 
   connect(ui->buttonRadDeg, &QPushButton::clicked, this, [=]() {
     const double rad_deg = 180.0 / 3.14159265359;
     ui->lineEditValueScale->setText(QString::number(rad_deg, 'g', 5));
+    readOptions();
     emit parametersChanged();
   });
 
-  connect(ui->lineEditTimeOffset, &QLineEdit::editingFinished, this,
-          [=]() { emit parametersChanged(); });
-  connect(ui->lineEditValueOffset, &QLineEdit::editingFinished, this,
-          [=]() { emit parametersChanged(); });
-  connect(ui->lineEditValueScale, &QLineEdit::editingFinished, this,
-          [=]() { emit parametersChanged(); });
+  for (QLineEdit* line_edit :
+       { ui->lineEditTimeOffset, ui->lineEditValueOffset, ui->lineEditValueScale })
+  {
+    connect(line_edit, &QLineEdit::editingFinished, this, [=]() {
+      readOptions();
+      emit parametersChanged();
+    });
+  }
 }
 
 ScaleTransform::~ScaleTransform()
@@ -62,16 +67,32 @@ bool ScaleTransform::xmlLoadState(const QDomElement& parent_element)
   ui->lineEditTimeOffset->setText(widget_el.attribute("time_offset"));
   ui->lineEditValueOffset->setText(widget_el.attribute("value_offset"));
   ui->lineEditValueScale->setText(widget_el.attribute("value_scale"));
+  readOptions();
   return true;
 }
 
-std::optional<PlotData::Point> ScaleTransform::calculateNextPoint(size_t index)
+void ScaleTransform::readOptions()
+{
+  _time_offset = ui->lineEditTimeOffset->text().toDouble();
+  _value_offset = ui->lineEditValueOffset->text().toDouble();
+  _value_scale = ui->lineEditValueScale->text().toDouble();
+}
+
+bool ScaleTransform::calculateBlock(const double* x, const double* y, size_t count,
+                                    Output& output)
 {
-  double off_x = ui->lineEditTimeOffset->text().toDouble();
-  double off_y = ui->lineEditValueOffset->text().toDouble();
-  double scale = ui->lineEditValueScale->text().toDouble();
+  const double off_x = _time_offset;
+  const double off_y = _value_offset;
+  const double scale = _value_scale;
 
-  const auto& p = dataSource()->at(index);
-  PlotData::Point out = { p.x + off_x, scale * p.y + off_y };
-  return out;
+  output.resize(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    output.x[i] = x[i] + off_x;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    output.y[i] = scale * y[i] + off_y;
+  }
+  return true;
 }
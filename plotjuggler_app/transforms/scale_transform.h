@@ -38,7 +38,14 @@ private:
   QWidget* _widget;
   Ui::ScaleTransform* ui;
 
-  std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+  // parsed values of the line edits, calculateBlock() may run outside the GUI thread
+  double _time_offset = 0;
+  double _value_offset = 0;
+  double _value_scale = 1;
+
+  void readOptions();
+
+  bool calculateBlock(const double* x, const double* y, size_t count, Output& output) override;
 };
 
 #endif  // SCALE_TRANSFORM_H
@@ -0,0 +1,282 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "undo_history.h"
+#include <algorithm>
+#include "plotwidget.h"
+#include "plot_docker.h"
+#include "tabbedplotwidget.h"
+
+namespace
+{
+// changes closer than this are merged in a single entry (i.e. mouse wheel zoom)
+const int MERGE_INTERVAL_MS = 100;
+}  // namespace
+
+UndoHistory::UndoHistory(SaveFunction save_layout, LoadFunction load_layout)
+  : _save_layout(std::move(save_layout)), _load_layout(std::move(load_layout))
+{
+  _timer.start();
+}
+
+void UndoHistory::clear()
+{
+  _undo_entries.clear();
+  _redo_entries.clear();
+  _plots.clear();
+  _states.clear();
+}
+
+void UndoHistory::reset(const QDomDocument& layout)
+{
+  clear();
+  Entry entry;
+  entry.checkpoint = layout;
+  pushUndo(std::move(entry));
+  updateAllStates();
+}
+
+void UndoHistory::recordChange(PlotWidget* modified_plot)
+{
+  const bool merge = (_timer.restart() < MERGE_INTERVAL_MS) && !_undo_entries.empty();
+
+  const auto plots = layoutPlots();
+  const auto modified_it = std::find(plots.begin(), plots.end(), modified_plot);
+
+  // a delta is possible only if the layout is the same as the previous change
+  const bool delta = !_undo_entries.empty() && plots == _plots && modified_it != plots.end() &&
+                     (_deltas_since_checkpoint < CHECKPOINT_INTERVAL || merge);
+
+  Entry entry;
+  if (delta)
+  {
+    // the zoom of any plot may change (linked zoom), but the content only of the modified one
+    const int modified_index = int(modified_it - plots.begin());
+    for (int i = 0; i < int(plots.size()); i++)
+    {
+      PlotState state = currentState(i, i == modified_index);
+      if (state.rect != _states[i].rect || state.content != _states[i].content)
+      {
+        entry.changes.push_back({ i, _states[i], state });
+        _states[i] = std::move(state);
+      }
+    }
+    if (entry.changes.empty())
+    {
+      return;
+    }
+  }
+  else
+  {
+    entry.checkpoint = _save_layout();
+    if (plots != _plots)
+    {
+      updateAllStates();
+    }
+    else
+    {
+      // i.e. the time offset changes the zoom of all the plots
+      for (int i = 0; i < int(plots.size()); i++)
+      {
+        _states[i] = currentState(i, plots[i] == modified_plot);
+      }
+    }
+  }
+  _redo_entries.clear();
+
+  if (merge)
+  {
+    Entry& last = _undo_entries.back();
+    if (!entry.isCheckpoint() && !last.isCheckpoint())
+    {
+      // keep the oldest "before" and the newest "after" of each plot
+      for (auto& change : entry.changes)
+      {
+        auto it = std::find_if(last.changes.begin(), last.changes.end(),
+                               [&](const PlotChange& c) { return c.index == change.index; });
+        if (it != last.changes.end())
+        {
+          it->after = std::move(change.after);
+        }
+        else
+        {
+          last.changes.push_back(std::move(change));
+        }
+      }
+      return;
+    }
+    // the new entry replaces the last one, then it must contain the full state
+    if (!entry.isCheckpoint())
+    {
+      entry.checkpoint = _save_layout();
+      entry.changes.clear();
+    }
+    _undo_entries.pop_back();
+  }
+  pushUndo(std::move(entry));
+}
+
+void UndoHistory::undo()
+{
+  if (_undo_entries.size() <= 1)
+  {
+    return;
+  }
+  Entry entry = std::move(_undo_entries.back());
+  _undo_entries.pop_back();
+
+  if (!entry.isCheckpoint())
+  {
+    for (auto it = entry.changes.rbegin(); it != entry.changes.rend(); it++)
+    {
+      applyState(it->index, it->before, it->after);
+    }
+  }
+  else
+  {
+    // load the previous checkpoint and replay the deltas that follow it
+    auto checkpoint_it = std::find_if(_undo_entries.rbegin(), _undo_entries.rend(),
+                                      [](const Entry& e) { return e.isCheckpoint(); });
+    _load_layout(checkpoint_it->checkpoint);
+    updateAllStates();
+
+    for (auto it = checkpoint_it.base(); it != _undo_entries.end(); it++)
+    {
+      for (const auto& change : it->changes)
+      {
+        applyState(change.index, change.after, change.before);
+      }
+    }
+  }
+
+  _deltas_since_checkpoint = 0;
+  for (auto it = _undo_entries.rbegin(); it != _undo_entries.rend() && !it->isCheckpoint(); it++)
+  {
+    _deltas_since_checkpoint++;
+  }
+
+  if (_redo_entries.size() >= MAX_ENTRIES)
+  {
+    _redo_entries.pop_front();
+  }
+  _redo_entries.push_back(std::move(entry));
+}
+
+void UndoHistory::redo()
+{
+  if (_redo_entries.empty())
+  {
+    return;
+  }
+  Entry entry = std::move(_redo_entries.back());
+  _redo_entries.pop_back();
+
+  if (!entry.isCheckpoint())
+  {
+    for (const auto& change : entry.changes)
+    {
+      applyState(change.index, change.after, change.before);
+    }
+  }
+  else
+  {
+    _load_layout(entry.checkpoint);
+    updateAllStates();
+  }
+  pushUndo(std::move(entry));
+}
+
+std::vector<PlotWidget*> UndoHistory::layoutPlots()
+{
+  std::vector<PlotWidget*> plots;
+  for (const auto& it : TabbedPlotWidget::instances())
+  {
+    QTabWidget* tabs = it.second->tabWidget();
+    for (int t = 0; t < tabs->count(); t++)
+    {
+      if (auto docker = dynamic_cast<PlotDocker*>(tabs->widget(t)))
+      {
+        auto docker_plots = docker->plotsInLayoutOrder();
+        plots.insert(plots.end(), docker_plots.begin(), docker_plots.end());
+      }
+    }
+  }
+  return plots;
+}
+
+UndoHistory::PlotState UndoHistory::currentState(int index, bool with_content) const
+{
+  PlotWidget* plot = _plots[index];
+  PlotState state;
+  state.rect = plot->currentBoundingRect();
+  if (!with_content)
+  {
+    state.content = _states[index].content;
+  }
+  else
+  {
+    QDomDocument doc;
+    QDomElement plot_el = plot->xmlSaveState(doc);
+    plot_el.removeChild(plot_el.firstChildElement("range"));
+    doc.appendChild(plot_el);
+    state.content = doc.toString(-1);
+  }
+  return state;
+}
+
+void UndoHistory::updateAllStates()
+{
+  _plots = layoutPlots();
+  _states.resize(_plots.size());
+  for (int i = 0; i < int(_plots.size()); i++)
+  {
+    _states[i] = currentState(i, true);
+  }
+}
+
+void UndoHistory::applyState(int index, const PlotState& state, const PlotState& previous)
+{
+  if (index >= int(_plots.size()))
+  {
+    return;
+  }
+  PlotWidget* plot = _plots[index];
+
+  if (state.content != previous.content)
+  {
+    QDomDocument doc;
+    doc.setContent(state.content);
+    QDomElement plot_el = doc.documentElement();
+
+    QDomElement range_el = doc.createElement("range");
+    range_el.setAttribute("bottom", QString::number(state.rect.bottom(), 'f', 6));
+    range_el.setAttribute("top", QString::number(state.rect.top(), 'f', 6));
+    range_el.setAttribute("left", QString::number(state.rect.left(), 'f', 6));
+    range_el.setAttribute("right", QString::number(state.rect.right(), 'f', 6));
+    plot_el.insertBefore(range_el, QDomNode());
+
+    plot->xmlLoadState(plot_el);
+  }
+  plot->setZoomRectangle(state.rect, false);
+  plot->replot();
+  _states[index] = state;
+}
+
+void UndoHistory::pushUndo(Entry&& entry)
+{
+  _deltas_since_checkpoint = entry.isCheckpoint() ? 0 : (_deltas_since_checkpoint + 1);
+  _undo_entries.push_back(std::move(entry));
+
+  if (_undo_entries.size() > MAX_ENTRIES)
+  {
+    // the first entry must be a checkpoint, the deltas that follow it depend on it
+    _undo_entries.pop_front();
+    while (!_undo_entries.empty() && !_undo_entries.front().isCheckpoint())
+    {
+      _undo_entries.pop_front();
+    }
+  }
+}
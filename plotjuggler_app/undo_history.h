@@ -0,0 +1,110 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UNDO_HISTORY_H
+#define UNDO_HISTORY_H
+
+#include <deque>
+#include <functional>
+#include <vector>
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <QRectF>
+
+class PlotWidget;
+
+/**
+ * Undo/redo history of the layout.
+ *
+ * Most of the changes (zoom, pan, curves added or removed, transforms, style) modify
+ * a single plot, or the zoom of the plots linked to it. They are recorded as deltas:
+ * the state of the modified plots before and after the change. Undo and redo apply
+ * them in place, to those plots only.
+ *
+ * The other changes (tabs added, closed or moved, splits, global options) are recorded
+ * as checkpoints: a full snapshot of the layout, as MainWindow::xmlSaveState().
+ * A checkpoint is also taken every CHECKPOINT_INTERVAL deltas, to limit the number of
+ * deltas replayed when a checkpoint is undone.
+ *
+ * A plot is identified by its position in the layout (see PlotDocker::plotsInLayoutOrder()),
+ * that is preserved when a checkpoint is loaded.
+ */
+class UndoHistory
+{
+public:
+  using SaveFunction = std::function<QDomDocument()>;
+  using LoadFunction = std::function<void(const QDomDocument&)>;
+
+  UndoHistory(SaveFunction save_layout, LoadFunction load_layout);
+
+  /// Forget the history. The next change will be a checkpoint.
+  void clear();
+
+  /// Forget the history and use "layout" as the initial state.
+  void reset(const QDomDocument& layout);
+
+  /// Record the current state. "modified_plot" is the plot that originated the change, if any.
+  void recordChange(PlotWidget* modified_plot);
+
+  void undo();
+
+  void redo();
+
+private:
+  struct PlotState
+  {
+    // XML of the plot, without the zoom range
+    QString content;
+    QRectF rect;
+  };
+
+  struct PlotChange
+  {
+    int index;
+    PlotState before;
+    PlotState after;
+  };
+
+  struct Entry
+  {
+    // null if this entry is a delta
+    QDomDocument checkpoint;
+    std::vector<PlotChange> changes;
+
+    bool isCheckpoint() const
+    {
+      return !checkpoint.isNull();
+    }
+  };
+
+  static constexpr size_t MAX_ENTRIES = 100;
+  static constexpr size_t CHECKPOINT_INTERVAL = 20;
+
+  SaveFunction _save_layout;
+  LoadFunction _load_layout;
+
+  std::deque<Entry> _undo_entries;
+  std::deque<Entry> _redo_entries;
+  QElapsedTimer _timer;
+  size_t _deltas_since_checkpoint = 0;
+
+  // plots at the time of the last change, and their state
+  std::vector<PlotWidget*> _plots;
+  std::vector<PlotState> _states;
+
+  static std::vector<PlotWidget*> layoutPlots();
+
+  // if "with_content" is false, the content is the one of the last change
+  PlotState currentState(int index, bool with_content) const;
+
+  void updateAllStates();
+
+  void applyState(int index, const PlotState& state, const PlotState& previous);
+
+  void pushUndo(Entry&& entry);
+};
+
+#endif  // UNDO_HISTORY_H
@@ -6,9 +6,11 @@
 
 #include "utils.h"
 #include <QDebug>
+#include "PlotJuggler/profiler.h"
 
 MoveDataRet MoveData(PlotDataMapRef& source, PlotDataMapRef& destination, bool remove_older)
 {
+  PJ_PROFILE_SCOPE("MoveData");
   MoveDataRet ret;
 
   auto moveDataImpl = [&](auto& source_series, auto& destination_series) {
@@ -74,6 +76,7 @@ MoveDataRet MoveData(PlotDataMapRef& source, PlotDataMapRef& destination, bool r
       if (source_plot.size() > 0)
       {
         ret.data_pushed = true;
+        ret.updated_curves.push_back(ID);
       }
 
       if constexpr (std::is_same_v<PlotData, decltype(source_plot)> ||
@@ -92,7 +95,16 @@ MoveDataRet MoveData(PlotDataMapRef& source, PlotDataMapRef& destination, bool r
       {
         for (size_t i = 0; i < source_plot.size(); i++)
         {
-          destination_plot.pushBack(source_plot.at(i));
+          if constexpr (std::is_same_v<StringSeries, std::decay_t<decltype(source_plot)>>)
+          {
+            // the ids of the strings are valid only in their own series
+            const auto& p = source_plot.at(i);
+            destination_plot.pushBack({ p.x, source_plot.string(p.y) });
+          }
+          else
+          {
+            destination_plot.pushBack(source_plot.at(i));
+          }
         }
         source_plot.clear();
       }
@@ -0,0 +1,82 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef PJ_BENCHMARK_H
+#define PJ_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace PJ::Benchmark
+{
+/// Measure the elapsed time, to exclude the preparation of the data from a run.
+class Stopwatch
+{
+public:
+  void start()
+  {
+    _start = std::chrono::steady_clock::now();
+  }
+
+  double elapsedSeconds() const
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point _start = std::chrono::steady_clock::now();
+};
+
+/// Shortest of "repetitions" runs of "function", that returns the seconds it measured.
+template <typename Function>
+double bestOf(int repetitions, Function&& function)
+{
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < repetitions; i++)
+  {
+    best = std::min(best, function());
+  }
+  return best;
+}
+
+/// Keep the compiler from removing the computation of "value".
+template <typename T>
+void doNotOptimize(const T& value)
+{
+#if defined(_MSC_VER)
+  // no inline assembly on x64: the address escapes through a volatile store instead
+  const void* volatile address = &value;
+  (void)address;
+  _ReadWriteBarrier();
+#else
+  asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+/// Print one line of results: total time and throughput.
+inline void report(const std::string& name, double items, double seconds)
+{
+  std::printf("%-44s %10.2f ms %14.0f points/s\n", name.c_str(), seconds * 1e3,
+              items / seconds);
+}
+
+/// The positional argument "index" of the command line, or "default_value".
+inline long argument(int argc, char** argv, int index, long default_value)
+{
+  return (index < argc) ? std::strtol(argv[index], nullptr, 10) : default_value;
+}
+
+}  // namespace PJ::Benchmark
+
+#endif  // PJ_BENCHMARK_H
@@ -0,0 +1,234 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+// Points per second appended to a series by a data loader: one at a time with
+// pushBack(), as before, or in bulk with appendSorted() and appendUnsorted().
+// The baseline is the pushBack() of the previous version of TimeseriesBase.
+//
+// Usage: bulk_append_benchmark [point_count]
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <random>
+#include <vector>
+#include "PlotJuggler/plotdata.h"
+#include "benchmark.h"
+
+using namespace PJ;
+
+namespace
+{
+// size of the chunks of the loaders, that append a column (or a message) at a time
+const size_t CHUNK_SIZE = 64 * 1024;
+
+struct Columns
+{
+  std::vector<double> x;
+  std::vector<double> y;
+};
+
+Columns makeColumns(size_t count, double nan_fraction, double swap_fraction)
+{
+  std::mt19937 generator(42);
+  std::bernoulli_distribution is_nan(nan_fraction);
+  std::bernoulli_distribution is_swapped(swap_fraction);
+  Columns columns;
+  columns.x.resize(count);
+  columns.y.resize(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    columns.x[i] = double(i) * 1e-3;
+    columns.y[i] = is_nan(generator) ? std::numeric_limits<double>::quiet_NaN() :
+                                       std::sin(double(i) * 1e-3);
+  }
+  for (size_t i = 1; i < count; i++)
+  {
+    if (is_swapped(generator))
+    {
+      std::swap(columns.x[i - 1], columns.x[i]);
+    }
+  }
+  return columns;
+}
+
+// TimeseriesBase<double>::pushBack() before the pending points: a late sample is
+// inserted in the deque at once, moving the points after it, and the points older than
+// the maximum range are removed one at a time
+class LegacySeries
+{
+public:
+  using Point = PlotData::Point;
+
+  void setMaximumRangeX(double range)
+  {
+    _max_range_x = range;
+  }
+
+  void pushBack(Point&& p)
+  {
+    if (std::isinf(p.x) || std::isnan(p.x) || std::isinf(p.y) || std::isnan(p.y))
+    {
+      return;
+    }
+    updateRange(p);
+    if (!_points.empty() && p.x < _points.back().x)
+    {
+      auto it = std::upper_bound(_points.begin(), _points.end(), p,
+                                 [](const Point& a, const Point& b) { return a.x < b.x; });
+      _points.insert(it, p);
+    }
+    else
+    {
+      _points.emplace_back(p);
+    }
+    trimRange();
+  }
+
+  size_t size() const
+  {
+    return _points.size();
+  }
+
+  double maxY() const
+  {
+    if (_range_y_dirty)
+    {
+      _range_y = { std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest() };
+      for (const auto& p : _points)
+      {
+        _range_y.min = std::min(_range_y.min, p.y);
+        _range_y.max = std::max(_range_y.max, p.y);
+      }
+      _range_y_dirty = false;
+    }
+    return _range_y.max;
+  }
+
+private:
+  std::deque<Point> _points;
+  double _max_range_x = std::numeric_limits<double>::max();
+  mutable Range _range_y;
+  mutable bool _range_y_dirty = true;
+
+  void updateRange(const Point& p)
+  {
+    if (_range_y_dirty)
+    {
+      return;
+    }
+    if (p.y > _range_y.max)
+    {
+      _range_y.max = p.y;
+    }
+    else if (p.y < _range_y.min)
+    {
+      _range_y.min = p.y;
+    }
+    else
+    {
+      _range_y_dirty = true;
+    }
+  }
+
+  void trimRange()
+  {
+    if (_max_range_x < std::numeric_limits<double>::max())
+    {
+      const double back_x = _points.back().x;
+      while (_points.size() > 2 && (back_x - _points.front().x) > _max_range_x)
+      {
+        const double front_y = _points.front().y;
+        if (!_range_y_dirty && (front_y == _range_y.max || front_y == _range_y.min))
+        {
+          _range_y_dirty = true;
+        }
+        _points.pop_front();
+      }
+    }
+  }
+};
+
+double runLegacyPushBack(const Columns& columns, double max_range)
+{
+  LegacySeries series;
+  series.setMaximumRangeX(max_range);
+  Benchmark::Stopwatch stopwatch;
+  for (size_t i = 0; i < columns.x.size(); i++)
+  {
+    series.pushBack({ columns.x[i], columns.y[i] });
+  }
+  Benchmark::doNotOptimize(series.size());
+  Benchmark::doNotOptimize(series.maxY());
+  return stopwatch.elapsedSeconds();
+}
+
+double runPushBack(const Columns& columns, double max_range)
+{
+  PlotData series("series", nullptr);
+  series.setMaximumRangeX(max_range);
+  Benchmark::Stopwatch stopwatch;
+  for (size_t i = 0; i < columns.x.size(); i++)
+  {
+    series.pushBack({ columns.x[i], columns.y[i] });
+  }
+  Benchmark::doNotOptimize(series.size());
+  Benchmark::doNotOptimize(series.rangeY()->max);
+  return stopwatch.elapsedSeconds();
+}
+
+template <typename Append>
+double runBulk(const Columns& columns, double max_range, Append append)
+{
+  PlotData series("series", nullptr);
+  series.setMaximumRangeX(max_range);
+  Benchmark::Stopwatch stopwatch;
+  for (size_t first = 0; first < columns.x.size(); first += CHUNK_SIZE)
+  {
+    const size_t count = std::min(CHUNK_SIZE, columns.x.size() - first);
+    append(series, columns.x.data() + first, columns.y.data() + first, count);
+  }
+  Benchmark::doNotOptimize(series.size());
+  Benchmark::doNotOptimize(series.rangeY()->max);
+  return stopwatch.elapsedSeconds();
+}
+
+void runCase(const std::string& name, const Columns& columns,
+             double max_range = std::numeric_limits<double>::max())
+{
+  const double points = double(columns.x.size());
+  auto sorted = [](PlotData& series, const double* x, const double* y, size_t count) {
+    series.appendSorted(x, y, count);
+  };
+  auto unsorted = [](PlotData& series, const double* x, const double* y, size_t count) {
+    series.appendUnsorted(x, y, count);
+  };
+
+  Benchmark::report(name + ", pushBack (previous)", points, Benchmark::bestOf(3, [&]() {
+                      return runLegacyPushBack(columns, max_range);
+                    }));
+  Benchmark::report(name + ", pushBack", points,
+                    Benchmark::bestOf(3, [&]() { return runPushBack(columns, max_range); }));
+  Benchmark::report(name + ", appendSorted", points,
+                    Benchmark::bestOf(3, [&]() { return runBulk(columns, max_range, sorted); }));
+  Benchmark::report(name + ", appendUnsorted", points,
+                    Benchmark::bestOf(3, [&]() { return runBulk(columns, max_range, unsorted); }));
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const size_t count = size_t(Benchmark::argument(argc, argv, 1, 10000000));
+
+  runCase("sorted", makeColumns(count, 0.0, 0.0));
+  runCase("sorted, 1% NaN", makeColumns(count, 0.01, 0.0));
+  runCase("0.1% swapped", makeColumns(count, 0.0, 0.001));
+  // the samples are 1 ms apart
+  runCase("sorted, 60 s buffer", makeColumns(count, 0.0, 0.0), 60.0);
+  return 0;
+}
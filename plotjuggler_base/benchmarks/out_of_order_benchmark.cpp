@@ -0,0 +1,140 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+// Insertion of samples that arrive late, with the jitter of real streams.
+// The series is read every FRAME_SEC of data, as PlotWidget does while streaming.
+//
+// Usage: out_of_order_benchmark [point_count]
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "PlotJuggler/plotdata.h"
+#include "benchmark.h"
+
+using namespace PJ;
+
+namespace
+{
+const double RATE_HZ = 1000;
+const double FRAME_SEC = 0.03;
+
+// samples in order of arrival
+std::vector<PlotData::Point> inOrder(size_t count)
+{
+  std::vector<PlotData::Point> points(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    points[i] = { double(i) / RATE_HZ, double(i % 100) };
+  }
+  return points;
+}
+
+// the timestamps are taken by the sender, with a gaussian delay of transmission
+std::vector<PlotData::Point> gaussianJitter(size_t count, double sigma_sec)
+{
+  std::mt19937 generator(42);
+  std::normal_distribution<double> delay(0.0, sigma_sec);
+  std::vector<std::pair<double, PlotData::Point>> arrivals(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    const double x = double(i) / RATE_HZ;
+    arrivals[i] = { x + std::abs(delay(generator)), { x, double(i % 100) } };
+  }
+  std::stable_sort(arrivals.begin(), arrivals.end(),
+                   [](const auto& a, const auto& b) { return a.first < b.first; });
+  std::vector<PlotData::Point> points(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    points[i] = arrivals[i].second;
+  }
+  return points;
+}
+
+// two senders merged into one series, the second one lagging behind the first
+std::vector<PlotData::Point> twoSenders(size_t count, double lag_sec)
+{
+  std::vector<PlotData::Point> points(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    const double x = double(i / 2) * 2.0 / RATE_HZ;
+    points[i] = (i % 2 == 0) ? PlotData::Point(x, 1.0) : PlotData::Point(x - lag_sec, 2.0);
+  }
+  return points;
+}
+
+// in order, but a fraction of the samples is delivered again much later (retries)
+std::vector<PlotData::Point> lateRetries(size_t count, double probability, double delay_sec)
+{
+  std::mt19937 generator(42);
+  std::bernoulli_distribution retried(probability);
+  std::vector<std::pair<double, PlotData::Point>> arrivals(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    const double x = double(i) / RATE_HZ;
+    arrivals[i] = { retried(generator) ? x + delay_sec : x, { x, double(i % 100) } };
+  }
+  std::stable_sort(arrivals.begin(), arrivals.end(),
+                   [](const auto& a, const auto& b) { return a.first < b.first; });
+  std::vector<PlotData::Point> points(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    points[i] = arrivals[i].second;
+  }
+  return points;
+}
+
+double runInsertion(const std::vector<PlotData::Point>& points, bool& sorted)
+{
+  PlotData series("series", nullptr);
+  const size_t samples_per_frame = size_t(FRAME_SEC * RATE_HZ);
+
+  Benchmark::Stopwatch stopwatch;
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    series.pushBack(points[i]);
+    if (i % samples_per_frame == 0)
+    {
+      Benchmark::doNotOptimize(series.size());
+    }
+  }
+  Benchmark::doNotOptimize(series.size());
+  const double elapsed = stopwatch.elapsedSeconds();
+
+  sorted = std::is_sorted(series.begin(), series.end(),
+                          [](const auto& a, const auto& b) { return a.x < b.x; });
+  return elapsed;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const size_t count = size_t(Benchmark::argument(argc, argv, 1, 5000000));
+
+  const std::pair<const char*, std::vector<PlotData::Point>> cases[] = {
+    { "in order", inOrder(count) },
+    { "gaussian jitter, sigma 2 ms", gaussianJitter(count, 0.002) },
+    { "gaussian jitter, sigma 50 ms", gaussianJitter(count, 0.05) },
+    { "two senders, lag 20 ms", twoSenders(count, 0.02) },
+    { "1% retried 5 s later", lateRetries(count, 0.01, 5.0) },
+  };
+
+  int result = 0;
+  for (const auto& [name, points] : cases)
+  {
+    bool sorted = true;
+    const double elapsed = Benchmark::bestOf(3, [&]() { return runInsertion(points, sorted); });
+    Benchmark::report(name, double(count), elapsed);
+    if (!sorted)
+    {
+      std::printf("ERROR: the series is not sorted\n");
+      result = 1;
+    }
+  }
+  return result;
+}
@@ -0,0 +1,109 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+// Steady state of the streaming: every series is full, with a buffer of WINDOW_SEC
+// seconds, and each new sample evicts an old one. The plots are refreshed every
+// FRAME_SEC, reading the range of every series, as PlotWidget does.
+//
+// Usage: streaming_window_benchmark [series_count] [seconds_of_data]
+
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "PlotJuggler/plotdata.h"
+#include "benchmark.h"
+
+using namespace PJ;
+
+namespace
+{
+const double RATE_HZ = 1000;
+const double WINDOW_SEC = 60;
+const double FRAME_SEC = 0.03;
+
+using Signal = std::function<double(size_t series, double t)>;
+
+double runStreaming(size_t series_count, double seconds, const Signal& signal)
+{
+  const double dt = 1.0 / RATE_HZ;
+  std::vector<std::unique_ptr<PlotData>> series;
+  for (size_t s = 0; s < series_count; s++)
+  {
+    series.push_back(std::make_unique<PlotData>("series_" + std::to_string(s), nullptr));
+    series.back()->setMaximumRangeX(WINDOW_SEC);
+  }
+
+  // fill the buffers, not measured
+  size_t sample = 0;
+  for (; double(sample) * dt <= WINDOW_SEC; sample++)
+  {
+    const double t = double(sample) * dt;
+    for (size_t s = 0; s < series_count; s++)
+    {
+      series[s]->pushBack({ t, signal(s, t) });
+    }
+  }
+
+  const size_t samples_per_frame = size_t(FRAME_SEC * RATE_HZ);
+  const size_t frames = size_t(seconds / FRAME_SEC);
+  double range_sum = 0;
+
+  Benchmark::Stopwatch stopwatch;
+  for (size_t frame = 0; frame < frames; frame++)
+  {
+    for (size_t s = 0; s < series_count; s++)
+    {
+      for (size_t i = 0; i < samples_per_frame; i++)
+      {
+        const double t = double(sample + i) * dt;
+        series[s]->pushBack({ t, signal(s, t) });
+      }
+    }
+    sample += samples_per_frame;
+
+    for (size_t s = 0; s < series_count; s++)
+    {
+      const auto range_x = series[s]->rangeX();
+      const auto range_y = series[s]->rangeY();
+      range_sum += (range_x->max - range_x->min) + (range_y->max - range_y->min);
+    }
+  }
+  const double elapsed = stopwatch.elapsedSeconds();
+  Benchmark::doNotOptimize(range_sum);
+  return elapsed;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const size_t series_count = size_t(Benchmark::argument(argc, argv, 1, 200));
+  const double seconds = double(Benchmark::argument(argc, argv, 2, 30));
+  const double points = std::floor(seconds / FRAME_SEC) * size_t(FRAME_SEC * RATE_HZ) *
+                        double(series_count);
+
+  std::printf("%zu series at %.0f Hz, window of %.0f s, %.0f s of data\n", series_count,
+              RATE_HZ, WINDOW_SEC, seconds);
+
+  // the extremes are evicted periodically
+  const Signal sine = [](size_t s, double t) { return std::sin(t * 0.5 + double(s)); };
+  // the minimum is evicted by every new sample
+  const Signal ramp = [](size_t s, double t) { return t + double(s); };
+  // a value of the window is often equal to the evicted extreme
+  const Signal steps = [](size_t s, double t) { return std::floor(t * 0.1) + double(s % 3); };
+
+  for (const auto& [name, signal] : { std::make_pair("sine", sine),
+                                      std::make_pair("ramp", ramp),
+                                      std::make_pair("steps", steps) })
+  {
+    const double elapsed =
+        Benchmark::bestOf(3, [&]() { return runStreaming(series_count, seconds, signal); });
+    Benchmark::report(std::string("streaming window, ") + name, points, elapsed);
+    std::printf("%-44s %10.2f ms per second of data\n", "", elapsed * 1e3 / seconds);
+  }
+  return 0;
+}
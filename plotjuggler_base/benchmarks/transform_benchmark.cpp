@@ -0,0 +1,202 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+// Points per second processed by a TransformFunction_SISO: the same transform
+// implemented with calculateNextPoint(), one virtual call and one lookup per point,
+// or with calculateBlock(). The series is transformed at once, as when a file is
+// loaded, and a few points at a time, as while streaming.
+//
+// Usage: transform_benchmark [point_count] [points_per_update]
+
+#include <cmath>
+#include <vector>
+#include "PlotJuggler/transform_function.h"
+#include "benchmark.h"
+
+using namespace PJ;
+
+namespace
+{
+// y' = 2 * y + 1, as the Scale/Offset transform
+class ScalePerPoint : public TransformFunction_SISO
+{
+public:
+  const char* name() const override
+  {
+    return "ScalePerPoint";
+  }
+
+  std::optional<PlotData::Point> calculateNextPoint(size_t index) override
+  {
+    const auto& p = dataSource()->at(index);
+    return PlotData::Point{ p.x, 2.0 * p.y + 1.0 };
+  }
+};
+
+class ScaleBlock : public TransformFunction_SISO
+{
+public:
+  const char* name() const override
+  {
+    return "ScaleBlock";
+  }
+
+  bool calculateBlock(const double* x, const double* y, size_t count, Output& output) override
+  {
+    output.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      output.x[i] = x[i];
+      output.y[i] = 2.0 * y[i] + 1.0;
+    }
+    return true;
+  }
+};
+
+// derivative of y, with the state of the previous sample, as the First Derivative
+class DerivativePerPoint : public TransformFunction_SISO
+{
+public:
+  const char* name() const override
+  {
+    return "DerivativePerPoint";
+  }
+
+  void reset() override
+  {
+    _has_previous = false;
+    TransformFunction_SISO::reset();
+  }
+
+  std::optional<PlotData::Point> calculateNextPoint(size_t index) override
+  {
+    const auto p = dataSource()->at(index);
+    if (!_has_previous)
+    {
+      _has_previous = true;
+      _previous = p;
+      return std::nullopt;
+    }
+    const PlotData::Point out = { _previous.x, (p.y - _previous.y) / (p.x - _previous.x) };
+    _previous = p;
+    return out;
+  }
+
+private:
+  bool _has_previous = false;
+  PlotData::Point _previous;
+};
+
+class DerivativeBlock : public TransformFunction_SISO
+{
+public:
+  const char* name() const override
+  {
+    return "DerivativeBlock";
+  }
+
+  void reset() override
+  {
+    _has_previous = false;
+    TransformFunction_SISO::reset();
+  }
+
+  bool calculateBlock(const double* x, const double* y, size_t count, Output& output) override
+  {
+    output.resize(count);
+    size_t out_count = 0;
+    if (_has_previous)
+    {
+      output.x[out_count] = _previous.x;
+      output.y[out_count++] = (y[0] - _previous.y) / (x[0] - _previous.x);
+    }
+    for (size_t i = 1; i < count; i++)
+    {
+      output.x[out_count] = x[i - 1];
+      output.y[out_count++] = (y[i] - y[i - 1]) / (x[i] - x[i - 1]);
+    }
+    output.resize(out_count);
+    _previous = { x[count - 1], y[count - 1] };
+    _has_previous = true;
+    return true;
+  }
+
+private:
+  bool _has_previous = false;
+  PlotData::Point _previous;
+};
+
+struct Samples
+{
+  std::vector<double> x;
+  std::vector<double> y;
+};
+
+Samples makeSamples(size_t count)
+{
+  Samples samples;
+  samples.x.resize(count);
+  samples.y.resize(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    samples.x[i] = double(i) * 1e-3;
+    samples.y[i] = std::sin(double(i) * 1e-3);
+  }
+  return samples;
+}
+
+// the source receives "points_per_update" samples before each call of calculate()
+template <typename Transform>
+double runTransform(const Samples& samples, size_t points_per_update)
+{
+  PlotData source("source", nullptr);
+  PlotData destination("destination", nullptr);
+  Transform transform;
+  std::vector<PlotData*> dst_vect = { &destination };
+  transform.setData(nullptr, { &source }, dst_vect);
+
+  double seconds = 0;
+  for (size_t first = 0; first < samples.x.size(); first += points_per_update)
+  {
+    const size_t count = std::min(points_per_update, samples.x.size() - first);
+    source.appendSorted(samples.x.data() + first, samples.y.data() + first, count);
+
+    Benchmark::Stopwatch stopwatch;
+    transform.calculate();
+    seconds += stopwatch.elapsedSeconds();
+  }
+  Benchmark::doNotOptimize(destination.size());
+  Benchmark::doNotOptimize(destination.back().y);
+  return seconds;
+}
+
+template <typename PerPoint, typename Block>
+void runCase(const std::string& name, const Samples& samples, size_t points_per_update)
+{
+  const double points = double(samples.x.size());
+  Benchmark::report(name + ", calculateNextPoint", points, Benchmark::bestOf(3, [&]() {
+                      return runTransform<PerPoint>(samples, points_per_update);
+                    }));
+  Benchmark::report(name + ", calculateBlock", points, Benchmark::bestOf(3, [&]() {
+                      return runTransform<Block>(samples, points_per_update);
+                    }));
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const size_t count = size_t(Benchmark::argument(argc, argv, 1, 2000000));
+  const size_t points_per_update = size_t(Benchmark::argument(argc, argv, 2, 100));
+  const Samples samples = makeSamples(count);
+
+  runCase<ScalePerPoint, ScaleBlock>("scale, whole series", samples, count);
+  runCase<ScalePerPoint, ScaleBlock>("scale, streaming", samples, points_per_update);
+  runCase<DerivativePerPoint, DerivativeBlock>("derivative, whole series", samples, count);
+  runCase<DerivativePerPoint, DerivativeBlock>("derivative, streaming", samples,
+                                               points_per_update);
+  return 0;
+}
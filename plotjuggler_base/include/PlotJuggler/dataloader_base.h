@@ -8,6 +8,9 @@
 #define DATALOAD_TEMPLATE_H
 
 #include <QFile>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 #include "PlotJuggler/plotdata.h"
 #include "PlotJuggler/pj_plugin.h"
@@ -43,6 +46,86 @@ public:
 
   virtual bool readDataFromFile(FileLoadInfo* fileload_info, PlotDataMapRef& destination) = 0;
 
+  /**
+   * @brief Override this to return true, if readDataFromFile() can be executed in a
+   * worker thread. In that case the main application calls:
+   *
+   * - prepareRead() in the GUI thread. Dialogs and message boxes must be shown here.
+   * - readDataFromFile() in a worker thread. It must not access the GUI, it must modify
+   *   destination only while holding mutex() and it should return as soon as possible
+   *   when isCancelled() is true.
+   *
+   * Meanwhile, the main application periodically moves the data already parsed out of
+   * destination (protected by mutex()), to display it while the rest of the file is loaded.
+   * Series that are moved are cleared, but never erased from destination.
+   */
+  virtual bool supportsBackgroundLoading() const
+  {
+    return false;
+  }
+
+  virtual bool prepareRead(FileLoadInfo* fileload_info, PlotDataMapRef& destination)
+  {
+    return true;
+  }
+
+  std::mutex& mutex()
+  {
+    return _mutex;
+  }
+
+  /**
+   * std::mutex is not fair: a worker thread that holds mutex() most of the time may
+   * starve the main application. Instead of releasing it periodically, the worker can
+   * call yieldLock() often, where destination is consistent: mutex() is released only
+   * while the main application, that locks it with requestLock(), is using it.
+   */
+  void yieldLock(std::unique_lock<std::mutex>& lock)
+  {
+    if (_lock_requested)
+    {
+      _lock_released.wait(lock, [this]() { return !_lock_requested; });
+    }
+  }
+
+  /// Lock mutex() in the main application, before the worker thread locks it again.
+  std::unique_lock<std::mutex> requestLock()
+  {
+    _lock_requested = true;
+    std::unique_lock<std::mutex> lock(_mutex);
+    _lock_requested = false;
+    _lock_released.notify_all();
+    return lock;
+  }
+
+  /// Progress of readDataFromFile(), in the range [0, 1]
+  void setProgress(double progress)
+  {
+    _progress = progress;
+  }
+
+  double progress() const
+  {
+    return _progress;
+  }
+
+  void cancel()
+  {
+    _cancelled = true;
+  }
+
+  bool isCancelled() const
+  {
+    return _cancelled;
+  }
+
+  /// Called by the main application before a new file is loaded.
+  void resetLoadingState()
+  {
+    _progress = 0;
+    _cancelled = false;
+  }
+
   void setParserFactories(ParserFactories* parsers)
   {
     _parser_factories = parsers;
@@ -55,6 +138,11 @@ public:
 
 private:
   ParserFactories* _parser_factories = nullptr;
+  std::mutex _mutex;
+  std::condition_variable _lock_released;
+  std::atomic_bool _lock_requested = false;
+  std::atomic<double> _progress = 0;
+  std::atomic_bool _cancelled = false;
 };
 
 using DataLoaderPtr = std::shared_ptr<DataLoader>;
@@ -62,7 +150,10 @@ using DataLoaderPtr = std::shared_ptr<DataLoader>;
 }  // namespace PJ
 
 QT_BEGIN_NAMESPACE
-#define DataRead_iid "facontidavide.PlotJuggler3.DataLoader"
+// Version 2 added the background loading, that changed the layout of DataLoader, and
+// stores the samples of StringSeries as interned StringId: the plugins built for the
+// previous version are not loaded.
+#define DataRead_iid "facontidavide.PlotJuggler3.DataLoader/2"
 Q_DECLARE_INTERFACE(PJ::DataLoader, DataRead_iid)
 QT_END_NAMESPACE
 
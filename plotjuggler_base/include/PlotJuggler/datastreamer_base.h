@@ -112,7 +112,9 @@ using DataStreamerPtr = std::shared_ptr<DataStreamer>;
 }  // namespace PJ
 
 QT_BEGIN_NAMESPACE
-#define DataStream_iid "facontidavide.PlotJuggler3.DataStreamer"
+// Version 2 stores the samples of StringSeries as interned StringId: the plugins built
+// for the previous version are not loaded.
+#define DataStream_iid "facontidavide.PlotJuggler3.DataStreamer/2"
 Q_DECLARE_INTERFACE(PJ::DataStreamer, DataStream_iid)
 QT_END_NAMESPACE
 
@@ -156,6 +156,8 @@ using ParserFactories = std::map<QString, std::shared_ptr<ParserFactoryPlugin>>;
 }  // namespace PJ
 
 QT_BEGIN_NAMESPACE
-#define ParserFactoryPlugin_iid "facontidavide.PlotJuggler3.ParserFactoryPlugin"
+// Version 2 stores the samples of StringSeries as interned StringId: the plugins built
+// for the previous version are not loaded.
+#define ParserFactoryPlugin_iid "facontidavide.PlotJuggler3.ParserFactoryPlugin/2"
 Q_DECLARE_INTERFACE(PJ::ParserFactoryPlugin, ParserFactoryPlugin_iid)
 QT_END_NAMESPACE
@@ -11,6 +11,7 @@
 #include "timeseries.h"
 #include "stringseries.h"
 #include <any>
+#include <unordered_set>
 
 namespace PJ
 {
@@ -78,6 +79,47 @@ struct PlotDataMapRef
   bool erase(const std::string& name);
 };
 
+/**
+ * @brief Index of the sample at a given X, searched once per PlotGroup.
+ *
+ * The series of a group usually come from the same message and share their timestamps:
+ * the index found for the first numeric series of a group is only verified, with
+ * TimeseriesBase::sharesIndex(), for the other members. Use one object per X.
+ */
+class GroupIndexCache
+{
+public:
+  explicit GroupIndexCache(double x) : _x(x)
+  {
+  }
+
+  /// Same result as series.getIndexFromX(x, hint).
+  template <typename Value>
+  int indexFromX(const TimeseriesBase<Value>& series, int hint = -1)
+  {
+    const PlotGroup* group = series.group().get();
+    if (!group)
+    {
+      return series.getIndexFromX(_x, hint);
+    }
+    auto it = _index.find(group);
+    if (it != _index.end() && series.sharesIndex(*it->second.first, it->second.second))
+    {
+      return it->second.second;
+    }
+    const int index = series.getIndexFromX(_x, hint);
+    if constexpr (std::is_same_v<Value, double>)
+    {
+      _index[group] = { &series, index };
+    }
+    return index;
+  }
+
+private:
+  double _x;
+  std::unordered_map<const PlotGroup*, std::pair<const PlotData*, int>> _index;
+};
+
 template <typename Value>
 inline void AddPrefixToPlotData(const std::string& prefix,
                                 std::unordered_map<std::string, Value>& data)
@@ -7,11 +7,13 @@
 #ifndef PJ_PLOTDATA_BASE_H
 #define PJ_PLOTDATA_BASE_H
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <deque>
 #include <type_traits>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <unordered_map>
 #include <optional>
@@ -154,8 +156,11 @@ public:
   PlotDataBase& operator=(const PlotDataBase& other) = delete;
   PlotDataBase& operator=(PlotDataBase&& other) = default;
 
+  // clear() is called first, to reset the state of the derived classes
   void clonePoints(const PlotDataBase& other)
   {
+    other.syncPoints();
+    clear();
     _points = other._points;
     _range_x = other._range_x;
     _range_y = other._range_y;
@@ -165,6 +170,8 @@ public:
 
   void clonePoints(PlotDataBase&& other)
   {
+    other.syncPoints();
+    clear();
     _points = std::move(other._points);
     _range_x = other._range_x;
     _range_y = other._range_y;
@@ -191,6 +198,7 @@ public:
 
   virtual size_t size() const
   {
+    syncPoints();
     return _points.size();
   }
 
@@ -201,11 +209,13 @@ public:
 
   const Point& at(size_t index) const
   {
+    syncPoints();
     return _points[index];
   }
 
   Point& at(size_t index)
   {
+    syncPoints();
     return _points[index];
   }
 
@@ -224,6 +234,19 @@ public:
     _points.clear();
     _range_x_dirty = true;
     _range_y_dirty = true;
+    _rewrite_count++;
+  }
+
+  /**
+   * Incremented by every change other than appending points at the back or removing
+   * them from the front, i.e. when the position of the points already stored may change.
+   * An index of the series, updated incrementally while streaming, must be rebuilt when
+   * it changes. The points modified through the non-const accessors are not counted.
+   */
+  uint64_t rewriteCount() const
+  {
+    syncPoints();
+    return _rewrite_count;
   }
 
   const Attributes& attributes() const
@@ -253,31 +276,37 @@ public:
 
   const Point& front() const
   {
+    syncPoints();
     return _points.front();
   }
 
   const Point& back() const
   {
+    syncPoints();
     return _points.back();
   }
 
   ConstIterator begin() const
   {
+    syncPoints();
     return _points.begin();
   }
 
   ConstIterator end() const
   {
+    syncPoints();
     return _points.end();
   }
 
   Iterator begin()
   {
+    syncPoints();
     return _points.begin();
   }
 
   Iterator end()
   {
+    syncPoints();
     return _points.end();
   }
 
@@ -286,6 +315,7 @@ public:
   {
     if constexpr (std::is_arithmetic_v<TypeX>)
     {
+      syncPoints();
       if (_points.empty())
       {
         return std::nullopt;
@@ -311,6 +341,7 @@ public:
   {
     if constexpr (std::is_arithmetic_v<Value>)
     {
+      syncPoints();
       if (_points.empty())
       {
         return std::nullopt;
@@ -339,45 +370,27 @@ public:
 
   virtual void pushBack(Point&& p)
   {
-    if constexpr (std::is_arithmetic_v<TypeX>)
-    {
-      if (std::isinf(p.x) || std::isnan(p.x))
-      {
-        return;  // skip
-      }
-      pushUpdateRangeX(p);
-    }
-    if constexpr (std::is_arithmetic_v<Value>)
+    if (!isValidPoint(p))
     {
-      if (std::isinf(p.y) || std::isnan(p.y))
-      {
-        return;  // skip
-      }
-      pushUpdateRangeY(p);
+      return;  // skip
     }
-
+    pushUpdateRangeX(p);
+    pushUpdateRangeY(p);
     _points.emplace_back(p);
   }
 
   virtual void insert(Iterator it, Point&& p)
   {
-    if constexpr (std::is_arithmetic_v<TypeX>)
+    if (!isValidPoint(p))
     {
-      if (std::isinf(p.x) || std::isnan(p.x))
-      {
-        return;  // skip
-      }
-      pushUpdateRangeX(p);
+      return;  // skip
     }
-    if constexpr (std::is_arithmetic_v<Value>)
+    pushUpdateRangeX(p);
+    pushUpdateRangeY(p);
+    if (it != _points.end())
     {
-      if (std::isinf(p.y) || std::isnan(p.y))
-      {
-        return;  // skip
-      }
-      pushUpdateRangeY(p);
+      _rewrite_count++;
     }
-
     _points.insert(it, p);
   }
 
@@ -403,6 +416,38 @@ public:
     _points.pop_front();
   }
 
+  /**
+   * Remove the first "count" points at once. Whole blocks of the storage are released,
+   * and the range is invalidated only if one of the removed points was on its boundary.
+   * As popFront(), it doesn't merge the pending points of the derived classes.
+   */
+  virtual void eraseFront(size_t count)
+  {
+    count = std::min(count, _points.size());
+    if (count == 0)
+    {
+      return;
+    }
+    const auto first = _points.begin();
+    const auto last = first + count;
+
+    if constexpr (std::is_arithmetic_v<TypeX>)
+    {
+      for (auto it = first; it != last && !_range_x_dirty; it++)
+      {
+        _range_x_dirty = (it->x == _range_x.max || it->x == _range_x.min);
+      }
+    }
+    if constexpr (std::is_arithmetic_v<Value>)
+    {
+      for (auto it = first; it != last && !_range_y_dirty; it++)
+      {
+        _range_y_dirty = (it->y == _range_y.max || it->y == _range_y.min);
+      }
+    }
+    _points.erase(first, last);
+  }
+
 protected:
   std::string _name;
   Attributes _attributes;
@@ -414,6 +459,49 @@ protected:
   mutable bool _range_y_dirty;
   mutable std::shared_ptr<PlotGroup> _group;
 
+  uint64_t _rewrite_count = 0;
+
+  // true when a derived class holds points that are not in _points yet
+  bool _has_pending_points = false;
+
+  // Move the pending points into _points. Called by the accessors before any read,
+  // therefore the pending points are never visible from outside.
+  virtual void mergePendingPoints()
+  {
+  }
+
+  // The object is logically const: the content of the series doesn't change, but the
+  // pending points are moved into _points. Therefore, even the const methods are NOT
+  // thread-safe: a series that is read by several threads at the same time must be
+  // synchronized first, by calling size(), from the thread that writes it.
+  void syncPoints() const
+  {
+    if (_has_pending_points)
+    {
+      const_cast<PlotDataBase*>(this)->mergePendingPoints();
+    }
+  }
+
+  // points with infinite or NaN coordinates are not stored
+  static bool isValidPoint(const Point& p)
+  {
+    if constexpr (std::is_arithmetic_v<TypeX>)
+    {
+      if (std::isinf(p.x) || std::isnan(p.x))
+      {
+        return false;
+      }
+    }
+    if constexpr (std::is_arithmetic_v<Value>)
+    {
+      if (std::isinf(p.y) || std::isnan(p.y))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
   // template specialization for types that support compare operator
   virtual void pushUpdateRangeX(const Point& p)
   {
@@ -425,20 +513,11 @@ protected:
         _range_x.min = p.x;
         _range_x.max = p.x;
       }
-      if (!_range_x_dirty)
+      else if (!_range_x_dirty)
       {
-        if (p.x > _range_x.max)
-        {
-          _range_x.max = p.x;
-        }
-        else if (p.x < _range_x.min)
-        {
-          _range_x.min = p.x;
-        }
-        else
-        {
-          _range_x_dirty = true;
-        }
+        // a point inside the current range doesn't change it
+        _range_x.min = std::min(_range_x.min, p.x);
+        _range_x.max = std::max(_range_x.max, p.x);
       }
     }
   }
@@ -448,20 +527,16 @@ protected:
   {
     if constexpr (std::is_arithmetic_v<Value>)
     {
-      if (!_range_y_dirty)
+      if (_points.empty())
       {
-        if (p.y > _range_y.max)
-        {
-          _range_y.max = p.y;
-        }
-        else if (p.y < _range_y.min)
-        {
-          _range_y.min = p.y;
-        }
-        else
-        {
-          _range_y_dirty = true;
-        }
+        _range_y_dirty = false;
+        _range_y.min = p.y;
+        _range_y.max = p.y;
+      }
+      else if (!_range_y_dirty)
+      {
+        _range_y.min = std::min(_range_y.min, p.y);
+        _range_y.max = std::max(_range_y.max, p.y);
       }
     }
   }
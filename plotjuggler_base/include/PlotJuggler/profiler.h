@@ -0,0 +1,193 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef PJ_PROFILER_H
+#define PJ_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace PJ
+{
+/**
+ * @brief Timers and counters of the hot paths of the application and of the plugins.
+ *
+ * A Scope is a named place of the code; ScopedTimer (or PJ_PROFILE_SCOPE) measures how
+ * long it takes each time it is executed. The last WINDOW durations of each scope are kept,
+ * to compute their percentiles, and optionally all of them are recorded as trace events,
+ * that can be exported in the Chrome trace event format.
+ *
+ * While disabled (default), a ScopedTimer costs a relaxed atomic load.
+ */
+class Profiler
+{
+public:
+  static constexpr size_t WINDOW = 1024;
+  // when reached, the recording of the trace stops
+  static constexpr size_t MAX_TRACE_EVENTS = 1000000;
+
+  struct Scope
+  {
+    explicit Scope(const std::string& scope_name) : name(scope_name)
+    {
+    }
+    const std::string name;
+
+    std::mutex mutex;
+    uint64_t calls = 0;
+    uint64_t items = 0;
+    int64_t total_ns = 0;
+    // circular buffer of the last durations
+    std::array<int64_t, WINDOW> durations_ns;
+    size_t next = 0;
+  };
+
+  struct Statistics
+  {
+    std::string name;
+    uint64_t calls = 0;
+    uint64_t items = 0;
+    double total_ms = 0;
+    // of the last WINDOW calls
+    double mean_ms = 0;
+    double p50_ms = 0;
+    double p95_ms = 0;
+    double p99_ms = 0;
+    double max_ms = 0;
+  };
+
+  /// The profiler shared by the application and the plugins. The first call must be
+  /// done by the main thread, before the plugins are loaded.
+  static Profiler& instance();
+
+  /// Nanoseconds of a steady clock.
+  static int64_t now()
+  {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+  }
+
+  bool isEnabled() const
+  {
+    return _enabled.load(std::memory_order_relaxed);
+  }
+
+  void setEnabled(bool enabled);
+
+  bool isTracing() const
+  {
+    return _tracing.load(std::memory_order_relaxed);
+  }
+
+  /// Start (clearing the previous events) or stop recording the trace events.
+  void setTracing(bool tracing);
+
+  size_t traceEventCount() const;
+
+  /// Scope with the given name, created if needed. The pointer is valid until the end of
+  /// the program: it can be stored in a static variable.
+  Scope* scope(const std::string& name);
+
+  void record(Scope* scope, int64_t start_ns, int64_t end_ns, uint64_t items = 0);
+
+  /// Forget the durations measured and the trace events.
+  void reset();
+
+  /// Statistics of the scopes executed at least once, sorted by name.
+  std::vector<Statistics> statistics() const;
+
+  /// The trace events recorded, in the Chrome trace event format (JSON), that can be
+  /// opened by chrome://tracing or https://ui.perfetto.dev
+  void writeChromeTrace(std::ostream& out) const;
+
+private:
+  Profiler() = default;
+
+  struct TraceEvent
+  {
+    const Scope* scope;
+    int64_t start_ns;
+    int64_t duration_ns;
+    int thread;
+  };
+
+  std::atomic_bool _enabled = false;
+  std::atomic_bool _tracing = false;
+
+  mutable std::mutex _scopes_mutex;
+  std::vector<std::unique_ptr<Scope>> _scopes;
+  std::unordered_map<std::string, Scope*> _scopes_by_name;
+
+  mutable std::mutex _trace_mutex;
+  std::vector<TraceEvent> _trace;
+  int64_t _trace_start_ns = 0;
+
+  // the threads are numbered in the order they record their first event
+  std::unordered_map<size_t, int> _threads;
+
+  int threadNumber();
+};
+
+/**
+ * @brief Measure the lifetime of the object, if the profiler is enabled.
+ * "scope" can be nullptr: nothing is measured.
+ */
+class ScopedTimer
+{
+public:
+  explicit ScopedTimer(Profiler::Scope* scope)
+    : _scope(Profiler::instance().isEnabled() ? scope : nullptr)
+  {
+    if (_scope)
+    {
+      _start_ns = Profiler::now();
+    }
+  }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  ~ScopedTimer()
+  {
+    if (_scope)
+    {
+      Profiler::instance().record(_scope, _start_ns, Profiler::now(), _items);
+    }
+  }
+
+  /// Number of elements processed (messages, samples...), shown with the statistics.
+  void addItems(uint64_t count)
+  {
+    _items += count;
+  }
+
+private:
+  Profiler::Scope* _scope;
+  int64_t _start_ns = 0;
+  uint64_t _items = 0;
+};
+
+}  // namespace PJ
+
+#define PJ_PROFILE_CONCAT_IMPL(a, b) a##b
+#define PJ_PROFILE_CONCAT(a, b) PJ_PROFILE_CONCAT_IMPL(a, b)
+
+/// Measure the rest of the enclosing block. "name" must be the same every time.
+#define PJ_PROFILE_SCOPE(name)                                                                    \
+  static PJ::Profiler::Scope* PJ_PROFILE_CONCAT(pj_profile_scope_, __LINE__) =                    \
+      PJ::Profiler::instance().scope(name);                                                       \
+  PJ::ScopedTimer PJ_PROFILE_CONCAT(pj_profile_timer_, __LINE__)(                                 \
+      PJ_PROFILE_CONCAT(pj_profile_scope_, __LINE__))
+
+#endif  // PJ_PROFILER_H
@@ -57,7 +57,9 @@ using StatePublisherPtr = std::shared_ptr<StatePublisher>;
 }  // namespace PJ
 
 QT_BEGIN_NAMESPACE
-#define StatePublisher_iid "facontidavide.PlotJuggler3.StatePublisher"
+// Version 2 stores the samples of StringSeries as interned StringId: the plugins built
+// for the previous version are not loaded.
+#define StatePublisher_iid "facontidavide.PlotJuggler3.StatePublisher/2"
 Q_DECLARE_INTERFACE(PJ::StatePublisher, StatePublisher_iid)
 QT_END_NAMESPACE
 
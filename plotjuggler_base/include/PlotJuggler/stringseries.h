@@ -10,17 +10,44 @@
 #include "PlotJuggler/timeseries.h"
 #include "PlotJuggler/string_ref_sso.h"
 #include <algorithm>
-#include <unordered_set>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace PJ
 {
-class StringSeries : public TimeseriesBase<StringRef>
+/// Identifier of a string interned by a StringSeries. Valid only for that series.
+struct StringId
+{
+  uint32_t id = 0;
+};
+
+/**
+ * Time series of strings.
+ *
+ * The strings are interned in an arena: each distinct string is stored once, with a
+ * 32-bit ID and a reference count, and the samples are (x, StringId) pairs.
+ * A string is released when the last sample that refers to it is removed,
+ * for instance when the buffer of the streaming is trimmed.
+ *
+ * Use string() or stringAt() to read the string of a sample.
+ */
+class StringSeries : public TimeseriesBase<StringId>
 {
 public:
-  using TimeseriesBase<StringRef>::_points;
+  using TimeseriesBase<StringId>::_points;
+
+  /// A sample, as stored: at() returns this type.
+  using Sample = TimeseriesBase<StringId>::Point;
+
+  /// A point with its string, as received by pushBack().
+  using Point = PlotDataBase<double, StringRef>::Point;
 
   StringSeries(const std::string& name, PlotGroup::Ptr group)
-    : TimeseriesBase<StringRef>(name, group)
+    : TimeseriesBase<StringId>(name, group)
   {
   }
 
@@ -32,17 +59,13 @@ public:
 
   virtual void clear() override
   {
-    _storage.clear();
-    TimeseriesBase<StringRef>::clear();
-  }
-
-  void pushBack(const Point& p) override
-  {
-    auto temp = p;
-    pushBack(std::move(temp));
+    _index.clear();
+    _arena.clear();
+    _free_ids.clear();
+    TimeseriesBase<StringId>::clear();
   }
 
-  virtual void pushBack(Point&& p) override
+  void pushBack(const Point& p)
   {
     const auto& str = p.y;
     // do not add empty strings
@@ -50,29 +73,149 @@ public:
     {
       return;
     }
-    if (str.isSSO())
+    Sample sample(p.x, {});
+    if (!isValidPoint(sample))
     {
-      // the object stored the string already, just push it
-      TimeseriesBase<StringRef>::pushBack(std::move(p));
+      return;
     }
-    else
-    {
-      // save a copy of the string in the flywheel structure _storage
-      // create a reference to that cached value.
-      _tmp_str.assign(str.data(), str.size());
+    sample.y = intern(str.data(), str.size());
+    TimeseriesBase<StringId>::pushBack(std::move(sample));
+  }
 
-      auto it = _storage.find(_tmp_str);
-      if (it == _storage.end())
+  /// The strings of "other" are interned again in this series.
+  void clonePoints(const StringSeries& other)
+  {
+    // clear() + copy of the samples, that still have the ids of "other"
+    PlotDataBase<double, StringId>::clonePoints(other);
+    std::vector<StringId> new_ids(other._arena.size());
+    std::vector<bool> interned(other._arena.size(), false);
+    for (auto& sample : _points)
+    {
+      const uint32_t id = sample.y.id;
+      if (!interned[id])
       {
-        it = _storage.insert(_tmp_str).first;
+        const auto& str = other._arena[id];
+        new_ids[id] = intern(str.data(), str.size);
+        interned[id] = true;
       }
-      TimeseriesBase<StringRef>::pushBack({ p.x, StringRef(*it) });
+      else
+      {
+        _arena[new_ids[id].id].ref_count++;
+      }
+      sample.y = new_ids[id];
     }
   }
 
+  /// The arena is moved together with the samples: the ids don't change.
+  void clonePoints(StringSeries&& other)
+  {
+    PlotDataBase<double, StringId>::clonePoints(std::move(other));
+    _index = std::move(other._index);
+    _arena = std::move(other._arena);
+    _free_ids = std::move(other._free_ids);
+    other.clear();
+  }
+
+  virtual void popFront() override
+  {
+    release(_points.front().y);
+    TimeseriesBase<StringId>::popFront();
+  }
+
+  virtual void eraseFront(size_t count) override
+  {
+    count = std::min(count, _points.size());
+    for (size_t i = 0; i < count; i++)
+    {
+      release(_points[i].y);
+    }
+    TimeseriesBase<StringId>::eraseFront(count);
+  }
+
+  /// The string of a sample of this series. Valid until the sample is removed.
+  StringRef string(StringId id) const
+  {
+    const auto& str = _arena[id.id];
+    return StringRef(str.data(), str.size);
+  }
+
+  StringRef stringAt(size_t index) const
+  {
+    return string(at(index).y);
+  }
+
+  std::optional<StringRef> getYfromX(double x) const
+  {
+    int index = getIndexFromX(x);
+    return (index < 0) ? std::nullopt : std::optional(string(_points[index].y));
+  }
+
+  /// Number of distinct strings currently stored.
+  size_t internedCount() const
+  {
+    return _index.size();
+  }
+
 private:
-  std::string _tmp_str;
-  std::unordered_set<std::string> _storage;
+  struct InternedString
+  {
+    // allocated on the heap: the keys of _index point to it
+    std::unique_ptr<char[]> buffer;
+    uint32_t size = 0;
+    uint32_t ref_count = 0;
+
+    const char* data() const
+    {
+      return buffer.get();
+    }
+  };
+
+  // key points to InternedString::data()
+  std::unordered_map<std::string_view, uint32_t> _index;
+  std::vector<InternedString> _arena;
+  std::vector<uint32_t> _free_ids;
+
+  StringId intern(const char* data, size_t size)
+  {
+    uint32_t id;
+    auto it = _index.find(std::string_view(data, size));
+    if (it != _index.end())
+    {
+      id = it->second;
+    }
+    else
+    {
+      if (_free_ids.empty())
+      {
+        id = static_cast<uint32_t>(_arena.size());
+        _arena.emplace_back();
+      }
+      else
+      {
+        id = _free_ids.back();
+        _free_ids.pop_back();
+      }
+      auto& interned = _arena[id];
+      interned.buffer.reset(new char[size]);
+      memcpy(interned.buffer.get(), data, size);
+      interned.size = static_cast<uint32_t>(size);
+      _index.emplace(std::string_view(interned.data(), size), id);
+    }
+    _arena[id].ref_count++;
+    return { id };
+  }
+
+  void release(StringId id)
+  {
+    auto& interned = _arena[id.id];
+    if (--interned.ref_count == 0)
+    {
+      _index.erase(std::string_view(interned.data(), interned.size));
+      interned.buffer.reset();
+      interned.size = 0;
+      _free_ids.push_back(id.id);
+    }
+  }
 };
 
 }  // namespace PJ
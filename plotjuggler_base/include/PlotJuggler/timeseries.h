@@ -9,6 +9,11 @@
 
 #include "plotdatabase.h"
 #include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <vector>
 
 namespace PJ
 {
@@ -18,6 +23,8 @@ class TimeseriesBase : public PlotDataBase<double, Value>
 protected:
   double _max_range_x;
   using PlotDataBase<double, Value>::_points;
+  using PlotDataBase<double, Value>::_range_y;
+  using PlotDataBase<double, Value>::_range_y_dirty;
 
 public:
   using Point = typename PlotDataBase<double, Value>::Point;
@@ -49,8 +56,43 @@ public:
     return _max_range_x;
   }
 
+  /**
+   * Samples that arrive late are collected, in order of arrival, and merged into the
+   * series before the next read. While they are late by less than this interval of X,
+   * they are also merged in batches; older samples are merged only when read (or when
+   * too many are pending). Either way, the readers always see a sorted series, where
+   * equal X keep their order of arrival.
+   */
+  void setReorderHorizon(double horizon)
+  {
+    _reorder_horizon = horizon;
+  }
+
+  double reorderHorizon() const
+  {
+    return _reorder_horizon;
+  }
+
   int getIndexFromX(double x) const;
 
+  /**
+   * Same result as getIndexFromX(x), but the search starts from the index "hint"
+   * (usually, the previous result) and expands exponentially.
+   * The cost is O(log distance), i.e. O(1) when x moves by small steps,
+   * as the tracker during playback. Any hint is valid, even an outdated one.
+   */
+  int getIndexFromX(double x, int hint) const;
+
+  /**
+   * True if getIndexFromX() returns "index" for any X for which it returned "index"
+   * when called on "other". O(1): it checks that the series have the same size and
+   * the same X around "index".
+   * Series parsed from the same message share their timestamps: the index can be
+   * searched once per group, and only verified for the other members.
+   */
+  template <typename OtherValue>
+  bool sharesIndex(const TimeseriesBase<OtherValue>& other, int index) const;
+
   std::optional<Value> getYfromX(double x) const
   {
     int index = getIndexFromX(x);
@@ -65,38 +107,311 @@ public:
 
   void pushBack(Point&& p) override
   {
-    bool need_sorting = (!_points.empty() && p.x < this->back().x);
+    if (!_points.empty() && p.x < _points.back().x)
+    {
+      // late sample: inserting it now would move the points after it
+      if (!this->isValidPoint(p))
+      {
+        return;
+      }
+      this->_has_pending_points = true;
+      if (_points.back().x - p.x <= _reorder_horizon)
+      {
+        _pending_near++;
+      }
+      _pending_points.push_back(std::move(p));
+      if (_pending_near >= REORDER_BATCH_SIZE || _pending_points.size() >= MAX_PENDING_SIZE)
+      {
+        this->syncPoints();
+      }
+      return;
+    }
 
-    if (need_sorting)
+    PlotDataBase<double, Value>::pushBack(std::move(p));
+    trimRange();
+  }
+
+  /**
+   * Append "count" points, with X sorted in ascending order, much faster than calling
+   * pushBack() for each of them: validity, order and range are checked in a single
+   * branch-free pass, the storage is allocated once, and the buffer is trimmed once.
+   * Points with NaN or infinite coordinates are skipped, as in pushBack().
+   * If X turns out not to be sorted, or older than the last point, it falls back to
+   * appendUnsorted(). Only for numeric values.
+   */
+  void appendSorted(const double* x, const Value* y, size_t count);
+
+  /// As appendSorted(), but X may be in any order. Equal X keep their order.
+  void appendUnsorted(const double* x, const Value* y, size_t count);
+
+  void popFront() override
+  {
+    blocksEraseFront(1);
+    PlotDataBase<double, Value>::popFront();
+  }
+
+  void eraseFront(size_t count) override
+  {
+    count = std::min(count, _points.size());
+    blocksEraseFront(count);
+    PlotDataBase<double, Value>::eraseFront(count);
+  }
+
+  void clear() override
+  {
+    _pending_points.clear();
+    _pending_near = 0;
+    this->_has_pending_points = false;
+    blocksReset();
+    PlotDataBase<double, Value>::clear();
+  }
+
+  /// O(1): the points are sorted by X.
+  RangeOpt rangeX() const override
+  {
+    this->syncPoints();
+    if (_points.empty())
     {
-      auto it = std::upper_bound(_points.begin(), _points.end(), p,
-                                 [](const auto& a, const auto& b) { return a.x < b.x; });
-      PlotDataBase<double, Value>::insert(it, std::move(p));
+      return std::nullopt;
     }
-    else
+    return Range{ _points.front().x, _points.back().x };
+  }
+
+  /// When the cached range is invalidated by the removal of its minimum or maximum,
+  /// it is computed again from the summaries of the blocks, not from every point.
+  RangeOpt rangeY() const override
+  {
+    if constexpr (std::is_arithmetic_v<Value>)
     {
-      PlotDataBase<double, Value>::pushBack(std::move(p));
+      this->syncPoints();
+      if (_points.empty())
+      {
+        return std::nullopt;
+      }
+      if (_range_y_dirty)
+      {
+        _range_y = rangeFromBlocks();
+        _range_y_dirty = false;
+      }
+      return _range_y;
     }
+    return std::nullopt;
+  }
+
+protected:
+  void mergePendingPoints() override
+  {
+    this->_has_pending_points = false;
+    _pending_near = 0;
+    mergeRun(_pending_points);
+    // the late samples may be older than the window of the streaming
     trimRange();
   }
 
 private:
-  void trimRange()
+  static constexpr size_t REORDER_BATCH_SIZE = 256;
+  static constexpr size_t MAX_PENDING_SIZE = 16 * 1024;
+
+  double _reorder_horizon = 1.0;
+  // late samples in order of arrival, and how many of them are within _reorder_horizon
+  std::vector<Point> _pending_points;
+  size_t _pending_near = 0;
+
+  // Merge the late samples with a single backward pass over the points that follow
+  // the oldest one. Equal X keep the order of arrival, as if inserted one by one.
+  void mergeRun(std::vector<Point>& run)
   {
-    if (_max_range_x < std::numeric_limits<double>::max() && !_points.empty())
+    if (run.empty())
+    {
+      return;
+    }
+    std::stable_sort(run.begin(), run.end(), TimeCompare);
+    if (_points.empty())
+    {
+      for (auto& p : run)
+      {
+        this->pushUpdateRangeX(p);
+        this->pushUpdateRangeY(p);
+        _points.push_back(std::move(p));
+      }
+      run.clear();
+      return;
+    }
+    if (TimeCompare(run.front(), _points.back()))
+    {
+      this->_rewrite_count++;
+    }
+    for (const auto& p : run)
     {
-      auto const back_point_x = _points.back().x;
-      while (_points.size() > 2 && (back_point_x - _points.front().x) > _max_range_x)
+      this->pushUpdateRangeX(p);
+      this->pushUpdateRangeY(p);
+    }
+    size_t read = _points.size();
+    size_t write = read + run.size();
+    _points.resize(write);
+
+    // the free space at the end is filled with the largest remaining point
+    size_t late = run.size();
+    while (late > 0)
+    {
+      if (read > 0 && TimeCompare(run[late - 1], _points[read - 1]))
       {
-        this->popFront();
+        _points[--write] = std::move(_points[--read]);
       }
+      else
+      {
+        _points[--write] = std::move(run[--late]);
+      }
+    }
+    run.clear();
+
+    blocksTruncate(write);
+  }
+
+  // Range of Y of each block of BLOCK_SIZE consecutive points. Points are numbered in
+  // order of arrival: the block of a point is (sequence_number / BLOCK_SIZE), and the
+  // summary of a block is dropped together with its last point.
+  // The first block may contain points already removed: those are scanned again.
+  // The summaries describe only the first _blocks_count points: the others are added
+  // on demand, by rangeFromBlocks(), i.e. only when the cached range is invalidated.
+  static constexpr uint64_t BLOCK_SIZE = 256;
+
+  mutable std::deque<Range> _blocks;
+  mutable uint64_t _first_block = 0;  // block number of _blocks.front()
+  mutable uint64_t _front_seq = 0;    // sequence number of _points.front()
+  mutable size_t _blocks_count = 0;   // number of points described by _blocks
+
+  void blocksReset() const
+  {
+    _blocks.clear();
+    _first_block = 0;
+    _front_seq = 0;
+    _blocks_count = 0;
+  }
+
+  void blocksPushBack(double y) const
+  {
+    const uint64_t block = (_front_seq + _blocks_count) / BLOCK_SIZE;
+    if (_blocks.empty())
+    {
+      _first_block = block;
+    }
+    if (block >= _first_block + _blocks.size())
+    {
+      _blocks.push_back({ y, y });
+    }
+    else
+    {
+      Range& range = _blocks.back();
+      range.min = std::min(range.min, y);
+      range.max = std::max(range.max, y);
+    }
+    _blocks_count++;
+  }
+
+  // the points from "index" onward changed
+  void blocksTruncate(size_t index)
+  {
+    if (index >= _blocks_count)
+    {
+      return;
+    }
+    const uint64_t block = (_front_seq + index) / BLOCK_SIZE;
+    if (block <= _first_block)
+    {
+      blocksReset();
+      return;
+    }
+    _blocks.resize(block - _first_block);
+    _blocks_count = block * BLOCK_SIZE - _front_seq;
+  }
+
+  void blocksEraseFront(size_t count)
+  {
+    if (count >= _blocks_count)
+    {
+      blocksReset();
+      return;
+    }
+    _front_seq += count;
+    _blocks_count -= count;
+    while (!_blocks.empty() && (_first_block + 1) * BLOCK_SIZE <= _front_seq)
+    {
+      _blocks.pop_front();
+      _first_block++;
+    }
+  }
+
+  Range rangeFromBlocks() const
+  {
+    if (_blocks_count > _points.size())
+    {
+      blocksReset();
+    }
+    for (size_t i = _blocks_count; i < _points.size(); i++)
+    {
+      blocksPushBack(_points[i].y);
+    }
+    Range range = { _points.front().y, _points.front().y };
+
+    const size_t first_block_end =
+        std::min<size_t>(_points.size(), (_first_block + 1) * BLOCK_SIZE - _front_seq);
+    for (size_t i = 0; i < first_block_end; i++)
+    {
+      range.min = std::min<double>(range.min, _points[i].y);
+      range.max = std::max<double>(range.max, _points[i].y);
+    }
+    for (size_t b = 1; b < _blocks.size(); b++)
+    {
+      range.min = std::min(range.min, _blocks[b].min);
+      range.max = std::max(range.max, _blocks[b].max);
     }
+    return range;
+  }
+
+  void trimRange()
+  {
+    if (_max_range_x == std::numeric_limits<double>::max() || _points.size() <= 2)
+    {
+      return;
+    }
+    const double back_point_x = _points.back().x;
+    auto is_old = [&](const Point& p) { return (back_point_x - p.x) > _max_range_x; };
+    if (!is_old(_points.front()))
+    {
+      return;
+    }
+    // while streaming, usually only the first point is old: the binary search and the
+    // erase of a range cost much more than popFront() on a deque
+    if (_points.size() == 3 || !is_old(_points[1]))
+    {
+      this->popFront();
+      return;
+    }
+    // the points are sorted by X: binary search of the first one to keep,
+    // but the last two are always kept
+    auto cut = std::partition_point(_points.begin() + 2, _points.end() - 2, is_old);
+    this->eraseFront(std::distance(_points.begin(), cut));
   }
 
   static bool TimeCompare(const Point& a, const Point& b)
   {
     return a.x < b.x;
   }
+
+  // index of the point closest to x, given the first point that is not smaller than x
+  int nearestIndex(double x, size_t lower) const
+  {
+    if (lower >= _points.size())
+    {
+      return _points.size() - 1;
+    }
+    if (lower > 0 && (abs(_points[lower - 1].x - x) < abs(_points[lower].x - x)))
+    {
+      return lower - 1;
+    }
+    return lower;
+  }
 };
 
 //--------------------
@@ -104,27 +419,179 @@ private:
 template <typename Value>
 inline int TimeseriesBase<Value>::getIndexFromX(double x) const
 {
+  this->syncPoints();
   if (_points.size() == 0)
   {
     return -1;
   }
   auto lower = std::lower_bound(_points.begin(), _points.end(), Point(x, {}), TimeCompare);
-  auto index = std::distance(_points.begin(), lower);
+  return nearestIndex(x, std::distance(_points.begin(), lower));
+}
+
+template <typename Value>
+inline int TimeseriesBase<Value>::getIndexFromX(double x, int hint) const
+{
+  this->syncPoints();
+  const size_t size = _points.size();
+  if (hint < 0 || size_t(hint) >= size)
+  {
+    return getIndexFromX(x);
+  }
+  const size_t start = hint;
+  // find the range [lo, hi] that contains the first point not smaller than x
+  size_t lo = 0;
+  size_t hi = 0;
+  size_t step = 1;
+
+  if (_points[start].x < x)
+  {
+    lo = start + 1;
+    hi = lo;
+    while (hi < size && _points[hi].x < x)
+    {
+      lo = hi + 1;
+      step *= 2;
+      hi = start + step;
+    }
+    hi = std::min(hi, size);
+  }
+  else
+  {
+    hi = start;
+    while (hi > 0)
+    {
+      const size_t probe = (start >= step) ? (start - step) : 0;
+      if (_points[probe].x < x)
+      {
+        lo = probe + 1;
+        break;
+      }
+      hi = probe;
+      step *= 2;
+    }
+  }
+  auto lower = std::lower_bound(_points.begin() + lo, _points.begin() + hi, Point(x, {}),
+                                TimeCompare);
+  return nearestIndex(x, std::distance(_points.begin(), lower));
+}
+
+template <typename Value>
+template <typename OtherValue>
+inline bool TimeseriesBase<Value>::sharesIndex(const TimeseriesBase<OtherValue>& other,
+                                               int index) const
+{
+  const size_t size = this->size();
+  if (index < 0 || size_t(index) >= size || other.size() != size)
+  {
+    return false;
+  }
+  // getIndexFromX() depends only on the neighbours of the first point not smaller than X,
+  // that is either "index" or "index + 1"
+  const size_t first = (index > 0) ? (index - 1) : 0;
+  const size_t last = std::min(size - 1, size_t(index) + 1);
+  for (size_t i = first; i <= last; i++)
+  {
+    if (_points[i].x != other.at(i).x)
+    {
+      return false;
+    }
+  }
+  return true;
+}
 
-  if (index >= _points.size())
+template <typename Value>
+inline void TimeseriesBase<Value>::appendSorted(const double* x, const Value* y, size_t count)
+{
+  static_assert(std::is_arithmetic_v<Value>, "appendSorted() requires numeric values");
+  if (count == 0)
   {
-    return _points.size() - 1;
+    return;
   }
-  if (index < 0)
+  // no early exit in these loops, to let the compiler vectorize them
+  bool finite = true;
+  bool sorted = true;
+  double min_y = y[0];
+  double max_y = y[0];
+  for (size_t i = 0; i < count; i++)
   {
-    return 0;
+    // (v - v) is NaN if v is NaN or infinite
+    finite &= ((x[i] - x[i]) == 0.0) & ((y[i] - y[i]) == 0.0);
+    min_y = (y[i] < min_y) ? y[i] : min_y;
+    max_y = (y[i] > max_y) ? y[i] : max_y;
+  }
+  for (size_t i = 1; i < count; i++)
+  {
+    sorted &= (x[i - 1] <= x[i]);
   }
 
-  if (index > 0 && (abs(_points[index - 1].x - x) < abs(_points[index].x - x)))
+  if (!finite)
   {
-    index = index - 1;
+    std::vector<double> valid_x;
+    std::vector<Value> valid_y;
+    valid_x.reserve(count);
+    valid_y.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      if (this->isValidPoint(Point(x[i], y[i])))
+      {
+        valid_x.push_back(x[i]);
+        valid_y.push_back(y[i]);
+      }
+    }
+    appendSorted(valid_x.data(), valid_y.data(), valid_x.size());
+    return;
+  }
+  if (!sorted || (!_points.empty() && x[0] < _points.back().x))
+  {
+    appendUnsorted(x, y, count);
+    return;
+  }
+
+  if (_points.empty())
+  {
+    this->_range_x = { x[0], x[count - 1] };
+    _range_y = { min_y, max_y };
+    this->_range_x_dirty = false;
+    _range_y_dirty = false;
+  }
+  else
+  {
+    // X is sorted: only the maximum can change
+    this->_range_x.max = std::max(this->_range_x.max, x[count - 1]);
+    _range_y.min = std::min(_range_y.min, min_y);
+    _range_y.max = std::max(_range_y.max, max_y);
+  }
+
+  const size_t prev_size = _points.size();
+  _points.resize(prev_size + count);
+  auto it = _points.begin() + prev_size;
+  for (size_t i = 0; i < count; i++, it++)
+  {
+    it->x = x[i];
+    it->y = y[i];
+  }
+  trimRange();
+}
+
+template <typename Value>
+inline void TimeseriesBase<Value>::appendUnsorted(const double* x, const Value* y,
+                                                  size_t count)
+{
+  static_assert(std::is_arithmetic_v<Value>, "appendUnsorted() requires numeric values");
+  // the pending samples arrived first: with equal X, they must come first
+  this->syncPoints();
+  std::vector<Point> run;
+  run.reserve(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    Point p(x[i], y[i]);
+    if (this->isValidPoint(p))
+    {
+      run.push_back(p);
+    }
   }
-  return index;
+  mergeRun(run);
+  trimRange();
 }
 
 }  // namespace PJ
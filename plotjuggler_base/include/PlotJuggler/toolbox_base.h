@@ -67,7 +67,9 @@ using ToolboxPluginPtr = std::shared_ptr<ToolboxPlugin>;
 }  // namespace PJ
 
 QT_BEGIN_NAMESPACE
-#define Toolbox_iid "facontidavide.PlotJuggler3.Toolbox"
+// Version 2 stores the samples of StringSeries as interned StringId: the plugins built
+// for the previous version are not loaded.
+#define Toolbox_iid "facontidavide.PlotJuggler3.Toolbox/2"
 Q_DECLARE_INTERFACE(PJ::ToolboxPlugin, Toolbox_iid)
 QT_END_NAMESPACE
 
@@ -12,6 +12,7 @@
 #include <functional>
 #include "PlotJuggler/plotdata.h"
 #include "PlotJuggler/pj_plugin.h"
+#include "PlotJuggler/profiler.h"
 
 namespace PJ
 {
@@ -66,6 +67,10 @@ public:
 
   virtual void calculate() = 0;
 
+  /// Scope of the Profiler used to measure calculate(), named after the transform,
+  /// or nullptr if the profiler is disabled.
+  Profiler::Scope* profilerScope() const;
+
   unsigned order() const
   {
     return _order;
@@ -105,14 +110,75 @@ public:
 
   void calculate() override;
 
-  /// Method to be implemented by the user to apply a statefull function to each point.
-  /// Index will increase monotonically, unless reset() is used.
-  virtual std::optional<PlotData::Point> calculateNextPoint(size_t index) = 0;
+  /// Points computed by calculateBlock(), to be appended to the destination series.
+  struct Output
+  {
+    std::vector<double> x;
+    std::vector<double> y;
+
+    void push_back(double px, double py)
+    {
+      x.push_back(px);
+      y.push_back(py);
+    }
+
+    void resize(size_t count)
+    {
+      x.resize(count);
+      y.resize(count);
+    }
+
+    size_t size() const
+    {
+      return x.size();
+    }
+
+    void clear()
+    {
+      x.clear();
+      y.clear();
+    }
+  };
+
+  /// Method to be implemented by the user to apply a statefull function to each point,
+  /// if calculateBlock() is not implemented. Index will increase monotonically,
+  /// unless reset() is used.
+  /// One of the two must be overridden: the default implementation throws.
+  virtual std::optional<PlotData::Point> calculateNextPoint(size_t index);
 
   const PlotData* dataSource() const;
 
+  /** Optional block interface, much faster than calculateNextPoint() because it avoids
+   * a virtual call and a lookup in the source per point, and the loops over contiguous
+   * arrays can be vectorized.
+   *
+   * It receives, in order, the samples of the source that were not processed yet
+   * (more than one block per call of calculate() is possible). Any state needed across
+   * blocks (previous samples, windows) must be stored by the transform and cleared
+   * in reset(). The points appended to "output" should be sorted by time.
+   *
+   * Return false, without writing the output, to use calculateNextPoint() instead:
+   * this is what the default implementation does.
+   * Declared last, to keep the layout of the vtable of the plugins built before it.
+   */
+  virtual bool calculateBlock(const double* /*x*/, const double* /*y*/, size_t /*count*/,
+                              Output& /*output*/)
+  {
+    return false;
+  }
+
 protected:
   double _last_timestamp = std::numeric_limits<double>::lowest();
+
+private:
+  // false if calculateBlock() is not implemented
+  bool calculateBlocks(const PlotData* src_data, PlotData* dst_data);
+
+  // appended, to keep the layout of the members above.
+  // Unknown until calculateBlock() is called the first time
+  std::optional<bool> _has_block_interface;
+  // processed samples with X equal to _last_timestamp, by calculateBlocks()
+  size_t _last_timestamp_count = 0;
 };
 
 ///------ The factory to create instances of a SeriesTransform -------------
@@ -137,11 +203,19 @@ private:
 public:
   static const std::set<std::string>& registeredTransforms();
 
+  /**
+   * @param thread_safe  true if calculate() doesn't access the options widget, or any other
+   * object owned by the GUI thread: the series can then be computed in a worker thread.
+   */
   template <typename T>
-  static void registerTransform()
+  static void registerTransform(bool thread_safe = false)
   {
     const std::string name = T::transformName();
     instance()->names_.insert(name);
+    if (thread_safe)
+    {
+      instance()->thread_safe_.insert(name);
+    }
     auto doc_it = instance()->default_params_.insert({ name, {} }).first;
     QDomDocument* document = &(doc_it->second);
     instance()->creators_[name] = [document]() {
@@ -165,6 +239,12 @@ public:
   }
 
   static TransformFunction::Ptr create(const std::string& name);
+
+  static bool isThreadSafe(const std::string& name);
+
+private:
+  // appended, to keep the layout of the members above
+  std::set<std::string> thread_safe_;
 };
 
 }  // namespace PJ
@@ -175,10 +255,12 @@ Q_GLOBAL_STATIC(PJ::TransformFactory, _transform_factory_ptr_from_macro)
 
 QT_BEGIN_NAMESPACE
 
-#define TransformFunction_iid "facontidavide.PlotJuggler3.TransformFunction"
+// Version 2 stores the samples of StringSeries as interned StringId, and added members to
+// TransformFunction_SISO: the plugins built for the previous version are not loaded.
+#define TransformFunction_iid "facontidavide.PlotJuggler3.TransformFunction/2"
 Q_DECLARE_INTERFACE(PJ::TransformFunction, TransformFunction_iid)
 
-#define TransformFunctionSISO_iid "facontidavide.PlotJuggler3.TransformFunctionSISO"
+#define TransformFunctionSISO_iid "facontidavide.PlotJuggler3.TransformFunctionSISO/2"
 Q_DECLARE_INTERFACE(PJ::TransformFunction_SISO, TransformFunctionSISO_iid)
 
 QT_END_NAMESPACE
@@ -5,6 +5,7 @@
  */
 
 #include "PlotJuggler/plotwidget_base.h"
+#include "PlotJuggler/profiler.h"
 #include "timeseries_qwt.h"
 
 #include "plotmagnifier.h"
@@ -332,6 +333,8 @@ PlotWidgetBase::PlotWidgetBase(QWidget* parent) : _xy_mode(false), _keep_aspect_
     canvas->setFrameStyle(QFrame::Box | QFrame::Plain);
     canvas->setLineWidth(1);
     canvas->setPalette(Qt::white);
+    // the overlays (i.e. the time tracker) are repainted without replotting
+    canvas->setPaintAttribute(QwtPlotOpenGLCanvas::BackingStore, true);
     abs_canvas = canvas;
   }
   else
@@ -767,6 +770,7 @@ bool PlotWidgetBase::isZoomEnabled() const
 
 void PlotWidgetBase::replot()
 {
+  PJ_PROFILE_SCOPE("PlotWidget::replot");
   if (p->zoomer)
   {
     p->zoomer->setZoomBase(false);
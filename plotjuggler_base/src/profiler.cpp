@@ -0,0 +1,234 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "PlotJuggler/profiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+#include <QCoreApplication>
+#include <QVariant>
+
+namespace PJ
+{
+namespace
+{
+const char* INSTANCE_PROPERTY = "PJ::Profiler";
+
+void writeEscaped(std::ostream& out, const std::string& str)
+{
+  for (char c : str)
+  {
+    if (c == '"' || c == '\\')
+    {
+      out << '\\' << c;
+    }
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      out << ' ';
+    }
+    else
+    {
+      out << c;
+    }
+  }
+}
+}  // namespace
+
+Profiler& Profiler::instance()
+{
+  // plotjuggler_base may be linked statically into the application and into each plugin.
+  // The profiler created by the first module is published as a property of the
+  // application object, that the other modules share.
+  static Profiler* profiler = []() {
+    auto app = QCoreApplication::instance();
+    if (!app)
+    {
+      return new Profiler();
+    }
+    QVariant shared = app->property(INSTANCE_PROPERTY);
+    if (shared.isValid())
+    {
+      return reinterpret_cast<Profiler*>(shared.value<quintptr>());
+    }
+    auto created = new Profiler();
+    app->setProperty(INSTANCE_PROPERTY, QVariant::fromValue(reinterpret_cast<quintptr>(created)));
+    return created;
+  }();
+  return *profiler;
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+  _enabled = enabled;
+}
+
+void Profiler::setTracing(bool tracing)
+{
+  std::lock_guard<std::mutex> lock(_trace_mutex);
+  if (tracing && !_tracing)
+  {
+    _trace.clear();
+    _trace_start_ns = now();
+  }
+  _tracing = tracing;
+}
+
+size_t Profiler::traceEventCount() const
+{
+  std::lock_guard<std::mutex> lock(_trace_mutex);
+  return _trace.size();
+}
+
+Profiler::Scope* Profiler::scope(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(_scopes_mutex);
+  auto it = _scopes_by_name.find(name);
+  if (it != _scopes_by_name.end())
+  {
+    return it->second;
+  }
+  _scopes.push_back(std::make_unique<Scope>(name));
+  Scope* scope = _scopes.back().get();
+  _scopes_by_name.insert({ name, scope });
+  return scope;
+}
+
+void Profiler::record(Scope* scope, int64_t start_ns, int64_t end_ns, uint64_t items)
+{
+  const int64_t duration = end_ns - start_ns;
+  {
+    std::lock_guard<std::mutex> lock(scope->mutex);
+    scope->calls++;
+    scope->items += items;
+    scope->total_ns += duration;
+    scope->durations_ns[scope->next] = duration;
+    scope->next = (scope->next + 1) % WINDOW;
+  }
+
+  if (isTracing())
+  {
+    std::lock_guard<std::mutex> lock(_trace_mutex);
+    if (!_tracing)
+    {
+      return;
+    }
+    _trace.push_back({ scope, start_ns, duration, threadNumber() });
+    if (_trace.size() >= MAX_TRACE_EVENTS)
+    {
+      _tracing = false;
+    }
+  }
+}
+
+int Profiler::threadNumber()
+{
+  // called with _trace_mutex locked
+  const size_t id = std::hash<std::thread::id>()(std::this_thread::get_id());
+  auto it = _threads.find(id);
+  if (it == _threads.end())
+  {
+    it = _threads.insert({ id, int(_threads.size()) + 1 }).first;
+  }
+  return it->second;
+}
+
+void Profiler::reset()
+{
+  {
+    std::lock_guard<std::mutex> lock(_scopes_mutex);
+    for (auto& scope : _scopes)
+    {
+      std::lock_guard<std::mutex> scope_lock(scope->mutex);
+      scope->calls = 0;
+      scope->items = 0;
+      scope->total_ns = 0;
+      scope->next = 0;
+    }
+  }
+  std::lock_guard<std::mutex> lock(_trace_mutex);
+  _trace.clear();
+  _trace_start_ns = now();
+}
+
+std::vector<Profiler::Statistics> Profiler::statistics() const
+{
+  std::vector<Statistics> result;
+  std::vector<int64_t> durations;
+  durations.reserve(WINDOW);
+
+  std::lock_guard<std::mutex> lock(_scopes_mutex);
+  for (auto& scope : _scopes)
+  {
+    Statistics stat;
+    {
+      std::lock_guard<std::mutex> scope_lock(scope->mutex);
+      if (scope->calls == 0)
+      {
+        continue;
+      }
+      stat.name = scope->name;
+      stat.calls = scope->calls;
+      stat.items = scope->items;
+      stat.total_ms = double(scope->total_ns) * 1e-6;
+      const size_t count = std::min<uint64_t>(scope->calls, WINDOW);
+      durations.assign(scope->durations_ns.begin(), scope->durations_ns.begin() + count);
+    }
+
+    std::sort(durations.begin(), durations.end());
+    auto percentile = [&](double p) {
+      const size_t index = std::min(durations.size() - 1, size_t(p * double(durations.size())));
+      return double(durations[index]) * 1e-6;
+    };
+    int64_t sum = 0;
+    for (int64_t duration : durations)
+    {
+      sum += duration;
+    }
+    stat.mean_ms = double(sum) * 1e-6 / double(durations.size());
+    stat.p50_ms = percentile(0.50);
+    stat.p95_ms = percentile(0.95);
+    stat.p99_ms = percentile(0.99);
+    stat.max_ms = double(durations.back()) * 1e-6;
+    result.push_back(std::move(stat));
+  }
+
+  std::sort(result.begin(), result.end(),
+            [](const Statistics& a, const Statistics& b) { return a.name < b.name; });
+  return result;
+}
+
+void Profiler::writeChromeTrace(std::ostream& out) const
+{
+  std::lock_guard<std::mutex> lock(_trace_mutex);
+
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  out << std::fixed << std::setprecision(3);
+
+  // "X" are complete events; the timestamps are in microseconds
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+  for (const auto& [id, number] : _threads)
+  {
+    out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << number << ",\"args\":{\"name\":\"Thread " << number << "\"}}";
+    first = false;
+  }
+  for (const auto& event : _trace)
+  {
+    out << (first ? "" : ",\n") << "{\"name\":\"";
+    writeEscaped(out, event.scope->name);
+    out << "\",\"cat\":\"PlotJuggler\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+        << ",\"ts\":" << double(event.start_ns - _trace_start_ns) * 1e-3
+        << ",\"dur\":" << double(event.duration_ns) * 1e-3 << "}";
+    first = false;
+  }
+  out << "\n]}\n";
+  out.flags(flags);
+  out.precision(precision);
+}
+
+}  // namespace PJ
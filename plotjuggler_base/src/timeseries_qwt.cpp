@@ -72,6 +72,11 @@ TransformedTimeseries::TransformedTimeseries(const PlotData* source_data)
 {
 }
 
+TransformedTimeseries::~TransformedTimeseries()
+{
+  cancelBackgroundUpdate();
+}
+
 TransformFunction::Ptr TransformedTimeseries::transform()
 {
   return _transform;
@@ -83,6 +88,7 @@ void TransformedTimeseries::setTransform(QString transform_ID)
   {
     return;
   }
+  cancelBackgroundUpdate();
   if (transform_ID.isEmpty())
   {
     _transform.reset();
@@ -98,6 +104,15 @@ void TransformedTimeseries::setTransform(QString transform_ID)
 
 void TransformedTimeseries::updateCache(bool reset_old_data)
 {
+  if (_background)
+  {
+    if (!reset_old_data)
+    {
+      return;
+    }
+    cancelBackgroundUpdate();
+  }
+
   if (_transform)
   {
     if (reset_old_data)
@@ -105,18 +120,92 @@ void TransformedTimeseries::updateCache(bool reset_old_data)
       _dst_data.clear();
       _transform->reset();
     }
-    std::vector<PlotData*> dest = { &_dst_data };
+    ScopedTimer timer(_transform->profilerScope());
     _transform->calculate();
   }
   else
   {
-    // TODO: optimize ??
-    _dst_data.clear();
-    for (size_t i = 0; i < _src_data->size(); i++)
+    _dst_data.clonePoints(*_src_data);
+  }
+}
+
+bool TransformedTimeseries::canUpdateInBackground() const
+{
+  return !_transform || TransformFactory::isThreadSafe(_transform->name());
+}
+
+std::function<void()> TransformedTimeseries::startBackgroundUpdate()
+{
+  cancelBackgroundUpdate();
+  _dst_data.clear();
+
+  auto background = std::make_shared<BackgroundUpdate>(_dst_data.plotName());
+  _background = background;
+  if (_transform)
+  {
+    // until finishBackgroundUpdate(), the transform writes into background->output
+    _transform->reset();
+    std::vector<PlotData*> dest = { &background->output };
+    _transform->setData(nullptr, { _src_data }, dest);
+  }
+
+  // size() merges the pending samples: the job will only read the source
+  _src_data->size();
+
+  // the function keeps alive what it uses, even if this object is destroyed
+  auto transform = _transform;
+  const PlotData* src_data = _src_data;
+  auto scope = transform ? transform->profilerScope() : nullptr;
+  return [background, transform, src_data, scope]() {
+    std::lock_guard<std::mutex> lock(background->mutex);
+    if (background->cancelled)
+    {
+      return;
+    }
+    if (transform)
     {
-      _dst_data.pushBack(_src_data->at(i));
+      ScopedTimer timer(scope);
+      transform->calculate();
     }
+    else
+    {
+      background->output.clonePoints(*src_data);
+    }
+  };
+}
+
+void TransformedTimeseries::finishBackgroundUpdate()
+{
+  if (!_background)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(_background->mutex);
+  _dst_data = std::move(_background->output);
+  if (_transform)
+  {
+    std::vector<PlotData*> dest = { &_dst_data };
+    _transform->setData(nullptr, { _src_data }, dest);
   }
+  _background.reset();
+}
+
+void TransformedTimeseries::cancelBackgroundUpdate()
+{
+  if (!_background)
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_background->mutex);
+    _background->cancelled = true;
+  }
+  if (_transform)
+  {
+    std::vector<PlotData*> dest = { &_dst_data };
+    _transform->setData(nullptr, { _src_data }, dest);
+  }
+  _background.reset();
 }
 
 QString TransformedTimeseries::transformName()
@@ -187,9 +276,18 @@ size_t QwtSeriesWrapper::size() const
 
 void QwtTimeseries::setTimeOffset(double offset)
 {
+  if (offset != _time_offset)
+  {
+    _offset_changes++;
+  }
   _time_offset = offset;
 }
 
+uint64_t QwtTimeseries::rewriteCount() const
+{
+  return _ts_data->rewriteCount() + _offset_changes;
+}
+
 RangeOpt QwtSeriesWrapper::getVisualizationRangeX()
 {
   if (this->size() < 2)
@@ -219,3 +317,8 @@ const PlotDataBase<double, double>* QwtSeriesWrapper::plotData() const
 {
   return _data;
 }
+
+uint64_t QwtSeriesWrapper::rewriteCount() const
+{
+  return _data->rewriteCount();
+}
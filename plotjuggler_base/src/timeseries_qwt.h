@@ -7,6 +7,8 @@
 #ifndef TIMESERIES_QWT_H
 #define TIMESERIES_QWT_H
 
+#include <functional>
+#include <mutex>
 #include "qwt_series_data.h"
 #include "PlotJuggler/plotdata.h"
 #include "PlotJuggler/transform_function.h"
@@ -32,6 +34,10 @@ public:
 
   virtual const PlotDataXY* plotData() const;
 
+  /// Incremented when the samples already returned may change, other than being removed
+  /// from the front. See PlotDataBase::rewriteCount().
+  virtual uint64_t rewriteCount() const;
+
   virtual RangeOpt getVisualizationRangeX();
 
   virtual RangeOpt getVisualizationRangeY(Range range_X);
@@ -54,6 +60,8 @@ public:
 
   void setTimeOffset(double offset);
 
+  uint64_t rewriteCount() const override;
+
   virtual RangeOpt getVisualizationRangeX() override;
 
   virtual RangeOpt getVisualizationRangeY(Range range_X) override;
@@ -67,6 +75,8 @@ public:
 protected:
   const PlotData* _ts_data;
   double _time_offset = 0.0;
+  // every sample moves when the offset changes
+  uint64_t _offset_changes = 0;
 };
 
 //------------------------------------
@@ -76,12 +86,33 @@ class TransformedTimeseries : public QwtTimeseries
 public:
   TransformedTimeseries(const PlotData* source_data);
 
+  ~TransformedTimeseries() override;
+
   TransformFunction::Ptr transform();
 
   void setTransform(QString transform_ID);
 
   virtual void updateCache(bool reset_old_data) override;
 
+  /**
+   * Prepare the computation of the whole cache in another thread. The returned function
+   * computes it in a separate series, that finishBackgroundUpdate() moves into this one.
+   * Until then the series is empty, and updateCache(false) does nothing.
+   * The source must not be modified while the function runs.
+   */
+  std::function<void()> startBackgroundUpdate();
+
+  /// False if the transform was not registered as thread safe.
+  bool canUpdateInBackground() const;
+
+  /// Call it in the GUI thread, after the function returned by startBackgroundUpdate().
+  void finishBackgroundUpdate();
+
+  bool isBackgroundUpdatePending() const
+  {
+    return _background != nullptr;
+  }
+
   QString transformName();
 
   QString alias() const;
@@ -93,6 +124,21 @@ protected:
   PlotData _dst_data;
   const PlotData* _src_data;
   TransformFunction_SISO::Ptr _transform;
+
+  struct BackgroundUpdate
+  {
+    std::mutex mutex;
+    bool cancelled = false;
+    PlotData output;
+
+    BackgroundUpdate(const std::string& name) : output(name, {})
+    {
+    }
+  };
+  std::shared_ptr<BackgroundUpdate> _background;
+
+  // wait for the background update, if running, and discard its result
+  void cancelBackgroundUpdate();
 };
 
 //---------------------------------------------------------
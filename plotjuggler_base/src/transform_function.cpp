@@ -5,6 +5,8 @@
  */
 
 #include "PlotJuggler/transform_function.h"
+#include <algorithm>
+#include <stdexcept>
 
 namespace PJ
 {
@@ -14,6 +16,17 @@ TransformFunction::TransformFunction() : _data(nullptr)
   _order = order++;
 }
 
+Profiler::Scope* TransformFunction::profilerScope() const
+{
+  // looked up every time rather than stored in a member, not to change the layout of
+  // the class, that the plugins built before the profiler depend on
+  if (!Profiler::instance().isEnabled())
+  {
+    return nullptr;
+  }
+  return Profiler::instance().scope(std::string("TransformFunction::calculate/") + name());
+}
+
 std::vector<const PlotData*>& TransformFunction::dataSources()
 {
   return _src_vector;
@@ -39,6 +52,7 @@ void TransformFunction::setData(PlotDataMapRef* data, const std::vector<const Pl
 void TransformFunction_SISO::reset()
 {
   _last_timestamp = std::numeric_limits<double>::lowest();
+  _last_timestamp_count = 0;
 }
 
 void TransformFunction_SISO::calculate()
@@ -50,6 +64,13 @@ void TransformFunction_SISO::calculate()
     return;
   }
   dst_data->setMaximumRangeX(src_data->maximumRangeX());
+
+  if (_has_block_interface != false && calculateBlocks(src_data, dst_data))
+  {
+    return;
+  }
+  // the transform does not implement calculateBlock()
+
   if (dst_data->size() != 0)
   {
     _last_timestamp = dst_data->back().x;
@@ -75,6 +96,61 @@ void TransformFunction_SISO::calculate()
   }
 }
 
+bool TransformFunction_SISO::calculateBlocks(const PlotData* src_data, PlotData* dst_data)
+{
+  // copied in blocks, to bound the memory used by the contiguous arrays.
+  // Thread-local rather than members, to keep the layout of the class unchanged.
+  const size_t BLOCK_SIZE = 4096;
+  thread_local std::vector<double> block_x;
+  thread_local std::vector<double> block_y;
+  thread_local Output block_output;
+
+  // here _last_timestamp is the time of the last sample of the source already processed.
+  // The samples received later may have the same time: skip only those already processed
+  auto it = std::lower_bound(src_data->begin(), src_data->end(), _last_timestamp,
+                             [](const PlotData::Point& p, double t) { return p.x < t; });
+  it += std::min(_last_timestamp_count, size_t(src_data->end() - it));
+
+  while (it != src_data->end())
+  {
+    const size_t count = std::min(BLOCK_SIZE, size_t(src_data->end() - it));
+    block_x.resize(count);
+    block_y.resize(count);
+    for (size_t i = 0; i < count; i++, it++)
+    {
+      block_x[i] = it->x;
+      block_y[i] = it->y;
+    }
+
+    block_output.clear();
+    const bool done = calculateBlock(block_x.data(), block_y.data(), count, block_output);
+    if (!_has_block_interface)
+    {
+      _has_block_interface = done;
+    }
+    if (!done)
+    {
+      return false;
+    }
+    const auto last = std::find_if(block_x.rbegin(), block_x.rend(),
+                                   [&](double x) { return x != block_x.back(); });
+    const size_t last_count = size_t(last - block_x.rbegin());
+    _last_timestamp_count =
+        (last == block_x.rend() && block_x.back() == _last_timestamp) ?
+            _last_timestamp_count + last_count :
+            last_count;
+    _last_timestamp = block_x.back();
+    dst_data->appendSorted(block_output.x.data(), block_output.y.data(), block_output.size());
+  }
+  return true;
+}
+
+std::optional<PlotData::Point> TransformFunction_SISO::calculateNextPoint(size_t)
+{
+  throw std::runtime_error(std::string("The transform ") + name() +
+                           " must override calculateBlock() or calculateNextPoint()");
+}
+
 TransformFunction::Ptr TransformFactory::create(const std::string& name)
 {
   auto it = instance()->creators_.find(name);
@@ -109,6 +185,11 @@ const std::set<std::string>& TransformFactory::registeredTransforms()
   return instance()->names_;
 }
 
+bool TransformFactory::isThreadSafe(const std::string& name)
+{
+  return instance()->thread_safe_.count(name) != 0;
+}
+
 const PlotData* TransformFunction_SISO::dataSource() const
 {
   if (_src_vector.empty())
@@ -1,5 +1,6 @@
 #include "datetimehelp.h"
 #include "dataload_csv.h"
+#include "PlotJuggler/profiler.h"
 
 #include <QTextStream>
 #include <QFile>
@@ -561,6 +562,20 @@ bool DataLoadCSV::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data
     string_vector.push_back(&(str_it->second));
   }
 
+  // numbers are buffered per column, and appended in bulk
+  std::vector<std::vector<double>> numbers_x(column_names.size());
+  std::vector<std::vector<double>> numbers_y(column_names.size());
+
+  auto flushNumbers = [&]() {
+    for (unsigned i = 0; i < plots_vector.size(); i++)
+    {
+      plots_vector[i]->appendSorted(numbers_x[i].data(), numbers_y[i].data(),
+                                    numbers_x[i].size());
+      numbers_x[i].clear();
+      numbers_y[i].clear();
+    }
+  };
+
   //-----------------
   double prev_time = std::numeric_limits<double>::lowest();
   const QString format_string = _ui->lineEditDateFormat->text();
@@ -614,10 +629,14 @@ bool DataLoadCSV::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data
   bool skipped_wrong_column = false;
   bool skipped_invalid_timestamp = false;
 
+  static auto read_scope = PJ::Profiler::instance().scope("DataLoad CSV/read lines");
+  PJ::ScopedTimer read_timer(read_scope);
+
   while (!in.atEnd())
   {
     QString line = in.readLine();
     linenumber++;
+    read_timer.addItems(1);
     SplitLine(line, _delimiter, string_items);
 
     // empty line? just try skipping
@@ -748,7 +767,8 @@ bool DataLoadCSV::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data
       double y = ParseNumber(str, is_number);
       if (is_number)
       {
-        plots_vector[i]->pushBack({ timestamp, y });
+        numbers_x[i].push_back(timestamp);
+        numbers_y[i].push_back(y);
       }
       else
       {
@@ -756,6 +776,10 @@ bool DataLoadCSV::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data
       }
     }
 
+    if (linenumber % 10000 == 0)
+    {
+      flushNumbers();
+    }
     if (linenumber % 100 == 0)
     {
       progress_dialog.setValue(linenumber);
@@ -768,6 +792,7 @@ bool DataLoadCSV::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data
     }
     samplecount++;
   }
+  flushNumbers();
 
   if (interrupted)
   {
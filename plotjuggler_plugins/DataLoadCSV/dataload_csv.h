@@ -14,7 +14,7 @@ class DateTimeHelp;
 class DataLoadCSV : public DataLoader
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataLoader")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataLoader/2")
   Q_INTERFACES(PJ::DataLoader)
 
 public:
@@ -1,6 +1,7 @@
 #include "dataload_mcap.h"
 
 #include "PlotJuggler/messageparser_base.h"
+#include "PlotJuggler/profiler.h"
 
 #include "mcap/reader.hpp"
 #include "dialog_mcap.h"
@@ -70,15 +71,19 @@ const std::vector<const char*>& DataLoadMCAP::compatibleFileExtensions() const
   return ext;
 }
 
-bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data)
+bool DataLoadMCAP::prepareRead(FileLoadInfo* info, PlotDataMapRef& plot_data)
 {
   if (!parserFactories())
   {
     throw std::runtime_error("No parsing available");
   }
 
+  _parsers_by_channel.clear();
+  _total_msgs = 0;
+
   // open file
-  mcap::McapReader reader;
+  _reader = std::make_unique<mcap::McapReader>();
+  auto& reader = *_reader;
   auto status = reader.open(info->filename.toStdString());
   if (!status.ok())
   {
@@ -103,9 +108,9 @@ bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_dat
 
   const std::optional<mcap::Statistics> statistics = reader.statistics();
 
-  std::unordered_map<int, mcap::SchemaPtr> mcap_schemas;         // schema_id
-  std::unordered_map<int, mcap::ChannelPtr> channels;            // channel_id
-  std::unordered_map<int, MessageParserPtr> parsers_by_channel;  // channel_id
+  std::unordered_map<int, mcap::SchemaPtr> mcap_schemas;  // schema_id
+  std::unordered_map<int, mcap::ChannelPtr> channels;     // channel_id
+  auto& parsers_by_channel = _parsers_by_channel;         // channel_id
 
   int total_dt_schemas = 0;
 
@@ -146,9 +151,6 @@ bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_dat
 
   std::set<QString> notified_encoding_problem;
 
-  QElapsedTimer timer;
-  timer.start();
-
   struct FailedParserInfo
   {
     std::set<std::string> topics;
@@ -248,26 +250,29 @@ bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_dat
     QMessageBox::warning(nullptr, "Parser Error", error_message);
   }
 
-  std::unordered_set<int> enabled_channels;
-  size_t total_msgs = 0;
-
   for (const auto& [channel_id, parser] : parsers_by_channel)
   {
     parser->setLargeArraysPolicy(_dialog_parameters->clamp_large_arrays,
                                  _dialog_parameters->max_array_size);
     parser->enableEmbeddedTimestamp(_dialog_parameters->use_timestamp);
 
-    QString topic_name = QString::fromStdString(channels[channel_id]->topic);
-    if (_dialog_parameters->selected_topics.contains(topic_name))
+    if (statistics && statistics->channelMessageCounts.count(channel_id) != 0)
     {
-      enabled_channels.insert(channel_id);
-      auto mcap_channel = channels[channel_id]->id;
-      if (statistics->channelMessageCounts.count(mcap_channel) != 0)
-      {
-        total_msgs += statistics->channelMessageCounts.at(channel_id);
-      }
+      _total_msgs += statistics->channelMessageCounts.at(channel_id);
     }
   }
+  return true;
+}
+
+bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data)
+{
+  if (!_reader)
+  {
+    return false;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
 
   //-------------------------------------------
   //---------------- Parse messages -----------
@@ -276,22 +281,20 @@ bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_dat
     qDebug() << QString::fromStdString(problem.message);
   };
 
-  auto messages = reader.readMessages(onProblem);
-
-  QProgressDialog progress_dialog("Loading... please wait", "Cancel", 0, 0, nullptr);
-  progress_dialog.setWindowTitle("Loading the MCAP file");
-  progress_dialog.setWindowModality(Qt::ApplicationModal);
-  progress_dialog.setRange(0, std::max<size_t>(total_msgs, 1) - 1);
-  progress_dialog.show();
-  progress_dialog.setValue(0);
+  auto messages = _reader->readMessages(onProblem);
 
   size_t msg_count = 0;
+  static auto read_scope = PJ::Profiler::instance().scope("DataLoad MCAP/read messages");
+  PJ::ScopedTimer read_timer(read_scope);
 
-  auto new_progress_update = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+  // the lock is released when the main application requests it, to display the data
+  // loaded so far.
+  std::unique_lock<std::mutex> lock(mutex());
 
   for (const auto& msg_view : messages)
   {
-    if (enabled_channels.count(msg_view.channel->id) == 0)
+    auto parser_it = _parsers_by_channel.find(msg_view.channel->id);
+    if (parser_it == _parsers_by_channel.end())
     {
       continue;
     }
@@ -302,30 +305,30 @@ bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_dat
     {
       timestamp_sec = double(msg_view.message.logTime) * 1e-9;
     }
-    auto parser_it = parsers_by_channel.find(msg_view.channel->id);
-    if (parser_it == parsers_by_channel.end())
-    {
-      qDebug() << "Skipping channeld id: " << msg_view.channel->id;
-      continue;
-    }
 
     auto parser = parser_it->second;
     MessageRef msg(msg_view.message.data, msg_view.message.dataSize);
-    parser->parseMessage(msg, timestamp_sec);
+    {
+      PJ_PROFILE_SCOPE("parseMessage/DataLoad MCAP");
+      parser->parseMessage(msg, timestamp_sec);
+    }
+
+    yieldLock(lock);
 
-    if (msg_count++ % 100 == 0 && std::chrono::steady_clock::now() > new_progress_update)
+    if (++msg_count % 256 == 0)
     {
-      new_progress_update += std::chrono::milliseconds(500);
-      progress_dialog.setValue(msg_count);
-      QApplication::processEvents();
-      if (progress_dialog.wasCanceled())
+      setProgress(double(msg_count) / double(std::max<size_t>(_total_msgs, 1)));
+      if (isCancelled())
       {
         break;
       }
     }
   }
 
-  reader.close();
+  read_timer.addItems(msg_count);
+  _parsers_by_channel.clear();
+  _reader->close();
+  _reader.reset();
   qDebug() << "Loaded file in " << timer.elapsed() << "milliseconds";
   return true;
 }
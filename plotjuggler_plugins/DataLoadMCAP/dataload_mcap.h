@@ -9,10 +9,15 @@
 
 using namespace PJ;
 
+namespace mcap
+{
+class McapReader;
+}
+
 class DataLoadMCAP : public DataLoader
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataLoader")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataLoader/2")
   Q_INTERFACES(PJ::DataLoader)
 
 public:
@@ -23,6 +28,13 @@ public:
   virtual bool readDataFromFile(PJ::FileLoadInfo* fileload_info,
                                 PlotDataMapRef& destination) override;
 
+  bool supportsBackgroundLoading() const override
+  {
+    return true;
+  }
+
+  bool prepareRead(PJ::FileLoadInfo* fileload_info, PlotDataMapRef& destination) override;
+
   virtual ~DataLoadMCAP() override;
 
   virtual const char* name() const override
@@ -36,4 +48,9 @@ public:
 
 private:
   std::optional<mcap::LoadParams> _dialog_parameters;
+
+  // created by prepareRead() and consumed by readDataFromFile()
+  std::unique_ptr<mcap::McapReader> _reader;
+  std::unordered_map<int, MessageParserPtr> _parsers_by_channel;
+  size_t _total_msgs = 0;
 };
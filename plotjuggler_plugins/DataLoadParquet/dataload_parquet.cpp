@@ -1,10 +1,10 @@
 #include "dataload_parquet.h"
+#include "PlotJuggler/profiler.h"
 #include <QTextStream>
 #include <QFile>
 #include <QMessageBox>
 #include <QDebug>
 #include <QSettings>
-#include <QProgressDialog>
 #include <QDateTime>
 #include <QInputDialog>
 #include <QListWidget>
@@ -99,8 +99,12 @@ double get_arrow_value(const std::shared_ptr<arrow::Array>& array, int64_t index
   return std::numeric_limits<double>::quiet_NaN();
 }
 
-bool DataLoadParquet::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data)
+bool DataLoadParquet::prepareRead(FileLoadInfo* info, PlotDataMapRef& plot_data)
 {
+  _arrow_reader.reset();
+  _columns_info.clear();
+  _timestamp_column = -1;
+
   // Open the file using Arrow IO
   std::shared_ptr<arrow::io::ReadableFile> infile;
   auto result = arrow::io::ReadableFile::Open(info->filename.toStdString());
@@ -123,15 +127,7 @@ bool DataLoadParquet::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_
   std::shared_ptr<parquet::FileMetaData> file_metadata =
       arrow_file_reader->parquet_reader()->metadata();
   const auto schema = file_metadata->schema();
-  const int64_t total_rows = file_metadata->num_rows();
-
-  struct ColumnInfo
-  {
-    std::string name;
-    arrow::Type::type arrow_type;
-    PlotData* plot_data = nullptr;
-    size_t column_index = 0;
-  };
+  _total_rows = file_metadata->num_rows();
 
   // Get Arrow schema
   std::shared_ptr<arrow::Schema> arrow_schema;
@@ -209,43 +205,49 @@ bool DataLoadParquet::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_
   settings.setValue("DataLoadParquet::parseDateTime", ui->checkBoxDateFormat->isChecked());
   settings.setValue("DataLoadParquet::dateFromat", ui->lineEditDateFormat->text());
 
-  //-----------------------------
-  // Time to parse
-  int timestamp_column = -1;
-
   for (const auto& info : columns_info)
   {
     if (info.name == selected_stamp.toStdString())
     {
-      timestamp_column = info.column_index;
+      _timestamp_column = info.column_index;
       break;
     }
   }
 
-  QProgressDialog progress_dialog;
-  progress_dialog.setWindowTitle("Loading the Parquet file");
-  progress_dialog.setLabelText("Loading... please wait");
-  progress_dialog.setWindowModality(Qt::ApplicationModal);
-  progress_dialog.setRange(0, columns_info.size());
-  progress_dialog.setAutoClose(true);
-  progress_dialog.setAutoReset(true);
-  progress_dialog.show();
+  _arrow_reader = std::move(arrow_file_reader);
+  _columns_info = std::move(columns_info);
+  return true;
+}
+
+bool DataLoadParquet::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data)
+{
+  if (!_arrow_reader)
+  {
+    return false;
+  }
 
   // Create RecordBatchReader for efficient batch processing
   std::shared_ptr<arrow::RecordBatchReader> batch_reader;
-  status = arrow_file_reader->GetRecordBatchReader(&batch_reader);
+  auto status = _arrow_reader->GetRecordBatchReader(&batch_reader);
   if (!status.ok())
   {
+    _arrow_reader.reset();
     throw std::runtime_error("Failed to create RecordBatchReader");
   }
 
+  const int timestamp_column = _timestamp_column;
   int64_t rows_processed = 0;
 
-  // Process data in batches
+  // Process data in batches. The mutex is held only while pushing a batch, to let
+  // the main application display the data loaded so far.
+  static auto read_scope = PJ::Profiler::instance().scope("DataLoad Parquet/read batches");
+  PJ::ScopedTimer read_timer(read_scope);
+
   std::shared_ptr<arrow::RecordBatch> batch;
-  while (batch_reader->ReadNext(&batch).ok() && batch)
+  while (!isCancelled() && batch_reader->ReadNext(&batch).ok() && batch)
   {
     const int64_t batch_rows = batch->num_rows();
+    read_timer.addItems(batch_rows);
 
     std::vector<std::pair<double, size_t>> timestamp_to_row_index(batch_rows);
 
@@ -255,7 +257,7 @@ bool DataLoadParquet::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_
       for (int64_t row = 0; row < batch_rows; row++)
       {
         const auto ts =
-            get_arrow_value(timestamp_array, row, columns_info[timestamp_column].arrow_type);
+            get_arrow_value(timestamp_array, row, _columns_info[timestamp_column].arrow_type);
         timestamp_to_row_index[row] = { ts, row };
       }
     }
@@ -263,41 +265,35 @@ bool DataLoadParquet::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_
     std::sort(timestamp_to_row_index.begin(), timestamp_to_row_index.end(),
               [](const auto& a, const auto& b) { return a.first < b.first; });
 
-    int column = 0;
+    std::vector<double> timestamps(batch_rows);
+    for (int64_t row = 0; row < batch_rows; row++)
+    {
+      timestamps[row] = (timestamp_column >= 0) ? timestamp_to_row_index[row].first :
+                                                  static_cast<double>(rows_processed + row);
+    }
+    std::vector<double> values(batch_rows);
+
+    std::lock_guard<std::mutex> lock(mutex());
 
-    for (const auto& info : columns_info)
+    for (const auto& info : _columns_info)
     {
       const auto values_array = batch->column(info.column_index);
 
       for (int64_t row = 0; row < batch_rows; row++)
       {
-        size_t ordered_row = row;
-        double timestamp = static_cast<double>(rows_processed + row);
-        if (timestamp_column >= 0)
-        {
-          timestamp = timestamp_to_row_index[row].first;
-          ordered_row = timestamp_to_row_index[row].second;
-        }
-        double value = get_arrow_value(values_array, ordered_row, info.arrow_type);
-        if (!std::isnan(value))
-        {
-          info.plot_data->pushBack({ timestamp, value });
-        }
-      }
-
-      if (column++ % 10 == 0)
-      {
-        progress_dialog.setValue(column);
-        QApplication::processEvents();
-        if (progress_dialog.wasCanceled())
-        {
-          break;
-        }
+        const size_t ordered_row =
+            (timestamp_column >= 0) ? timestamp_to_row_index[row].second : size_t(row);
+        values[row] = get_arrow_value(values_array, ordered_row, info.arrow_type);
       }
+      // NaN values are skipped by appendSorted()
+      info.plot_data->appendSorted(timestamps.data(), values.data(), values.size());
     }
     rows_processed += batch_rows;
+    setProgress(double(rows_processed) / double(std::max<int64_t>(_total_rows, 1)));
   }
 
+  _arrow_reader.reset();
+  _columns_info.clear();
   return true;
 }
 
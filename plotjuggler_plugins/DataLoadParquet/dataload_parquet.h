@@ -16,7 +16,7 @@ using namespace PJ;
 class DataLoadParquet : public DataLoader
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataLoader")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataLoader/2")
   Q_INTERFACES(PJ::DataLoader)
 
 public:
@@ -26,6 +26,13 @@ public:
   virtual bool readDataFromFile(PJ::FileLoadInfo* fileload_info,
                                 PlotDataMapRef& destination) override;
 
+  bool supportsBackgroundLoading() const override
+  {
+    return true;
+  }
+
+  bool prepareRead(PJ::FileLoadInfo* fileload_info, PlotDataMapRef& destination) override;
+
   ~DataLoadParquet() override;
 
   virtual const char* name() const override
@@ -46,7 +53,19 @@ private:
 
   QString _default_time_axis;
 
-  std::unique_ptr<parquet::arrow::FileReader> arrow_reader_;
-
   QDialog* _dialog;
+
+  struct ColumnInfo
+  {
+    std::string name;
+    arrow::Type::type arrow_type;
+    PlotData* plot_data = nullptr;
+    size_t column_index = 0;
+  };
+
+  // created by prepareRead() and consumed by readDataFromFile()
+  std::unique_ptr<parquet::arrow::FileReader> _arrow_reader;
+  std::vector<ColumnInfo> _columns_info;
+  int _timestamp_column = -1;
+  int64_t _total_rows = 0;
 };
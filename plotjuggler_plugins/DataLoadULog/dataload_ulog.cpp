@@ -8,6 +8,7 @@
 #include <QMainWindow>
 
 #include "ulog_parser.h"
+#include "PlotJuggler/profiler.h"
 #include "ulog_parameters_dialog.h"
 
 DataLoadULog::DataLoadULog() : _main_win(nullptr)
@@ -41,6 +42,9 @@ bool DataLoadULog::readDataFromFile(FileLoadInfo* fileload_info, PlotDataMapRef&
   QByteArray file_array = file.readAll();
   ULogParser::DataStream datastream(file_array.data(), file_array.size());
 
+  static auto parse_scope = PJ::Profiler::instance().scope("DataLoad ULog/parse file");
+  PJ::ScopedTimer parse_timer(parse_scope);
+  parse_timer.addItems(file_array.size());
   ULogParser parser(datastream);
 
   const auto& timeseries_map = parser.getTimeseriesMap();
@@ -50,20 +54,27 @@ bool DataLoadULog::readDataFromFile(FileLoadInfo* fileload_info, PlotDataMapRef&
     const std::string& sucsctiption_name = it.first;
     const ULogParser::Timeseries& timeseries = it.second;
 
+    // all the fields of a subscription share the same timestamps
+    std::vector<double> msg_times(timeseries.timestamps.size());
+    for (size_t i = 0; i < msg_times.size(); i++)
+    {
+      const uint64_t timestamp = timeseries.timestamps[i].value_or(static_cast<uint64_t>(i));
+      msg_times[i] = static_cast<double>(timestamp) * 0.000001;
+    }
+
     for (const auto& data : timeseries.data)
     {
       std::string series_name = sucsctiption_name + data.first;
 
       auto series = plot_data.addNumeric(series_name);
 
-      for (size_t i = 0; i < data.second.size(); i++)
+      const size_t count = std::min(data.second.size(), msg_times.size());
+      if (count > 0)
       {
-        const uint64_t timestamp = timeseries.timestamps[i].value_or(static_cast<uint64_t>(i));
-        double msg_time = static_cast<double>(timestamp) * 0.000001;
-        min_msg_time = std::min(min_msg_time, msg_time);
-        PlotData::Point point(msg_time, data.second[i]);
-        series->second.pushBack(point);
+        min_msg_time =
+            std::min(min_msg_time, *std::min_element(msg_times.begin(), msg_times.begin() + count));
       }
+      series->second.appendSorted(msg_times.data(), data.second.data(), count);
     }
   }
 
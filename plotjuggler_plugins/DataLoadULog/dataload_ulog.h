@@ -10,7 +10,7 @@ using namespace PJ;
 class DataLoadULog : public PJ::DataLoader
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataLoader")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataLoader/2")
   Q_INTERFACES(PJ::DataLoader)
 
 public:
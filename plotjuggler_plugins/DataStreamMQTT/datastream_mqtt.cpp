@@ -6,6 +6,7 @@
 #include <QUuid>
 #include <QIntValidator>
 #include <QMessageBox>
+#include "PlotJuggler/profiler.h"
 
 DataStreamMQTT::DataStreamMQTT() : _running(false)
 {
@@ -161,6 +162,7 @@ void DataStreamMQTT::onMessageReceived(const mosquitto_message* message)
     auto ts = high_resolution_clock::now().time_since_epoch();
     double timestamp = 1e-6 * double(duration_cast<microseconds>(ts).count());
 
+    PJ_PROFILE_SCOPE("parseMessage/MQTT Subscriber");
     result = parser->parseMessage(msg, timestamp);
   }
   catch (std::exception&)
@@ -15,7 +15,7 @@ using namespace PJ;
 class DataStreamMQTT : public PJ::DataStreamer
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataStreamer")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataStreamer/2")
   Q_INTERFACES(PJ::DataStreamer)
 
 public:
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include <chrono>
 #include <QNetworkDatagram>
 #include <QNetworkInterface>
+#include "PlotJuggler/profiler.h"
 
 #include "ui_udp_server.h"
 
@@ -257,6 +258,7 @@ void UDP_Server::processMessage()
     {
       std::lock_guard<std::mutex> lock(mutex());
       // important use the mutex to protect any access to the data
+      PJ_PROFILE_SCOPE("parseMessage/UDP Server");
       _parser->parseMessage(msg, timestamp);
     }
     catch (std::exception& err)
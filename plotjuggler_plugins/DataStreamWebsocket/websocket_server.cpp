@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include <QIntValidator>
 #include <QMessageBox>
 #include <chrono>
+#include "PlotJuggler/profiler.h"
 
 #include "ui_websocket_server.h"
 
@@ -186,6 +187,7 @@ void WebsocketServer::processMessage(QString message)
 
   try
   {
+    PJ_PROFILE_SCOPE("parseMessage/WebSocket Server");
     _parser->parseMessage(msg, timestamp);
   }
   catch (std::exception& err)
@@ -2,6 +2,7 @@
 #include "ui_datastream_zmq.h"
 
 #include "PlotJuggler/messageparser_base.h"
+#include "PlotJuggler/profiler.h"
 #include <QDebug>
 #include <QDialog>
 #include <QIntValidator>
@@ -288,6 +289,7 @@ bool DataStreamZMQ::parseMessage(const PJ::MessageRef& msg, double& timestamp)
   try
   {
     std::lock_guard<std::mutex> lock(mutex());
+    PJ_PROFILE_SCOPE("parseMessage/ZMQ Subscriber");
     _parser->parseMessage(msg, timestamp);
     return true;
   }
@@ -309,6 +311,7 @@ bool DataStreamZMQ::parseMessage(const std::string& topic, const PJ::MessageRef&
       _parsers[topic] = _parser_creator->createParser(topic, {}, {}, dataMap());
     }
 
+    PJ_PROFILE_SCOPE("parseMessage/ZMQ Subscriber");
     _parsers[topic]->parseMessage(msg, timestamp);
     return true;
   }
@@ -9,7 +9,7 @@
 class ParserLine : public PJ::ParserFactoryPlugin
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.ParserFactoryPlugin")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.ParserFactoryPlugin/2")
   Q_INTERFACES(PJ::ParserFactoryPlugin)
 
 public:
@@ -32,206 +32,295 @@ ProtobufParser::ProtobufParser(const std::string& topic_name, const std::string
   }
 }
 
-bool ProtobufParser::parseMessage(const MessageRef serialized_msg, double& timestamp)
+const ProtobufParser::MessagePlan& ProtobufParser::getPlan(const gp::Descriptor* descriptor)
 {
-  const google::protobuf::Message* prototype_msg = _msg_factory.GetPrototype(_msg_descriptor);
+  auto it = _plans.find(descriptor);
+  if (it != _plans.end())
+  {
+    return it->second;
+  }
 
-  google::protobuf::Message* mutable_msg = prototype_msg->New();
-  if (!mutable_msg->ParseFromArray(serialized_msg.data(), serialized_msg.size()))
+  MessagePlan plan;
+  plan.is_map_entry = descriptor->options().map_entry();
+
+  for (int index = 0; index < descriptor->field_count(); index++)
   {
-    return false;
+    auto field = descriptor->field(index);
+    if (!field)
+    {
+      continue;
+    }
+    // Map messages only have 2 fields: key and value. The key will be represented in
+    // the series name so skip it, and don't uselessly append "value" to the series
+    // name for the value.
+    if (plan.is_map_entry && field == descriptor->map_key())
+    {
+      continue;
+    }
+    FieldPlan field_plan;
+    field_plan.field = field;
+    field_plan.name = std::string(field->name());
+    field_plan.repeated = field->is_repeated();
+    field_plan.is_map = field->is_map();
+    plan.fields.push_back(std::move(field_plan));
+  }
+  return _plans.emplace(descriptor, std::move(plan)).first->second;
+}
+
+std::unique_ptr<ProtobufParser::SeriesNode>
+ProtobufParser::createNode(const gp::Descriptor* descriptor, const std::string& prefix)
+{
+  auto node = std::make_unique<SeriesNode>();
+  node->plan = &getPlan(descriptor);
+  node->fields.resize(node->plan->fields.size());
+
+  for (size_t i = 0; i < node->fields.size(); i++)
+  {
+    const auto& name = node->plan->fields[i].name;
+    if (node->plan->is_map_entry)
+    {
+      node->fields[i].key = prefix;
+    }
+    else
+    {
+      node->fields[i].key = prefix.empty() ? name : fmt::format("{}/{}", prefix, name);
+    }
   }
+  return node;
+}
 
-  std::function<void(const google::protobuf::Message&, const std::string&, const bool)> ParseImpl;
+std::string ProtobufParser::elementKey(const FieldSlot& slot, const FieldPlan& field,
+                                       unsigned index) const
+{
+  return field.repeated ? fmt::format("{}[{}]", slot.key, index) : slot.key;
+}
 
-  ParseImpl = [&](const google::protobuf::Message& msg, const std::string& prefix,
-                  const bool is_map) {
-    const gp::Reflection* reflection = msg.GetReflection();
-    const gp::Descriptor* descriptor = msg.GetDescriptor();
-    //    std::vector<const FieldDescriptor*> reflection_fields;
-    //    reflection->ListFields(msg, &reflection_fields);
+void ProtobufParser::parseNode(const gp::Message& msg, SeriesNode& node, double timestamp)
+{
+  const gp::Reflection* reflection = msg.GetReflection();
 
-    for (int index = 0; index < descriptor->field_count(); index++)
+  for (size_t field_index = 0; field_index < node.fields.size(); field_index++)
+  {
+    const FieldPlan& field_plan = node.plan->fields[field_index];
+    FieldSlot& slot = node.fields[field_index];
+    const gp::FieldDescriptor* field = field_plan.field;
+    const bool repeated = field_plan.repeated;
+
+    unsigned count = 1;
+    if (repeated)
     {
-      auto field = descriptor->field(index);
+      count = reflection->FieldSize(msg, field);
+    }
 
-      std::string key =
-          prefix.empty() ? std::string(field->name()) : fmt::format("{}/{}", prefix, field->name());
-      if (is_map)
+    if (repeated && count > maxArraySize())
+    {
+      if (clampLargeArray())
       {
-        // Map messages only have 2 fields: key and value. The key will be represented in
-        // the series name so skip it, and don't uselessly append "value" to the series
-        // name for the value.
-        if (field->name() == "key")
-        {
-          continue;
-        }
-        else
-        {
-          key = prefix;
-        }
+        count = maxArraySize();
       }
-
-      std::string suffix;
-
-      if (!field)
+      else
       {
         continue;
       }
+    }
 
-      unsigned count = 1;
-      bool repeated = false;
-      if (field->is_repeated())
+    auto getNumeric = [&](unsigned index) -> PlotData& {
+      if (index >= slot.numeric.size())
+      {
+        slot.numeric.resize(index + 1, nullptr);
+      }
+      if (!slot.numeric[index])
       {
-        count = reflection->FieldSize(msg, field);
-        repeated = true;
+        slot.numeric[index] = &getSeries(elementKey(slot, field_plan, index));
       }
+      return *slot.numeric[index];
+    };
 
-      if (repeated && count > maxArraySize())
+    auto getString = [&](unsigned index) -> StringSeries& {
+      if (index >= slot.strings.size())
       {
-        if (clampLargeArray())
-        {
-          count = std::max(count, maxArraySize());
-        }
-        else
-        {
-          continue;
-        }
+        slot.strings.resize(index + 1, nullptr);
       }
+      if (!slot.strings[index])
+      {
+        slot.strings[index] = &getStringSeries(elementKey(slot, field_plan, index));
+      }
+      return *slot.strings[index];
+    };
 
-      for (unsigned index = 0; index < count; index++)
+    for (unsigned index = 0; index < count; index++)
+    {
+      bool is_double = true;
+      double value = 0;
+      switch (field->cpp_type())
       {
-        if (repeated)
-        {
-          suffix = fmt::format("[{}]", index);
+        case gp::FieldDescriptor::CPPTYPE_DOUBLE: {
+          value = !repeated ? reflection->GetDouble(msg, field) :
+                              reflection->GetRepeatedDouble(msg, field, index);
         }
+        break;
+        case gp::FieldDescriptor::CPPTYPE_FLOAT: {
+          auto tmp = !repeated ? reflection->GetFloat(msg, field) :
+                                 reflection->GetRepeatedFloat(msg, field, index);
+          value = static_cast<double>(tmp);
+        }
+        break;
+        case gp::FieldDescriptor::CPPTYPE_UINT32: {
+          auto tmp = !repeated ? reflection->GetUInt32(msg, field) :
+                                 reflection->GetRepeatedUInt32(msg, field, index);
+          value = static_cast<double>(tmp);
+        }
+        break;
+        case gp::FieldDescriptor::CPPTYPE_UINT64: {
+          auto tmp = !repeated ? reflection->GetUInt64(msg, field) :
+                                 reflection->GetRepeatedUInt64(msg, field, index);
+          value = static_cast<double>(tmp);
+        }
+        break;
+        case gp::FieldDescriptor::CPPTYPE_BOOL: {
+          auto tmp = !repeated ? reflection->GetBool(msg, field) :
+                                 reflection->GetRepeatedBool(msg, field, index);
+          value = static_cast<double>(tmp);
+        }
+        break;
+        case gp::FieldDescriptor::CPPTYPE_INT32: {
+          auto tmp = !repeated ? reflection->GetInt32(msg, field) :
+                                 reflection->GetRepeatedInt32(msg, field, index);
+          value = static_cast<double>(tmp);
+        }
+        break;
+        case gp::FieldDescriptor::CPPTYPE_INT64: {
+          auto tmp = !repeated ? reflection->GetInt64(msg, field) :
+                                 reflection->GetRepeatedInt64(msg, field, index);
+          value = static_cast<double>(tmp);
+        }
+        break;
+        case gp::FieldDescriptor::CPPTYPE_ENUM: {
+          auto tmp = !repeated ? reflection->GetEnum(msg, field) :
+                                 reflection->GetRepeatedEnum(msg, field, index);
 
-        bool is_double = true;
-        double value = 0;
-        switch (field->cpp_type())
-        {
-          case gp::FieldDescriptor::CPPTYPE_DOUBLE: {
-            value = !repeated ? reflection->GetDouble(msg, field) :
-                                reflection->GetRepeatedDouble(msg, field, index);
-          }
-          break;
-          case gp::FieldDescriptor::CPPTYPE_FLOAT: {
-            auto tmp = !repeated ? reflection->GetFloat(msg, field) :
-                                   reflection->GetRepeatedFloat(msg, field, index);
-            value = static_cast<double>(tmp);
-          }
-          break;
-          case gp::FieldDescriptor::CPPTYPE_UINT32: {
-            auto tmp = !repeated ? reflection->GetUInt32(msg, field) :
-                                   reflection->GetRepeatedUInt32(msg, field, index);
-            value = static_cast<double>(tmp);
-          }
-          break;
-          case gp::FieldDescriptor::CPPTYPE_UINT64: {
-            auto tmp = !repeated ? reflection->GetUInt64(msg, field) :
-                                   reflection->GetRepeatedUInt64(msg, field, index);
-            value = static_cast<double>(tmp);
-          }
-          break;
-          case gp::FieldDescriptor::CPPTYPE_BOOL: {
-            auto tmp = !repeated ? reflection->GetBool(msg, field) :
-                                   reflection->GetRepeatedBool(msg, field, index);
-            value = static_cast<double>(tmp);
-          }
-          break;
-          case gp::FieldDescriptor::CPPTYPE_INT32: {
-            auto tmp = !repeated ? reflection->GetInt32(msg, field) :
-                                   reflection->GetRepeatedInt32(msg, field, index);
-            value = static_cast<double>(tmp);
-          }
-          break;
-          case gp::FieldDescriptor::CPPTYPE_INT64: {
-            auto tmp = !repeated ? reflection->GetInt64(msg, field) :
-                                   reflection->GetRepeatedInt64(msg, field, index);
-            value = static_cast<double>(tmp);
-          }
-          break;
-          case gp::FieldDescriptor::CPPTYPE_ENUM: {
-            auto tmp = !repeated ? reflection->GetEnum(msg, field) :
-                                   reflection->GetRepeatedEnum(msg, field, index);
-
-            auto& series = this->getStringSeries(key + suffix);
-            series.pushBack({ timestamp, std::string(tmp->name()) });
-            is_double = false;
-          }
-          break;
-          case gp::FieldDescriptor::CPPTYPE_STRING: {
-            auto tmp = !repeated ? reflection->GetString(msg, field) :
-                                   reflection->GetRepeatedString(msg, field, index);
-
-            if (tmp.size() > 100)
-            {
-              // probably a blob, skip it
-              continue;
-            }
-            auto& series = this->getStringSeries(key + suffix);
-            series.pushBack({ timestamp, tmp });
-            is_double = false;
+          getString(index).pushBack({ timestamp, std::string(tmp->name()) });
+          is_double = false;
+        }
+        break;
+        case gp::FieldDescriptor::CPPTYPE_STRING: {
+          const std::string& tmp =
+              !repeated ? reflection->GetStringReference(msg, field, &_scratch_string) :
+                          reflection->GetRepeatedStringReference(msg, field, index,
+                                                                 &_scratch_string);
+          if (tmp.size() > 100)
+          {
+            // probably a blob, skip it
+            continue;
           }
-          break;
-          case gp::FieldDescriptor::CPPTYPE_MESSAGE: {
+          getString(index).pushBack({ timestamp, tmp });
+          is_double = false;
+        }
+        break;
+        case gp::FieldDescriptor::CPPTYPE_MESSAGE: {
 // Fix macro issue in Windows
 #pragma push_macro("GetMessage")
 #undef GetMessage
-            const auto& new_msg = repeated ? reflection->GetRepeatedMessage(msg, field, index) :
-                                             reflection->GetMessage(msg, field);
+          const auto& new_msg = repeated ? reflection->GetRepeatedMessage(msg, field, index) :
+                                           reflection->GetMessage(msg, field);
 #pragma pop_macro("GetMessage")
-            if (field->is_map())
+          SeriesNode* child = nullptr;
+          if (field_plan.is_map)
+          {
+            // A protobuf map looks just like a message but with a "key" and
+            // "value" field, extract the key so we can set a useful suffix.
+            const auto* map_descriptor = new_msg.GetDescriptor();
+            const auto* map_reflection = new_msg.GetReflection();
+            const auto* key_field = map_descriptor->map_key();
+            std::string map_key;
+            switch (key_field->cpp_type())
             {
-              // A protobuf map looks just like a message but with a "key" and
-              // "value" field, extract the key so we can set a useful suffix.
-              const auto* map_descriptor = new_msg.GetDescriptor();
-              const auto* map_reflection = new_msg.GetReflection();
-              const auto* key_field = map_descriptor->FindFieldByName("key");
-              switch (key_field->cpp_type())
-              {
-                // A map's key is a scalar type (except floats and bytes) or a string
-                case gp::FieldDescriptor::CPPTYPE_STRING: {
-                  suffix = fmt::format("/{}", map_reflection->GetString(new_msg, key_field));
-                }
-                break;
-                case gp::FieldDescriptor::CPPTYPE_INT32: {
-                  suffix = fmt::format("/{}", map_reflection->GetInt32(new_msg, key_field));
-                }
-                break;
-                case gp::FieldDescriptor::CPPTYPE_INT64: {
-                  suffix = fmt::format("/{}", map_reflection->GetInt64(new_msg, key_field));
-                }
-                break;
-                case gp::FieldDescriptor::CPPTYPE_UINT32: {
-                  suffix = fmt::format("/{}", map_reflection->GetUInt32(new_msg, key_field));
-                }
-                break;
-                case gp::FieldDescriptor::CPPTYPE_UINT64: {
-                  suffix = fmt::format("/{}", map_reflection->GetUInt64(new_msg, key_field));
-                }
-                break;
+              // A map's key is a scalar type (except floats and bytes) or a string
+              case gp::FieldDescriptor::CPPTYPE_STRING: {
+                map_key = map_reflection->GetStringReference(new_msg, key_field, &_scratch_string);
+              }
+              break;
+              case gp::FieldDescriptor::CPPTYPE_INT32: {
+                map_key = std::to_string(map_reflection->GetInt32(new_msg, key_field));
+              }
+              break;
+              case gp::FieldDescriptor::CPPTYPE_INT64: {
+                map_key = std::to_string(map_reflection->GetInt64(new_msg, key_field));
               }
+              break;
+              case gp::FieldDescriptor::CPPTYPE_UINT32: {
+                map_key = std::to_string(map_reflection->GetUInt32(new_msg, key_field));
+              }
+              break;
+              case gp::FieldDescriptor::CPPTYPE_UINT64: {
+                map_key = std::to_string(map_reflection->GetUInt64(new_msg, key_field));
+              }
+              break;
+              default:
+                break;
             }
-            ParseImpl(new_msg, key + suffix, field->is_map());
-
-            is_double = false;
+            auto& map_child = slot.map_children[map_key];
+            if (!map_child)
+            {
+              map_child = createNode(map_descriptor, fmt::format("{}/{}", slot.key, map_key));
+            }
+            child = map_child.get();
           }
-          break;
-        }
+          else
+          {
+            if (index >= slot.children.size())
+            {
+              slot.children.resize(index + 1);
+            }
+            auto& array_child = slot.children[index];
+            if (!array_child)
+            {
+              array_child =
+                  createNode(new_msg.GetDescriptor(), elementKey(slot, field_plan, index));
+            }
+            child = array_child.get();
+          }
+          parseNode(new_msg, *child, timestamp);
 
-        if (is_double)
-        {
-          auto& series = this->getSeries(key + suffix);
-          series.pushBack({ timestamp, value });
+          is_double = false;
         }
+        break;
+      }
+
+      if (is_double)
+      {
+        getNumeric(index).pushBack({ timestamp, value });
       }
     }
-  };
+  }
+}
 
-  // start recursion
-  ParseImpl(*mutable_msg, _topic_name, false);
+bool ProtobufParser::parseMessage(const MessageRef serialized_msg, double& timestamp)
+{
+  // The same message is reused: ParseFromArray() clears it, but keeps
+  // the memory already allocated for strings, arrays and sub-messages.
+  if (!_msg)
+  {
+    _msg = _msg_factory.GetPrototype(_msg_descriptor)->New(&_arena);
+  }
+  if (!_msg->ParseFromArray(serialized_msg.data(), serialized_msg.size()))
+  {
+    return false;
+  }
 
-  delete mutable_msg;
+  if (!_root)
+  {
+    _root = createNode(_msg_descriptor, _topic_name);
+  }
+  parseNode(*_msg, *_root, timestamp);
+
+  // Some fields (maps, in particular) are not recycled by Clear() when the message
+  // lives in an arena. Release the arena once in a while, to keep memory bounded.
+  constexpr uint64_t MAX_ARENA_SIZE = 16 * 1024 * 1024;
+  if (_arena.SpaceUsed() > MAX_ARENA_SIZE)
+  {
+    _msg = nullptr;
+    _arena.Reset();
+  }
   return true;
 }
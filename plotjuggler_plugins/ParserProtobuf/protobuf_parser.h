@@ -3,6 +3,7 @@
 #include <QCheckBox>
 #include <QDebug>
 
+#include <google/protobuf/arena.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/dynamic_message.h>
 #include <google/protobuf/reflection.h>
@@ -29,9 +30,61 @@ public:
   bool parseMessage(const MessageRef serialized_msg, double& timestamp) override;
 
 protected:
+  // Reflection data of a single field, computed once per descriptor.
+  struct FieldPlan
+  {
+    const google::protobuf::FieldDescriptor* field = nullptr;
+    std::string name;
+    bool repeated = false;
+    bool is_map = false;
+  };
+
+  struct MessagePlan
+  {
+    std::vector<FieldPlan> fields;
+    // map entries are flattened as "prefix/<key>", without the "key" and "value" fields
+    bool is_map_entry = false;
+  };
+
+  // Series handles of a message (at a given position in the tree).
+  // Repeated elements and map keys are resolved the first time they are seen.
+  struct SeriesNode;
+
+  struct FieldSlot
+  {
+    std::string key;
+    std::vector<PlotData*> numeric;
+    std::vector<StringSeries*> strings;
+    std::vector<std::unique_ptr<SeriesNode>> children;
+    std::unordered_map<std::string, std::unique_ptr<SeriesNode>> map_children;
+  };
+
+  struct SeriesNode
+  {
+    const MessagePlan* plan = nullptr;
+    std::vector<FieldSlot> fields;
+  };
+
+  const MessagePlan& getPlan(const google::protobuf::Descriptor* descriptor);
+
+  std::unique_ptr<SeriesNode> createNode(const google::protobuf::Descriptor* descriptor,
+                                         const std::string& prefix);
+
+  void parseNode(const google::protobuf::Message& msg, SeriesNode& node, double timestamp);
+
+  std::string elementKey(const FieldSlot& slot, const FieldPlan& field, unsigned index) const;
+
   google::protobuf::SimpleDescriptorDatabase _proto_database;
   google::protobuf::DescriptorPool _proto_pool;
 
   google::protobuf::DynamicMessageFactory _msg_factory;
   const google::protobuf::Descriptor* _msg_descriptor = nullptr;
+
+  std::unordered_map<const google::protobuf::Descriptor*, MessagePlan> _plans;
+  std::unique_ptr<SeriesNode> _root;
+  std::string _scratch_string;
+
+  // Must be destroyed before _msg_factory: it owns the DynamicMessage reused by parseMessage()
+  google::protobuf::Arena _arena;
+  google::protobuf::Message* _msg = nullptr;
 };
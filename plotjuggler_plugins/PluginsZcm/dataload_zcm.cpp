@@ -17,6 +17,9 @@
 #include <zcm/zcm-cpp.hpp>
 #include <zcm/tools/Introspection.hpp>
 
+#include "zcm_decode_cache.h"
+#include "PlotJuggler/profiler.h"
+
 using namespace std;
 
 static bool verbose = false;
@@ -190,54 +193,6 @@ bool DataLoadZcm::launchDialog(const string& filepath)
   return !indexes.empty();
 }
 
-template <typename T>
-double toDouble(const void* data)
-{
-  return static_cast<double>(*reinterpret_cast<const T*>(data));
-}
-
-struct ProcessUsr
-{
-  vector<pair<string, double>>& numerics;
-  vector<pair<string, string>>& strings;
-};
-static void processData(const string& name, zcm_field_type_t type, const void* data, void* usr)
-{
-  ProcessUsr* v = (ProcessUsr*)usr;
-  switch (type)
-  {
-    case ZCM_FIELD_INT8_T:
-      v->numerics.emplace_back(name, toDouble<int8_t>(data));
-      break;
-    case ZCM_FIELD_INT16_T:
-      v->numerics.emplace_back(name, toDouble<int16_t>(data));
-      break;
-    case ZCM_FIELD_INT32_T:
-      v->numerics.emplace_back(name, toDouble<int32_t>(data));
-      break;
-    case ZCM_FIELD_INT64_T:
-      v->numerics.emplace_back(name, toDouble<int64_t>(data));
-      break;
-    case ZCM_FIELD_BYTE:
-      v->numerics.emplace_back(name, toDouble<uint8_t>(data));
-      break;
-    case ZCM_FIELD_FLOAT:
-      v->numerics.emplace_back(name, toDouble<float>(data));
-      break;
-    case ZCM_FIELD_DOUBLE:
-      v->numerics.emplace_back(name, toDouble<double>(data));
-      break;
-    case ZCM_FIELD_BOOLEAN:
-      v->numerics.emplace_back(name, toDouble<bool>(data));
-      break;
-    case ZCM_FIELD_STRING:
-      v->strings.emplace_back(name, string((const char*)data));
-      break;
-    case ZCM_FIELD_USER_TYPE:
-      assert(false && "Should not be possible");
-  }
-};
-
 bool DataLoadZcm::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data)
 {
   string filepath = info->filename.toStdString();
@@ -262,15 +217,17 @@ bool DataLoadZcm::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data
     return false;
   }
 
-  vector<pair<string, double>> numerics;
-  vector<pair<string, string>> strings;
-  ProcessUsr usr = { numerics, strings };
+  ZcmDecodeCache decode_cache;
+
+  static auto read_scope = PJ::Profiler::instance().scope("DataLoad ZCM/read events");
+  PJ::ScopedTimer read_timer(read_scope);
 
   auto processEvent = [&](const zcm::LogEvent* evt) {
     if (_selected_channels.find(evt->channel) == _selected_channels.end())
     {
       return;
     }
+    read_timer.addItems(1);
 
     if (evt->datalen == 0)
     {
@@ -281,25 +238,8 @@ bool DataLoadZcm::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data
       return;
     }
 
-    zcm::Introspection::processEncodedType(evt->channel, evt->data, evt->datalen, "/", types,
-                                           processData, &usr);
-    for (auto& n : usr.numerics)
-    {
-      auto itr = plot_data.numeric.find(n.first);
-      if (itr == plot_data.numeric.end())
-        itr = plot_data.addNumeric(n.first);
-      itr->second.pushBack({ (double)evt->timestamp / 1e6, n.second });
-    }
-    for (auto& s : usr.strings)
-    {
-      auto itr = plot_data.strings.find(s.first);
-      if (itr == plot_data.strings.end())
-        itr = plot_data.addStringSeries(s.first);
-      itr->second.pushBack({ (double)evt->timestamp / 1e6, s.second });
-    }
-
-    usr.numerics.clear();
-    usr.strings.clear();
+    decode_cache.decode(evt->channel, evt->data, evt->datalen, types);
+    decode_cache.pushValues(plot_data, (double)evt->timestamp / 1e6);
   };
 
   if (processInputLog(filepath, processEvent) != 0)
@@ -16,12 +16,6 @@
 using namespace std;
 using namespace PJ;
 
-template <typename T>
-double toDouble(const void* data)
-{
-  return static_cast<double>(*reinterpret_cast<const T*>(data));
-}
-
 DataStreamZcm::DataStreamZcm() : _subs(nullptr), _running(false)
 {
   _dialog = new QDialog;
@@ -147,6 +141,7 @@ void DataStreamZcm::shutdown()
   }
   _zcm->stop();
   _zcm.reset(nullptr);
+  _decode_cache.clear();
   _running = false;
 }
 
@@ -183,75 +178,15 @@ bool DataStreamZcm::xmlLoadState(const QDomElement& parent_element)
   return true;
 }
 
-void DataStreamZcm::processData(const string& name, zcm_field_type_t type, const void* data,
-                                void* usr)
-{
-  DataStreamZcm* me = (DataStreamZcm*)usr;
-  switch (type)
-  {
-    case ZCM_FIELD_INT8_T:
-      me->_numerics.emplace_back(name, toDouble<int8_t>(data));
-      break;
-    case ZCM_FIELD_INT16_T:
-      me->_numerics.emplace_back(name, toDouble<int16_t>(data));
-      break;
-    case ZCM_FIELD_INT32_T:
-      me->_numerics.emplace_back(name, toDouble<int32_t>(data));
-      break;
-    case ZCM_FIELD_INT64_T:
-      me->_numerics.emplace_back(name, toDouble<int64_t>(data));
-      break;
-    case ZCM_FIELD_BYTE:
-      me->_numerics.emplace_back(name, toDouble<uint8_t>(data));
-      break;
-    case ZCM_FIELD_FLOAT:
-      me->_numerics.emplace_back(name, toDouble<float>(data));
-      break;
-    case ZCM_FIELD_DOUBLE:
-      me->_numerics.emplace_back(name, toDouble<double>(data));
-      break;
-    case ZCM_FIELD_BOOLEAN:
-      me->_numerics.emplace_back(name, toDouble<bool>(data));
-      break;
-    case ZCM_FIELD_STRING:
-      me->_strings.emplace_back(name, string((const char*)data));
-      break;
-    case ZCM_FIELD_USER_TYPE:
-      assert(false && "Should not be possible");
-  }
-};
-
 void DataStreamZcm::handler(const zcm::ReceiveBuffer* rbuf, const string& channel)
 {
-  zcm::Introspection::processEncodedType(channel, rbuf->data, rbuf->data_size, "/", *_types.get(),
-                                         processData, this);
+  _decode_cache.decode(channel, rbuf->data, rbuf->data_size, *_types.get());
   {
     std::lock_guard<std::mutex> lock(mutex());
-
-    for (auto& n : _numerics)
-    {
-      auto itr = dataMap().numeric.find(n.first);
-      if (itr == dataMap().numeric.end())
-      {
-        itr = dataMap().addNumeric(n.first);
-      }
-      itr->second.pushBack({ double(rbuf->recv_utime) / 1e6, n.second });
-    }
-    for (auto& s : _strings)
-    {
-      auto itr = dataMap().strings.find(s.first);
-      if (itr == dataMap().strings.end())
-      {
-        itr = dataMap().addStringSeries(s.first);
-      }
-      itr->second.pushBack({ double(rbuf->recv_utime) / 1e6, s.second });
-    }
+    _decode_cache.pushValues(dataMap(), double(rbuf->recv_utime) / 1e6);
   }
 
   emit dataReceived();
-
-  _numerics.clear();
-  _strings.clear();
 }
 
 void DataStreamZcm::on_pushButtonUrl_clicked()
@@ -10,12 +10,13 @@
 #include <zcm/tools/Introspection.hpp>
 
 #include "config_zcm.h"
+#include "zcm_decode_cache.h"
 #include "ui_datastream_zcm.h"
 
 class DataStreamZcm : public PJ::DataStreamer
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataStreamer")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataStreamer/2")
   Q_INTERFACES(PJ::DataStreamer)
 
 public:
@@ -45,11 +46,7 @@ private:
 
   zcm::Subscription* _subs = nullptr;
 
-  static void processData(const std::string& name, zcm_field_type_t type, const void* data,
-                          void* usr);
-
-  std::vector<std::pair<std::string, double>> _numerics;
-  std::vector<std::pair<std::string, std::string>> _strings;
+  ZcmDecodeCache _decode_cache;
 
   void handler(const zcm::ReceiveBuffer* rbuf, const std::string& channel);
 
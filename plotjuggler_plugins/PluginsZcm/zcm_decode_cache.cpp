@@ -0,0 +1,141 @@
+#include "zcm_decode_cache.h"
+
+#include <cassert>
+#include <cstring>
+
+template <typename T>
+double toDouble(const void* data)
+{
+  return static_cast<double>(*reinterpret_cast<const T*>(data));
+}
+
+void ZcmDecodeCache::decode(const std::string& channel, uint8_t* data, size_t size,
+                            zcm::TypeDb& types)
+{
+  // every encoded zcmtype starts with the 64 bits hash of its definition
+  int64_t fingerprint = 0;
+  if (size >= sizeof(fingerprint))
+  {
+    memcpy(&fingerprint, data, sizeof(fingerprint));
+  }
+  _current = &_layouts[channel][fingerprint];
+  _count = 0;
+
+  zcm::Introspection::processEncodedType(channel, data, size, "/", types, processData, this);
+}
+
+void ZcmDecodeCache::processData(const std::string& name, zcm_field_type_t type,
+                                 const void* data, void* usr)
+{
+  auto self = static_cast<ZcmDecodeCache*>(usr);
+  double value = 0;
+  bool is_string = false;
+
+  switch (type)
+  {
+    case ZCM_FIELD_INT8_T:
+      value = toDouble<int8_t>(data);
+      break;
+    case ZCM_FIELD_INT16_T:
+      value = toDouble<int16_t>(data);
+      break;
+    case ZCM_FIELD_INT32_T:
+      value = toDouble<int32_t>(data);
+      break;
+    case ZCM_FIELD_INT64_T:
+      value = toDouble<int64_t>(data);
+      break;
+    case ZCM_FIELD_BYTE:
+      value = toDouble<uint8_t>(data);
+      break;
+    case ZCM_FIELD_FLOAT:
+      value = toDouble<float>(data);
+      break;
+    case ZCM_FIELD_DOUBLE:
+      value = toDouble<double>(data);
+      break;
+    case ZCM_FIELD_BOOLEAN:
+      value = toDouble<bool>(data);
+      break;
+    case ZCM_FIELD_STRING:
+      is_string = true;
+      break;
+    case ZCM_FIELD_USER_TYPE:
+      assert(false && "Should not be possible");
+      return;
+  }
+
+  Layout& layout = *self->_current;
+  const size_t index = self->_count++;
+  if (index >= layout.size())
+  {
+    layout.resize(index + 1);
+    self->_values.resize(layout.size());
+    self->_string_values.resize(layout.size());
+  }
+
+  Field& field = layout[index];
+  if (field.is_string != is_string || field.name != name)
+  {
+    field.name = name;
+    field.is_string = is_string;
+    field.numeric = nullptr;
+    field.string = nullptr;
+  }
+
+  if (is_string)
+  {
+    self->_string_values[index].assign(static_cast<const char*>(data));
+  }
+  else
+  {
+    self->_values[index] = value;
+  }
+}
+
+void ZcmDecodeCache::pushValues(PJ::PlotDataMapRef& plot_data, double timestamp)
+{
+  if (!_current)
+  {
+    return;
+  }
+  Layout& layout = *_current;
+
+  for (size_t i = 0; i < _count; i++)
+  {
+    Field& field = layout[i];
+    if (field.is_string)
+    {
+      if (!field.string)
+      {
+        auto itr = plot_data.strings.find(field.name);
+        if (itr == plot_data.strings.end())
+        {
+          itr = plot_data.addStringSeries(field.name);
+        }
+        field.string = &itr->second;
+      }
+      field.string->pushBack({ timestamp, _string_values[i] });
+    }
+    else
+    {
+      if (!field.numeric)
+      {
+        auto itr = plot_data.numeric.find(field.name);
+        if (itr == plot_data.numeric.end())
+        {
+          itr = plot_data.addNumeric(field.name);
+        }
+        field.numeric = &itr->second;
+      }
+      field.numeric->pushBack({ timestamp, _values[i] });
+    }
+  }
+}
+
+void ZcmDecodeCache::clear()
+{
+  _layouts.clear();
+  _current = nullptr;
+  _count = 0;
+}
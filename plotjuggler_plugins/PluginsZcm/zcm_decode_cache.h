@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <zcm/zcm-cpp.hpp>
+#include <zcm/tools/TypeDb.hpp>
+#include <zcm/tools/Introspection.hpp>
+
+#include "PlotJuggler/plotdata.h"
+
+/**
+ * @brief Decodes ZCM messages with zcm::Introspection and remembers, for each
+ * channel and type fingerprint, the series that every field was written to.
+ *
+ * The fields of a type are always reported in the same order: once the first
+ * message was decoded, the n-th field of the following ones only needs to be
+ * compared with the cached name (variable length arrays may change the layout),
+ * instead of being copied and looked up in the PlotDataMapRef.
+ */
+class ZcmDecodeCache
+{
+public:
+  /// Decode a message. It doesn't access the PlotDataMapRef.
+  void decode(const std::string& channel, uint8_t* data, size_t size, zcm::TypeDb& types);
+
+  /// Push the values of the last decoded message. Series are created if needed,
+  /// so the caller must hold the mutex of the PlotDataMapRef (if any).
+  void pushValues(PJ::PlotDataMapRef& plot_data, double timestamp);
+
+  void clear();
+
+private:
+  struct Field
+  {
+    std::string name;
+    bool is_string = false;
+    PJ::PlotData* numeric = nullptr;
+    PJ::StringSeries* string = nullptr;
+  };
+
+  using Layout = std::vector<Field>;
+
+  static void processData(const std::string& name, zcm_field_type_t type, const void* data,
+                          void* usr);
+
+  std::unordered_map<std::string, std::unordered_map<int64_t, Layout>> _layouts;
+
+  Layout* _current = nullptr;
+  size_t _count = 0;
+  std::vector<double> _values;
+  std::vector<std::string> _string_values;
+};
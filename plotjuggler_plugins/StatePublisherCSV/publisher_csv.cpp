@@ -9,7 +9,10 @@
 #include <QMessageBox>
 #include <QSettings>
 #include <QByteArray>
+#include <QApplication>
+#include <QProgressDialog>
 #include "publisher_csv.h"
+#include "range_exporter.h"
 
 StatePublisherCSV::StatePublisherCSV()
 {
@@ -101,8 +104,7 @@ void StatePublisherCSV::setEnabled(bool enabled)
 
     //--------------------
     connect(_ui->buttonRangeFile, &QPushButton::clicked, this, [this]() {
-      auto csv_string = generateRangeCSV(_start_time, _end_time);
-      this->saveFile(csv_string);
+      exportRangeToFile(_start_time, _end_time);
     });
 
     //--------------------
@@ -252,104 +254,80 @@ void StatePublisherCSV::saveFile(QString text)
 
 QString StatePublisherCSV::generateRangeCSV(double time_start, double time_end)
 {
-  using PlotPair = std::pair<std::string, const PJ::PlotData*>;
+  RangeExporter exporter(*_datamap, time_start, time_end);
+  return QString::fromStdString(exporter.toCSVString());
+}
 
-  std::vector<PlotPair> ordered_plotdata;
+void StatePublisherCSV::exportRangeToFile(double time_start, double time_end)
+{
+  QSettings settings;
+  QString directory_path =
+      settings.value("StatePublisherCSV.saveDirectory", QDir::currentPath()).toString();
 
-  for (const auto& it : _datamap->numeric)
+  QString filters = tr("CSV files (*.csv)");
+  if (RangeExporter::parquetSupported())
   {
-    if (it.second.size() == 0 || it.second.front().x > time_end || it.second.back().x < time_start)
-    {
-      continue;
-    }
-    ordered_plotdata.push_back({ it.first, &it.second });
+    filters += ";;" + tr("Parquet files (*.parquet)");
   }
-  const size_t plot_count = ordered_plotdata.size();
-
-  std::sort(ordered_plotdata.begin(), ordered_plotdata.end(),
-            [](const PlotPair& a, const PlotPair& b) { return a.first < b.first; });
-
-  // current index per plordata
-  std::vector<size_t> indices(plot_count, 0);
-
-  const auto NaN = std::numeric_limits<double>::quiet_NaN();
-  std::vector<double> row_values(plot_count, NaN);
-
-  QString labels;
-  labels += "__time,";
-  for (size_t i = 0; i < plot_count; i++)
+  QString selected_filter;
+  QString fileName = QFileDialog::getSaveFileName(nullptr, tr("Save range data"), directory_path,
+                                                  filters, &selected_filter);
+  if (fileName.isEmpty())
   {
-    labels += QString::fromStdString(ordered_plotdata[i].first);
-    labels += (i + 1 < plot_count) ? "," : "\n";
+    return;
+  }
 
-    const PJ::PlotData* plotdata = (ordered_plotdata[i].second);
-    int index = plotdata->getIndexFromX(time_start);
-    if (index < 0)
+  RangeExporter::Format format = RangeExporter::CSV;
+  if (fileName.endsWith(".parquet") || selected_filter.contains("parquet"))
+  {
+    format = RangeExporter::PARQUET;
+    if (!fileName.endsWith(".parquet"))
     {
-      index = plotdata->size();
+      fileName.append(".parquet");
     }
-    indices[i] = index + 1;
   }
-
-  bool done = false;
-  QStringList rows = { labels };
-
-  while (!done)
+  else if (!fileName.endsWith(".csv"))
   {
-    // done will become false if at least one plotdata is not completed
-    done = true;
-    double min_time = std::numeric_limits<double>::max();
-
-    for (size_t i = 0; i < plot_count; i++)
-    {
-      size_t index = indices[i];
-      const PJ::PlotData* plotdata = (ordered_plotdata[i].second);
-      row_values[i] = NaN;
-
-      if (index >= plotdata->size())
-      {
-        continue;
-      }
-      const auto& point = plotdata->at(index);
-      if (point.x > time_end)
-      {
-        continue;
-      }
+    fileName.append(".csv");
+  }
 
-      done = false;
+  RangeExporter exporter(*_datamap, time_start, time_end);
+  if (!exporter.start(fileName, format))
+  {
+    QMessageBox::warning(nullptr, "Error", exporter.errorString());
+    return;
+  }
 
-      if (min_time > point.x)
-      {
-        min_time = point.x;  // new min_time
-        // reset previous flags
-        std::fill(row_values.begin(), row_values.begin() + i, NaN);
-        row_values[i] = point.y;
-      }
-      else if (std::abs(min_time - point.x) < std::numeric_limits<double>::epsilon())
-      {
-        row_values[i] = point.y;
-      }
-    }
+  const int PROGRESS_STEPS = 1000;
+  QProgressDialog progress_dialog;
+  progress_dialog.setLabelText("Exporting... ");
+  progress_dialog.setRange(0, PROGRESS_STEPS);
+  progress_dialog.setAutoClose(true);
+  progress_dialog.setAutoReset(true);
+  progress_dialog.setWindowModality(Qt::ApplicationModal);
+  progress_dialog.show();
 
-    if (min_time > time_end || done)
+  while (!exporter.isFinished())
+  {
+    exporter.feed(20);
+    progress_dialog.setValue(int(exporter.progress() * PROGRESS_STEPS));
+    QApplication::processEvents();
+    if (progress_dialog.wasCanceled())
     {
-      break;
+      exporter.cancel();
+      return;
     }
+  }
+  progress_dialog.close();
 
-    // the row to append to the CSV file
-    QString row_str = QString::number(min_time, 'f', 6) + ",";
-
-    for (size_t i = 0; i < plot_count; i++)
-    {
-      if (!std::isnan(row_values[i]))
-      {
-        row_str += QString::number(row_values[i], 'f', 9);
-        // value used, move to the nex index
-        indices[i]++;
-      }
-      row_str += (i + 1 < plot_count) ? "," : "\n";
-    }
-    rows.push_back(row_str);
+  if (!exporter.errorString().isEmpty())
+  {
+    QMessageBox::warning(nullptr, "Error", exporter.errorString());
+    return;
   }
-  return rows.join("");
+  directory_path = QFileInfo(fileName).absolutePath();
+  settings.setValue("StatePublisherCSV.saveDirectory", directory_path);
+
+  _ui->labelNotification->setText("Range data saved to file");
+  _notification_timer->start(2000);
 }
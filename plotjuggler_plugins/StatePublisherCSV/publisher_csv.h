@@ -13,7 +13,7 @@
 class StatePublisherCSV : public PJ::StatePublisher
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.StatePublisher")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.StatePublisher/2")
   Q_INTERFACES(PJ::StatePublisher)
 
 public:
@@ -63,6 +63,8 @@ private:
 
   QString generateRangeCSV(double time_start, double time_end);
 
+  void exportRangeToFile(double time_start, double time_end);
+
   QString generateStatisticsCSV(double time_start, double time_end);
 
   bool getTimeRanges(double* first, double* last);
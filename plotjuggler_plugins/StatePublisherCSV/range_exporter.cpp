@@ -0,0 +1,626 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "range_exporter.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <QFile>
+
+#ifdef PJ_PARQUET_EXPORT
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <parquet/arrow/writer.h>
+#endif
+
+using PJ::PlotData;
+
+namespace
+{
+// samples per slice, summed over all the series
+const size_t SLICE_POINTS = 1000000;
+const size_t MAX_QUEUED_SLICES = 2;
+
+// the longest double in fixed notation with up to 9 decimals, plus sign and point
+const size_t MAX_NUMBER_LENGTH = 330;
+
+char* WriteFixed(char* out, double value, int precision)
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  return std::to_chars(out, out + MAX_NUMBER_LENGTH, value, std::chars_format::fixed, precision)
+      .ptr;
+#else
+  // floating point std::to_chars is not available in older standard libraries
+  return out + std::snprintf(out, MAX_NUMBER_LENGTH, "%.*f", precision, value);
+#endif
+}
+
+PlotData::ConstIterator FirstNotBefore(const PlotData& series, double time)
+{
+  return std::lower_bound(series.begin(), series.end(), time,
+                          [](const PlotData::Point& p, double t) { return p.x < t; });
+}
+
+PlotData::ConstIterator FirstAfter(const PlotData& series, double time)
+{
+  return std::upper_bound(series.begin(), series.end(), time,
+                          [](double t, const PlotData::Point& p) { return t < p.x; });
+}
+}  // namespace
+
+//---------------------------------------------------------------
+
+class RangeExporter::Writer
+{
+public:
+  virtual ~Writer() = default;
+
+  virtual bool writeHeader(const std::vector<std::string>& names) = 0;
+
+  // "values" is a list of (column, value), sorted by column
+  virtual bool writeRow(double time, const std::pair<uint32_t, double>* values,
+                        size_t count) = 0;
+
+  // called at the end of each slice
+  virtual bool endSlice() = 0;
+
+  virtual bool close() = 0;
+
+  QString error;
+};
+
+namespace
+{
+// Formats the rows directly into a large buffer, written when it is full.
+class CsvWriter : public RangeExporter::Writer
+{
+public:
+  CsvWriter() : _buffer(BUFFER_SIZE)
+  {
+  }
+
+  bool writeHeader(const std::vector<std::string>& names) override
+  {
+    _column_count = names.size();
+    std::string header = "__time,";
+    for (size_t i = 0; i < names.size(); i++)
+    {
+      header += names[i];
+      header += (i + 1 < names.size()) ? ',' : '\n';
+    }
+    return writeData(header.data(), header.size());
+  }
+
+  bool writeRow(double time, const std::pair<uint32_t, double>* values, size_t count) override
+  {
+    const size_t max_row_size = (count + 1) * MAX_NUMBER_LENGTH + _column_count + 2;
+    if (_buffer.size() - _used < max_row_size)
+    {
+      if (!flushBuffer())
+      {
+        return false;
+      }
+      _buffer.resize(std::max(_buffer.size(), max_row_size));
+    }
+
+    char* out = _buffer.data() + _used;
+    out = WriteFixed(out, time, 6);
+    *out++ = ',';
+    size_t next = 0;
+    for (size_t col = 0; col < _column_count; col++)
+    {
+      if (next < count && values[next].first == col)
+      {
+        out = WriteFixed(out, values[next].second, 9);
+        next++;
+      }
+      *out++ = (col + 1 < _column_count) ? ',' : '\n';
+    }
+    if (_column_count == 0)
+    {
+      *out++ = '\n';
+    }
+    _used = out - _buffer.data();
+    return true;
+  }
+
+  bool endSlice() override
+  {
+    return true;
+  }
+
+  bool close() override
+  {
+    return flushBuffer();
+  }
+
+protected:
+  virtual bool writeData(const char* data, size_t size) = 0;
+
+private:
+  static constexpr size_t BUFFER_SIZE = 1024 * 1024;
+  std::vector<char> _buffer;
+  size_t _used = 0;
+  size_t _column_count = 0;
+
+  bool flushBuffer()
+  {
+    const bool ok = writeData(_buffer.data(), _used);
+    _used = 0;
+    return ok;
+  }
+};
+
+class CsvFileWriter : public CsvWriter
+{
+public:
+  bool open(const QString& filename)
+  {
+    _file.setFileName(filename);
+    if (!_file.open(QIODevice::WriteOnly))
+    {
+      error = QString("Failed to open the file [%1]").arg(filename);
+      return false;
+    }
+    return true;
+  }
+
+  bool close() override
+  {
+    const bool ok = CsvWriter::close() && _file.flush();
+    _file.close();
+    return ok;
+  }
+
+protected:
+  bool writeData(const char* data, size_t size) override
+  {
+    if (_file.write(data, qint64(size)) != qint64(size))
+    {
+      error = QString("Failed to write the file: %1").arg(_file.errorString());
+      return false;
+    }
+    return true;
+  }
+
+private:
+  QFile _file;
+};
+
+class CsvStringWriter : public CsvWriter
+{
+public:
+  CsvStringWriter(std::string& output) : _output(output)
+  {
+  }
+
+protected:
+  bool writeData(const char* data, size_t size) override
+  {
+    _output.append(data, size);
+    return true;
+  }
+
+private:
+  std::string& _output;
+};
+
+#ifdef PJ_PARQUET_EXPORT
+// One row group per slice. Cells without a value are null.
+class ParquetWriter : public RangeExporter::Writer
+{
+public:
+  bool open(const QString& filename)
+  {
+    auto stream = arrow::io::FileOutputStream::Open(filename.toStdString());
+    if (!stream.ok())
+    {
+      return setError(stream.status());
+    }
+    _stream = *stream;
+    return true;
+  }
+
+  bool writeHeader(const std::vector<std::string>& names) override
+  {
+    arrow::FieldVector fields = { arrow::field("__time", arrow::float64(), false) };
+    for (const auto& name : names)
+    {
+      fields.push_back(arrow::field(name, arrow::float64(), true));
+    }
+    _schema = arrow::schema(fields);
+    for (size_t i = 0; i < fields.size(); i++)
+    {
+      _builders.push_back(std::make_unique<arrow::DoubleBuilder>());
+    }
+
+    auto writer = parquet::arrow::FileWriter::Open(*_schema, arrow::default_memory_pool(), _stream,
+                                                   parquet::default_writer_properties(),
+                                                   parquet::default_arrow_writer_properties());
+    if (!writer.ok())
+    {
+      return setError(writer.status());
+    }
+    _writer = std::move(*writer);
+    return true;
+  }
+
+  bool writeRow(double time, const std::pair<uint32_t, double>* values, size_t count) override
+  {
+    bool ok = _builders[0]->Append(time).ok();
+    size_t next = 0;
+    for (size_t col = 0; col + 1 < _builders.size(); col++)
+    {
+      auto& builder = *_builders[col + 1];
+      if (next < count && values[next].first == col)
+      {
+        ok &= builder.Append(values[next].second).ok();
+        next++;
+      }
+      else
+      {
+        ok &= builder.AppendNull().ok();
+      }
+    }
+    _rows++;
+    if (!ok)
+    {
+      error = "Failed to allocate the Parquet columns";
+    }
+    return ok;
+  }
+
+  bool endSlice() override
+  {
+    if (_rows == 0)
+    {
+      return true;
+    }
+    arrow::ArrayVector arrays(_builders.size());
+    for (size_t i = 0; i < _builders.size(); i++)
+    {
+      auto status = _builders[i]->Finish(&arrays[i]);
+      if (!status.ok())
+      {
+        return setError(status);
+      }
+    }
+    auto table = arrow::Table::Make(_schema, arrays, _rows);
+    _rows = 0;
+    auto status = _writer->WriteTable(*table, table->num_rows());
+    return status.ok() || setError(status);
+  }
+
+  bool close() override
+  {
+    if (!endSlice())
+    {
+      return false;
+    }
+    auto status = _writer->Close();
+    if (!status.ok())
+    {
+      return setError(status);
+    }
+    status = _stream->Close();
+    return status.ok() || setError(status);
+  }
+
+private:
+  std::shared_ptr<arrow::io::FileOutputStream> _stream;
+  std::shared_ptr<arrow::Schema> _schema;
+  std::unique_ptr<parquet::arrow::FileWriter> _writer;
+  std::vector<std::unique_ptr<arrow::DoubleBuilder>> _builders;
+  int64_t _rows = 0;
+
+  bool setError(const arrow::Status& status)
+  {
+    error = QString("Parquet: %1").arg(QString::fromStdString(status.ToString()));
+    return false;
+  }
+};
+#endif
+
+}  // namespace
+
+//---------------------------------------------------------------
+
+RangeExporter::RangeExporter(const PJ::PlotDataMapRef& datamap, double time_start,
+                             double time_end)
+  : _datamap(datamap)
+{
+  double first = std::numeric_limits<double>::max();
+  double last = std::numeric_limits<double>::lowest();
+  size_t total_points = 0;
+
+  for (const auto& [name, series] : datamap.numeric)
+  {
+    if (series.size() == 0 || series.front().x > time_end || series.back().x < time_start)
+    {
+      continue;
+    }
+    _names.push_back(name);
+    first = std::min(first, series.front().x);
+    last = std::max(last, series.back().x);
+    total_points += std::distance(FirstNotBefore(series, time_start), FirstAfter(series, time_end));
+  }
+  std::sort(_names.begin(), _names.end());
+
+  if (_names.empty())
+  {
+    return;
+  }
+  _time_start = std::max(time_start, first);
+  _time_end = std::min(time_end, last);
+
+  // slices of similar size, if the samples are distributed uniformly in time
+  _slice_count = (_time_end > _time_start) ? (1 + total_points / SLICE_POINTS) : 1;
+  _slice_duration = (_time_end - _time_start) / double(_slice_count);
+}
+
+RangeExporter::~RangeExporter()
+{
+  if (_worker.joinable())
+  {
+    cancel();
+  }
+}
+
+bool RangeExporter::parquetSupported()
+{
+#ifdef PJ_PARQUET_EXPORT
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool RangeExporter::start(const QString& filename, Format format)
+{
+  _filename = filename;
+  if (format == PARQUET)
+  {
+#ifdef PJ_PARQUET_EXPORT
+    auto writer = std::make_unique<ParquetWriter>();
+    if (!writer->open(filename))
+    {
+      _error = writer->error;
+      return false;
+    }
+    _writer = std::move(writer);
+#else
+    _error = "This version of the plugin was built without Parquet support";
+    return false;
+#endif
+  }
+  else
+  {
+    auto writer = std::make_unique<CsvFileWriter>();
+    if (!writer->open(filename))
+    {
+      _error = writer->error;
+      return false;
+    }
+    _writer = std::move(writer);
+  }
+
+  if (!_writer->writeHeader(_names))
+  {
+    _error = _writer->error;
+    _writer.reset();
+    QFile::remove(_filename);
+    return false;
+  }
+  _all_produced = (_slice_count == 0);
+  _worker = std::thread(&RangeExporter::workerLoop, this);
+  return true;
+}
+
+void RangeExporter::feed(int timeout_ms)
+{
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  if (_all_produced)
+  {
+    _cv.wait_until(lock, deadline, [this]() { return _finished.load(); });
+    return;
+  }
+  _cv.wait_until(lock, deadline, [this]() {
+    return _queue.size() < MAX_QUEUED_SLICES || _finished || _cancelled;
+  });
+  if (_queue.size() >= MAX_QUEUED_SLICES || _finished || _cancelled)
+  {
+    return;
+  }
+  // the series are read without holding the lock: the worker never accesses them
+  lock.unlock();
+  Slice slice;
+  const bool produced = makeSlice(slice);
+  lock.lock();
+
+  if (produced)
+  {
+    _queue.push_back(std::move(slice));
+  }
+  _all_produced = (_slices_produced >= _slice_count);
+  _cv.notify_all();
+}
+
+double RangeExporter::progress() const
+{
+  return (_slice_count == 0) ? 1.0 : double(_slices_written) / double(_slice_count);
+}
+
+void RangeExporter::cancel()
+{
+  _cancelled = true;
+  _cv.notify_all();
+  if (_worker.joinable())
+  {
+    _worker.join();
+  }
+}
+
+QString RangeExporter::errorString() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _error;
+}
+
+std::string RangeExporter::toCSVString()
+{
+  std::string output;
+  _writer = std::make_unique<CsvStringWriter>(output);
+  _writer->writeHeader(_names);
+  Slice slice;
+  while (makeSlice(slice))
+  {
+    writeSlice(slice);
+  }
+  _writer->close();
+  _writer.reset();
+  return output;
+}
+
+bool RangeExporter::makeSlice(Slice& slice)
+{
+  if (_slices_produced >= _slice_count)
+  {
+    return false;
+  }
+  // computed in the same way for the end of a slice and the start of the next one
+  auto SliceStart = [this](size_t index) {
+    return (index == 0) ? _time_start : (_time_start + double(index) * _slice_duration);
+  };
+  const double t_start = SliceStart(_slices_produced);
+  const bool last_slice = (_slices_produced + 1 == _slice_count);
+
+  slice.columns.resize(_names.size());
+  for (size_t i = 0; i < _names.size(); i++)
+  {
+    auto& column = slice.columns[i];
+    column.clear();
+    // the series might have been removed in the meantime
+    auto it = _datamap.numeric.find(_names[i]);
+    if (it == _datamap.numeric.end())
+    {
+      continue;
+    }
+    const PlotData& series = it->second;
+    auto first = FirstNotBefore(series, t_start);
+    auto last = last_slice ? FirstAfter(series, _time_end) :
+                             FirstNotBefore(series, SliceStart(_slices_produced + 1));
+    if (first < last)
+    {
+      column.assign(first, last);
+    }
+  }
+  _slices_produced++;
+  return true;
+}
+
+bool RangeExporter::writeSlice(const Slice& slice)
+{
+  // min-heap of the next sample of each series: (time, column)
+  using Entry = std::pair<double, uint32_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+  std::vector<size_t> cursors(slice.columns.size(), 0);
+
+  for (size_t col = 0; col < slice.columns.size(); col++)
+  {
+    if (!slice.columns[col].empty())
+    {
+      heap.push({ slice.columns[col].front().x, uint32_t(col) });
+    }
+  }
+
+  std::vector<std::pair<uint32_t, double>> row;
+  while (!heap.empty())
+  {
+    if (_cancelled)
+    {
+      return false;
+    }
+    // a row contains at most one sample per series: the next one is pushed afterward
+    const double time = heap.top().first;
+    row.clear();
+    while (!heap.empty() && (heap.top().first - time) < std::numeric_limits<double>::epsilon())
+    {
+      const uint32_t col = heap.top().second;
+      heap.pop();
+      row.push_back({ col, slice.columns[col][cursors[col]].y });
+      cursors[col]++;
+    }
+    for (const auto& [col, value] : row)
+    {
+      if (cursors[col] < slice.columns[col].size())
+      {
+        heap.push({ slice.columns[col][cursors[col]].x, col });
+      }
+    }
+    std::sort(row.begin(), row.end());
+    if (!_writer->writeRow(time, row.data(), row.size()))
+    {
+      return false;
+    }
+  }
+  return _writer->endSlice();
+}
+
+void RangeExporter::workerLoop()
+{
+  bool ok = true;
+  while (ok)
+  {
+    Slice slice;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cv.wait(lock, [this]() { return !_queue.empty() || _all_produced || _cancelled; });
+      if (_cancelled || _queue.empty())
+      {
+        break;
+      }
+      slice = std::move(_queue.front());
+      _queue.pop_front();
+    }
+    // there is room for another slice
+    _cv.notify_all();
+
+    ok = writeSlice(slice);
+    _slices_written++;
+  }
+
+  if (ok && !_cancelled)
+  {
+    ok = _writer->close();
+  }
+  if (!ok && !_cancelled)
+  {
+    setError(_writer->error);
+  }
+  if (!ok || _cancelled)
+  {
+    // don't leave an incomplete file
+    _writer.reset();
+    QFile::remove(_filename);
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _finished = true;
+  _cv.notify_all();
+}
+
+void RangeExporter::setError(const QString& error)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _error = error;
+}
@@ -0,0 +1,113 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef RANGE_EXPORTER_H
+#define RANGE_EXPORTER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <QString>
+#include "PlotJuggler/plotdata.h"
+
+/**
+ * Export of the numeric series in a time range: one column per series (ordered by name)
+ * and one row per distinct timestamp. A cell is empty if the series has no sample at
+ * that time.
+ *
+ * The data is processed in slices of time. The GUI thread copies the samples of the next
+ * slice with feed(), because the series may be modified by streaming in the meantime.
+ * A worker thread merges the series of each slice with a min-heap, O(N log K) for
+ * N samples and K series, and streams the rows to the file through a buffered writer.
+ * The memory used is independent of the size of the export.
+ */
+class RangeExporter
+{
+public:
+  enum Format
+  {
+    CSV,
+    PARQUET
+  };
+
+  /// The range is clamped to the data available.
+  RangeExporter(const PJ::PlotDataMapRef& datamap, double time_start, double time_end);
+
+  ~RangeExporter();
+
+  /// True if the plugin was built with Arrow/Parquet.
+  static bool parquetSupported();
+
+  /// Open the file and start the worker thread. Return false if the file can't be written.
+  bool start(const QString& filename, Format format);
+
+  /// Called by the GUI thread until isFinished(): copy the next slice of samples for the
+  /// worker, waiting up to "timeout_ms" if it is still busy with the previous ones.
+  void feed(int timeout_ms);
+
+  bool isFinished() const
+  {
+    return _finished;
+  }
+
+  /// In the range [0, 1].
+  double progress() const;
+
+  /// Stop the export and remove the incomplete file.
+  void cancel();
+
+  /// Empty if no error occurred.
+  QString errorString() const;
+
+  /// Synchronous export to a CSV string, for small ranges (i.e. the clipboard).
+  std::string toCSVString();
+
+  class Writer;
+
+private:
+  // samples of each series in the time range of a slice, in the same order as _names
+  struct Slice
+  {
+    std::vector<std::vector<PJ::PlotData::Point>> columns;
+  };
+
+  const PJ::PlotDataMapRef& _datamap;
+  std::vector<std::string> _names;
+  double _time_start = 0;
+  double _time_end = 0;
+  double _slice_duration = 0;
+  size_t _slice_count = 0;
+  size_t _slices_produced = 0;
+  std::atomic_size_t _slices_written = { 0 };
+
+  std::unique_ptr<Writer> _writer;
+  QString _filename;
+
+  std::thread _worker;
+  mutable std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<Slice> _queue;
+  bool _all_produced = false;
+  std::atomic_bool _cancelled = { false };
+  std::atomic_bool _finished = { false };
+  QString _error;
+
+  // return false when there are no more slices
+  bool makeSlice(Slice& slice);
+
+  bool writeSlice(const Slice& slice);
+
+  void workerLoop();
+
+  void setError(const QString& error);
+};
+
+#endif  // RANGE_EXPORTER_H
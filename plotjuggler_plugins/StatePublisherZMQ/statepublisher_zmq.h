@@ -11,7 +11,7 @@
 class StatePublisherZMQ : public QObject, StatePublisher
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.StatePublisher")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.StatePublisher/2")
   Q_INTERFACES(PJ::StatePublisher)
 
 public:
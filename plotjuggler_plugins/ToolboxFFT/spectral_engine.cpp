@@ -0,0 +1,391 @@
+#include "spectral_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+// M_PI is not defined by every compiler
+constexpr double PI = 3.14159265358979323846;
+
+// resampled values processed at once, to bound the memory used by long series
+constexpr size_t RESAMPLE_CHUNK = 1024 * 1024;
+
+// segments computed by each thread before their results are accumulated
+constexpr size_t SEGMENTS_PER_THREAD = 32;
+
+// call func(first, last, thread) on "threads" contiguous parts of [0, count)
+template <typename Function>
+void parallelFor(size_t count, size_t threads, const Function& func)
+{
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; t++)
+  {
+    workers.emplace_back(func, t * count / threads, (t + 1) * count / threads, t);
+  }
+  // the calling thread does its part too
+  func(0, count / threads, 0);
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+}
+}  // namespace
+
+FFTPlanCache::~FFTPlanCache()
+{
+  for (auto& it : _entries)
+  {
+    for (auto plan : it.second.plans)
+    {
+      kiss_fftr_free(plan);
+    }
+  }
+}
+
+void FFTPlanCache::prepare(size_t nfft, size_t threads)
+{
+  auto& entry = _entries[nfft];
+  entry.last_used = ++_use_counter;
+  while (entry.plans.size() < threads)
+  {
+    entry.plans.push_back(kiss_fftr_alloc(int(nfft), 0, nullptr, nullptr));
+  }
+
+  if (_entries.size() > MAX_SIZES)
+  {
+    auto oldest = std::min_element(_entries.begin(), _entries.end(), [](auto& a, auto& b) {
+      return a.second.last_used < b.second.last_used;
+    });
+    release(oldest->first);
+  }
+}
+
+kiss_fftr_cfg FFTPlanCache::plan(size_t nfft, size_t thread) const
+{
+  return _entries.at(nfft).plans.at(thread);
+}
+
+void FFTPlanCache::release(size_t nfft)
+{
+  auto it = _entries.find(nfft);
+  if (it != _entries.end())
+  {
+    for (auto plan : it->second.plans)
+    {
+      kiss_fftr_free(plan);
+    }
+    _entries.erase(it);
+  }
+}
+
+//---------------------------------------------------------
+
+double UniformResampler::medianInterval(const PJ::PlotData& data, size_t first, size_t last)
+{
+  last = std::min({ last, data.size(), first + 10001 });
+  if (last < first + 2)
+  {
+    return 0;
+  }
+  std::vector<double> intervals;
+  intervals.reserve(last - first - 1);
+  for (size_t i = first + 1; i < last; i++)
+  {
+    intervals.push_back(data[i].x - data[i - 1].x);
+  }
+  auto median = intervals.begin() + intervals.size() / 2;
+  std::nth_element(intervals.begin(), median, intervals.end());
+  return *median;
+}
+
+void UniformResampler::reset(double start_time, double dt)
+{
+  _start_time = start_time;
+  _dt = dt;
+  _count = 0;
+  _hint = 0;
+}
+
+size_t UniformResampler::resample(const PJ::PlotData& data, double end_time, size_t max_count,
+                                  std::vector<kiss_fft_scalar>& output)
+{
+  const size_t size = data.size();
+  if (size == 0 || _dt <= 0)
+  {
+    return 0;
+  }
+  end_time = std::min(end_time, data.back().x);
+  double time = nextTime();
+  if (time > end_time || time < data.front().x)
+  {
+    return 0;
+  }
+
+  // last sample at or before "time"
+  size_t index = _hint;
+  if (index >= size || data[index].x > time || (index + 1 < size && data[index + 1].x <= time))
+  {
+    auto it = std::upper_bound(data.begin(), data.end(), time,
+                               [](double t, const PJ::PlotData::Point& p) { return t < p.x; });
+    index = size_t(it - data.begin()) - 1;
+  }
+
+  size_t appended = 0;
+  while (appended < max_count && time <= end_time)
+  {
+    while (index + 1 < size && data[index + 1].x <= time)
+    {
+      index++;
+    }
+    const auto& p0 = data[index];
+    double value = p0.y;
+    if (index + 1 < size)
+    {
+      const auto& p1 = data[index + 1];
+      value += (p1.y - p0.y) * (time - p0.x) / (p1.x - p0.x);
+    }
+    output.push_back(static_cast<kiss_fft_scalar>(value));
+    appended++;
+    _count++;
+    time = nextTime();
+  }
+  _hint = index;
+  return appended;
+}
+
+//---------------------------------------------------------
+
+SpectralEngine::SpectralEngine(FFTPlanCache* plans) : _plans(plans)
+{
+  reset(_options);
+}
+
+void SpectralEngine::reset(const Options& options)
+{
+  _options = options;
+  // kiss_fftr requires an even size
+  _options.segment_size = std::max<size_t>(8, _options.segment_size & ~size_t(1));
+  _options.overlap = std::clamp(_options.overlap, 0.0, 0.95);
+
+  const size_t size = _options.segment_size;
+  _window.resize(size);
+  _window_power = 0;
+  for (size_t i = 0; i < size; i++)
+  {
+    // periodic Hann window
+    const double w = 0.5 - 0.5 * std::cos(2.0 * PI * double(i) / double(size));
+    _window[i] = static_cast<kiss_fft_scalar>(w);
+    _window_power += w * w;
+  }
+
+  _resampler.reset(0, 0);
+  _started = false;
+  _tail.clear();
+  _tail_time = 0;
+  _psd_sum.assign(binCount(), 0.0);
+  _segment_count = 0;
+  _columns.clear();
+  _segments_per_column = 1;
+}
+
+double SpectralEngine::sampleRate() const
+{
+  return (_resampler.dt() > 0) ? 1.0 / _resampler.dt() : 0.0;
+}
+
+size_t SpectralEngine::hop() const
+{
+  const double hop = double(_options.segment_size) * (1.0 - _options.overlap);
+  return std::max<size_t>(1, size_t(hop));
+}
+
+size_t SpectralEngine::update(const PJ::PlotData& data, double t_min, double t_max)
+{
+  if (data.size() < 2)
+  {
+    return 0;
+  }
+  if (!_started || _resampler.nextTime() < data.front().x)
+  {
+    // first call, or the samples that follow the processed ones were removed (buffer)
+    auto first = std::lower_bound(data.begin(), data.end(), t_min,
+                                  [](const PJ::PlotData::Point& p, double t) { return p.x < t; });
+    if (first == data.end())
+    {
+      return 0;
+    }
+    const size_t first_index = size_t(first - data.begin());
+    double dt = _resampler.dt();
+    if (!_started)
+    {
+      auto last = std::upper_bound(first, data.end(), t_max,
+                                   [](double t, const PJ::PlotData::Point& p) { return t < p.x; });
+      const size_t last_index = size_t(last - data.begin());
+      // wait for a segment worth of samples, to estimate the sampling interval
+      if (last_index < first_index + _options.segment_size)
+      {
+        return 0;
+      }
+      dt = UniformResampler::medianInterval(data, first_index, last_index);
+    }
+    if (dt <= 0)
+    {
+      return 0;
+    }
+    _resampler.reset(first->x, dt);
+    _tail.clear();
+    _tail_time = first->x;
+    _started = true;
+  }
+
+  size_t new_segments = 0;
+  while (true)
+  {
+    const size_t count = _resampler.resample(data, t_max, RESAMPLE_CHUNK, _tail);
+    new_segments += processTail();
+    if (count < RESAMPLE_CHUNK)
+    {
+      break;
+    }
+  }
+  return new_segments;
+}
+
+size_t SpectralEngine::processTail()
+{
+  const size_t size = _options.segment_size;
+  const size_t step = hop();
+  if (_tail.size() < size)
+  {
+    return 0;
+  }
+  const size_t count = (_tail.size() - size) / step + 1;
+  const size_t bins = binCount();
+  const double dt = _resampler.dt();
+  // one-sided PSD: the power of the negative frequencies is added to the positive ones
+  const double scale = dt / _window_power;
+  const kiss_fft_scalar* window = _window.data();
+  const bool remove_average = _options.remove_average;
+
+  const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+  const size_t threads =
+      std::min(max_threads, (count + SEGMENTS_PER_THREAD - 1) / SEGMENTS_PER_THREAD);
+  _plans->prepare(size, threads);
+
+  const size_t batch_size = std::min(count, threads * SEGMENTS_PER_THREAD);
+  std::vector<float> results(batch_size * bins);
+
+  for (size_t batch_first = 0; batch_first < count; batch_first += batch_size)
+  {
+    const size_t batch_count = std::min(batch_size, count - batch_first);
+
+    auto compute = [&](size_t first, size_t last, size_t thread) {
+      kiss_fftr_cfg plan = _plans->plan(size, thread);
+      std::vector<kiss_fft_scalar> input(size);
+      std::vector<kiss_fft_cpx> output(bins);
+
+      for (size_t s = first; s < last; s++)
+      {
+        const kiss_fft_scalar* segment = _tail.data() + (batch_first + s) * step;
+        double average = 0;
+        if (remove_average)
+        {
+          for (size_t i = 0; i < size; i++)
+          {
+            average += segment[i];
+          }
+          average /= double(size);
+        }
+        for (size_t i = 0; i < size; i++)
+        {
+          input[i] = static_cast<kiss_fft_scalar>((segment[i] - average) * window[i]);
+        }
+        kiss_fftr(plan, input.data(), output.data());
+
+        float* psd = results.data() + s * bins;
+        for (size_t k = 0; k < bins; k++)
+        {
+          const double re = output[k].r;
+          const double im = output[k].i;
+          const double power = re * re + im * im;
+          const bool doubled = (k != 0 && k != bins - 1);
+          psd[k] = static_cast<float>(power * scale * (doubled ? 2.0 : 1.0));
+        }
+      }
+    };
+    parallelFor(batch_count, std::min(threads, batch_count), compute);
+
+    for (size_t s = 0; s < batch_count; s++)
+    {
+      addSegment(results.data() + s * bins, _tail_time + double((batch_first + s) * step) * dt);
+    }
+  }
+
+  _tail.erase(_tail.begin(), _tail.begin() + count * step);
+  _tail_time += double(count * step) * dt;
+  return count;
+}
+
+void SpectralEngine::addSegment(const float* psd, double start_time)
+{
+  const size_t bins = binCount();
+  for (size_t k = 0; k < bins; k++)
+  {
+    _psd_sum[k] += psd[k];
+  }
+  _segment_count++;
+
+  if (_columns.empty() || _columns.back().segments >= _segments_per_column)
+  {
+    Column column;
+    column.start_time = start_time;
+    column.psd.assign(bins, 0.0f);
+    _columns.push_back(std::move(column));
+  }
+  Column& column = _columns.back();
+  column.segments++;
+  column.end_time = start_time + double(hop()) * _resampler.dt();
+  const float ratio = 1.0f / float(column.segments);
+  for (size_t k = 0; k < bins; k++)
+  {
+    column.psd[k] += (psd[k] - column.psd[k]) * ratio;
+  }
+
+  if (_columns.size() > MAX_COLUMNS)
+  {
+    std::deque<Column> merged;
+    for (size_t i = 0; i < _columns.size(); i += 2)
+    {
+      Column& a = _columns[i];
+      if (i + 1 < _columns.size())
+      {
+        const Column& b = _columns[i + 1];
+        const float weight_a = float(a.segments) / float(a.segments + b.segments);
+        for (size_t k = 0; k < bins; k++)
+        {
+          a.psd[k] = a.psd[k] * weight_a + b.psd[k] * (1.0f - weight_a);
+        }
+        a.segments += b.segments;
+        a.end_time = b.end_time;
+      }
+      merged.push_back(std::move(a));
+    }
+    _columns = std::move(merged);
+    _segments_per_column *= 2;
+  }
+}
+
+std::vector<double> SpectralEngine::powerSpectralDensity() const
+{
+  std::vector<double> psd(_psd_sum.size(), 0.0);
+  if (_segment_count > 0)
+  {
+    for (size_t k = 0; k < psd.size(); k++)
+    {
+      psd[k] = _psd_sum[k] / double(_segment_count);
+    }
+  }
+  return psd;
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <vector>
+#include "PlotJuggler/plotdata.h"
+#include "KissFFT/kiss_fftr.h"
+
+/**
+ * Real FFT plans (kiss_fftr configurations) of the last sizes used.
+ * A plan has its own scratch buffer, therefore each thread needs its own copy.
+ */
+class FFTPlanCache
+{
+public:
+  FFTPlanCache() = default;
+
+  FFTPlanCache(const FFTPlanCache&) = delete;
+  FFTPlanCache& operator=(const FFTPlanCache&) = delete;
+
+  ~FFTPlanCache();
+
+  /// Create the plans of size "nfft" for "threads" threads, if missing. Not thread-safe.
+  void prepare(size_t nfft, size_t threads);
+
+  /// Plan of size "nfft" for the thread number "thread". prepare() must be called first.
+  kiss_fftr_cfg plan(size_t nfft, size_t thread) const;
+
+  /// Free the plans of size "nfft".
+  void release(size_t nfft);
+
+private:
+  static constexpr size_t MAX_SIZES = 4;
+
+  struct Entry
+  {
+    std::vector<kiss_fftr_cfg> plans;
+    size_t last_used = 0;
+  };
+  std::map<size_t, Entry> _entries;
+  size_t _use_counter = 0;
+};
+
+/**
+ * Linear interpolation of a time series on a uniform grid.
+ * The grid continues across calls, to process a series while it grows.
+ */
+class UniformResampler
+{
+public:
+  /// Median of the intervals between the samples [first, last), estimated on at most
+  /// 10000 of them. Unlike the average, it isn't affected by gaps and duplicates.
+  static double medianInterval(const PJ::PlotData& data, size_t first, size_t last);
+
+  void reset(double start_time, double dt);
+
+  double dt() const
+  {
+    return _dt;
+  }
+
+  /// Time of the next value of the grid.
+  double nextTime() const
+  {
+    return _start_time + double(_count) * _dt;
+  }
+
+  /// Append to "output" the values at the times of the grid up to "end_time" and to the
+  /// last sample of "data", at most "max_count" of them. Return the number of values.
+  size_t resample(const PJ::PlotData& data, double end_time, size_t max_count,
+                  std::vector<kiss_fft_scalar>& output);
+
+private:
+  double _start_time = 0;
+  double _dt = 0;
+  size_t _count = 0;
+  size_t _hint = 0;
+};
+
+/**
+ * Welch estimate of the power spectral density and Short-Time Fourier Transform.
+ *
+ * The series is resampled on a uniform grid and split in overlapping segments, multiplied
+ * by a Hann window. The periodograms of the segments are computed in parallel, with the
+ * FFT plans of the cache. update() can be called again when new samples are available:
+ * only the new segments are processed.
+ */
+class SpectralEngine
+{
+public:
+  struct Options
+  {
+    // power of 2 is faster
+    size_t segment_size = 4096;
+    // fraction of a segment shared with the next one, in [0, 1)
+    double overlap = 0.5;
+    // remove the average of each segment (DC, 0 Hz)
+    bool remove_average = false;
+  };
+
+  // column of the spectrogram: average PSD of consecutive segments
+  struct Column
+  {
+    double start_time = 0;
+    double end_time = 0;
+    size_t segments = 0;
+    std::vector<float> psd;
+  };
+
+  // when exceeded, the adjacent columns of the spectrogram are merged in pairs
+  static constexpr size_t MAX_COLUMNS = 1024;
+
+  explicit SpectralEngine(FFTPlanCache* plans);
+
+  /// Forget the data processed.
+  void reset(const Options& options);
+
+  /// Process the samples of "data" in [t_min, t_max] that follow the ones processed
+  /// already. Return the number of new segments.
+  size_t update(const PJ::PlotData& data, double t_min, double t_max);
+
+  const Options& options() const
+  {
+    return _options;
+  }
+
+  /// Zero until the first update().
+  double sampleRate() const;
+
+  size_t segmentCount() const
+  {
+    return _segment_count;
+  }
+
+  /// Number of frequencies of powerSpectralDensity() and of the columns.
+  size_t binCount() const
+  {
+    return _options.segment_size / 2 + 1;
+  }
+
+  double frequency(size_t bin) const
+  {
+    return double(bin) * sampleRate() / double(_options.segment_size);
+  }
+
+  /// One-sided PSD, average of the periodograms of all the segments (units^2 / Hz).
+  std::vector<double> powerSpectralDensity() const;
+
+  const std::deque<Column>& spectrogram() const
+  {
+    return _columns;
+  }
+
+private:
+  FFTPlanCache* _plans;
+  Options _options;
+  std::vector<kiss_fft_scalar> _window;
+  double _window_power = 0;
+
+  UniformResampler _resampler;
+  bool _started = false;
+  // resampled values that are not part of a segment yet, the first at _tail_time
+  std::vector<kiss_fft_scalar> _tail;
+  double _tail_time = 0;
+
+  std::vector<double> _psd_sum;
+  size_t _segment_count = 0;
+  std::deque<Column> _columns;
+  size_t _segments_per_column = 1;
+
+  size_t hop() const;
+
+  // compute the complete segments of _tail and remove them
+  size_t processTail();
+
+  void addSegment(const float* psd, double start_time);
+};
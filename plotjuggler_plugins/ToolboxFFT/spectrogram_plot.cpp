@@ -0,0 +1,70 @@
+#include "spectrogram_plot.h"
+
+#include "qwt_color_map.h"
+#include "qwt_matrix_raster_data.h"
+#include "qwt_plot.h"
+#include "qwt_plot_spectrogram.h"
+
+SpectrogramPlot::SpectrogramPlot(QWidget* parent) : PJ::PlotWidgetBase(parent)
+{
+}
+
+SpectrogramPlot::~SpectrogramPlot()
+{
+  clearSpectrogram();
+}
+
+void SpectrogramPlot::setSpectrogram(const QVector<double>& values, int columns,
+                                     QwtInterval time_range, QwtInterval frequency_range,
+                                     QwtInterval value_range)
+{
+  if (!_spectrogram)
+  {
+    _spectrogram = new QwtPlotSpectrogram();
+    // the image is rendered by all the cores
+    _spectrogram->setRenderThreadCount(0);
+
+    auto color_map = new QwtLinearColorMap(Qt::darkBlue, Qt::darkRed);
+    color_map->addColorStop(0.25, Qt::cyan);
+    color_map->addColorStop(0.5, Qt::green);
+    color_map->addColorStop(0.75, Qt::yellow);
+    _spectrogram->setColorMap(color_map);
+    _spectrogram->attach(qwtPlot());
+  }
+
+  auto raster = new QwtMatrixRasterData();
+  raster->setValueMatrix(values, columns);
+  raster->setInterval(Qt::XAxis, time_range);
+  raster->setInterval(Qt::YAxis, frequency_range);
+  raster->setInterval(Qt::ZAxis, value_range);
+  // the previous data is deleted
+  _spectrogram->setData(raster);
+  replot();
+}
+
+void SpectrogramPlot::clearSpectrogram()
+{
+  if (_spectrogram)
+  {
+    _spectrogram->detach();
+    delete _spectrogram;
+    _spectrogram = nullptr;
+    replot();
+  }
+}
+
+void SpectrogramPlot::resetZoom()
+{
+  if (!_spectrogram)
+  {
+    PJ::PlotWidgetBase::resetZoom();
+    return;
+  }
+  const QwtRasterData* raster = _spectrogram->data();
+  const QwtInterval time_range = raster->interval(Qt::XAxis);
+  const QwtInterval frequency_range = raster->interval(Qt::YAxis);
+  qwtPlot()->setAxisScale(QwtPlot::xBottom, time_range.minValue(), time_range.maxValue());
+  qwtPlot()->setAxisScale(QwtPlot::yLeft, frequency_range.minValue(), frequency_range.maxValue());
+  qwtPlot()->updateAxes();
+  replot();
+}
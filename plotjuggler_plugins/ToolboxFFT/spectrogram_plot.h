@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QVector>
+#include "PlotJuggler/plotwidget_base.h"
+#include "qwt_interval.h"
+
+class QwtPlotSpectrogram;
+
+/**
+ * PlotWidgetBase that can also show a spectrogram: a matrix of values, with time on
+ * the X axis and frequency on the Y axis.
+ */
+class SpectrogramPlot : public PJ::PlotWidgetBase
+{
+public:
+  SpectrogramPlot(QWidget* parent);
+
+  ~SpectrogramPlot() override;
+
+  /// "values" has one row per frequency (the first is the lowest) and "columns" columns.
+  void setSpectrogram(const QVector<double>& values, int columns, QwtInterval time_range,
+                      QwtInterval frequency_range, QwtInterval value_range);
+
+  void clearSpectrogram();
+
+  bool hasSpectrogram() const
+  {
+    return _spectrogram != nullptr;
+  }
+
+  void resetZoom() override;
+
+private:
+  QwtPlotSpectrogram* _spectrogram = nullptr;
+};
@@ -6,12 +6,29 @@
 #include <QMimeData>
 #include <QDebug>
 #include <QDragEnterEvent>
+#include <QMessageBox>
 #include <QSettings>
+#include <cmath>
 
 #include "PlotJuggler/transform_function.h"
 #include "PlotJuggler/svg_util.h"
 #include "KissFFT/kiss_fftr.h"
 
+namespace
+{
+// FFTs longer than this don't keep their plan in the cache
+constexpr size_t MAX_CACHED_FFT_SIZE = 1024 * 1024;
+
+// resampled values of the whole range FFT. Those after them are ignored
+constexpr size_t MAX_WHOLE_RANGE_SIZE = 16 * 1024 * 1024;
+
+// rows of the spectrogram image, i.e. the vertical resolution
+constexpr size_t MAX_SPECTROGRAM_ROWS = 1024;
+
+// range of the colors of the spectrogram, below the maximum
+constexpr double SPECTROGRAM_RANGE_DB = 100.0;
+}  // namespace
+
 ToolboxFFT::ToolboxFFT()
 {
   _widget = new QWidget(nullptr);
@@ -26,6 +43,23 @@ ToolboxFFT::ToolboxFFT()
   connect(ui->pushButtonSave, &QPushButton::clicked, this, &ToolboxFFT::onSaveCurve);
 
   connect(ui->pushButtonClear, &QPushButton::clicked, this, &ToolboxFFT::onClearCurves);
+
+  connect(ui->comboMethod, qOverload<int>(&QComboBox::currentIndexChanged), this,
+          &ToolboxFFT::onMethodChanged);
+
+  _live_timer.setInterval(500);
+  connect(&_live_timer, &QTimer::timeout, this, &ToolboxFFT::onLiveUpdate);
+
+  connect(ui->checkLiveUpdate, &QCheckBox::toggled, this, [this](bool checked) {
+    if (checked)
+    {
+      _live_timer.start();
+    }
+    else
+    {
+      _live_timer.stop();
+    }
+  });
 }
 
 ToolboxFFT::~ToolboxFFT()
@@ -39,7 +73,7 @@ void ToolboxFFT::init(PJ::PlotDataMapRef& src_data, PJ::TransformsMap& transform
   _transforms = &transform_map;
 
   _plot_widget_A = new PJ::PlotWidgetBase(ui->framePlotPreviewA);
-  _plot_widget_B = new PJ::PlotWidgetBase(ui->framePlotPreviewB);
+  _plot_widget_B = new SpectrogramPlot(ui->framePlotPreviewB);
 
   auto preview_layout_A = new QHBoxLayout(ui->framePlotPreviewA);
   preview_layout_A->setMargin(6);
@@ -75,6 +109,50 @@ bool ToolboxFFT::onShowWidget()
 void ToolboxFFT::calculateCurveFFT()
 {
   _plot_widget_B->removeAllCurves();
+  _plot_widget_B->clearSpectrogram();
+  _local_data.scatter_xy.clear();
+  _engines.clear();
+
+  _engines_method = static_cast<Method>(ui->comboMethod->currentIndex());
+  if (_engines_method == FFT_WHOLE_RANGE)
+  {
+    calculateWholeRangeFFT();
+    return;
+  }
+
+  _engines_range.min = std::numeric_limits<double>::lowest();
+  _engines_range.max = std::numeric_limits<double>::max();
+  if (ui->radioZoomed->isChecked())
+  {
+    _engines_range = _zoom_range;
+  }
+
+  SpectralEngine::Options options;
+  options.segment_size = ui->comboSegmentSize->currentText().toUInt();
+  options.remove_average = ui->checkAverage->isChecked();
+
+  QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+  for (const auto& curve_id : _curve_names)
+  {
+    auto it = _plot_data->numeric.find(curve_id);
+    if (it == _plot_data->numeric.end())
+    {
+      continue;
+    }
+    auto engine = std::make_unique<SpectralEngine>(&_fft_plans);
+    engine->reset(options);
+    engine->update(it->second, _engines_range.min, _engines_range.max);
+    _engines[curve_id] = std::move(engine);
+  }
+  QApplication::restoreOverrideCursor();
+
+  updateSpectralOutput();
+  _plot_widget_B->resetZoom();
+}
+
+void ToolboxFFT::calculateWholeRangeFFT()
+{
+  QStringList truncated_curves;
 
   for (const auto& curve_id : _curve_names)
   {
@@ -99,55 +177,55 @@ void ToolboxFFT::calculateCurveFFT()
       max_index = curve_data.getIndexFromX(_zoom_range.max);
     }
 
-    size_t N = 1 + max_index - min_index;
+    // resample on a uniform grid, with the typical interval between the samples
+    double dT = UniformResampler::medianInterval(curve_data, min_index, max_index + 1);
+    if (dT <= 0)
+    {
+      return;
+    }
+    UniformResampler resampler;
+    resampler.reset(curve_data.at(min_index).x, dT);
 
-    if (N & 1)
-    {  // if not even, make it even
-      N--;
-      max_index--;
+    const double end_time = curve_data.at(max_index).x;
+    std::vector<kiss_fft_scalar> input;
+    resampler.resample(curve_data, end_time, MAX_WHOLE_RANGE_SIZE, input);
+    if (resampler.nextTime() <= end_time)
+    {
+      truncated_curves.push_back(QString::fromStdString(curve_id));
     }
 
+    // kiss_fftr requires an even size
+    size_t N = input.size() & ~size_t(1);
     if (N < 8)
     {
       return;
     }
+    input.resize(N);
 
-    double dT = (curve_data.at(max_index).x - curve_data.at(min_index).x) / double(N - 1);
-
-    std::vector<kiss_fft_scalar> input;
-    input.reserve(curve_data.size());
-
-    double sum = 0;
     if (ui->checkAverage->isChecked())
     {
-      for (size_t i = 0; i < N; i++)
+      double sum = 0;
+      for (auto value : input)
       {
-        sum += curve_data[i + min_index].y;
+        sum += value;
       }
-    }
-    double average = sum / double(N);
-
-    for (size_t i = 0; i < N; i++)
-    {
-      size_t index = i + min_index;
-      const auto& p = curve_data[index];
-      input.push_back(static_cast<kiss_fft_scalar>(p.y - average));
-
-      if (i != 0)
+      const double average = sum / double(N);
+      for (auto& value : input)
       {
-        double dTi = (p.x - curve_data[index - 1].x);
-        double diff = dTi - dT;
-        // std_dev += diff*diff;
+        value = static_cast<kiss_fft_scalar>(value - average);
       }
     }
-    // std_dev = sqrt(std_dev / double(N-1) );
 
     std::vector<kiss_fft_cpx> out(N / 2 + 1);
 
-    auto config = kiss_fftr_alloc(N, false, nullptr, nullptr);
-
     QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-    kiss_fftr(config, input.data(), out.data());
+    _fft_plans.prepare(N, 1);
+    kiss_fftr(_fft_plans.plan(N, 0), input.data(), out.data());
+    if (N > MAX_CACHED_FFT_SIZE)
+    {
+      // the plan is as large as the data: don't keep it
+      _fft_plans.release(N);
+    }
     QApplication::restoreOverrideCursor();
 
     auto& curver_fft = _local_data.getOrCreateScatterXY(curve_id);
@@ -167,11 +245,131 @@ void ToolboxFFT::calculateCurveFFT()
     }
 
     _plot_widget_B->addCurve(curve_id + "_FFT", curver_fft, color);
-
-    free(config);
   }
 
   _plot_widget_B->resetZoom();
+
+  if (!truncated_curves.empty())
+  {
+    QMessageBox::warning(_widget, tr("FFT"),
+                         tr("The FFT was calculated on the first %1 samples (resampled) of:\n\n"
+                            "%2\n\nZoom in or use the Welch PSD to analyze the whole range.")
+                             .arg(MAX_WHOLE_RANGE_SIZE)
+                             .arg(truncated_curves.join("\n")));
+  }
+}
+
+void ToolboxFFT::updateSpectralOutput()
+{
+  if (_engines_method == SPECTROGRAM)
+  {
+    // a single spectrogram can be shown: the one of the first curve
+    auto it = _engines.end();
+    for (size_t i = 0; i < _curve_names.size() && it == _engines.end(); i++)
+    {
+      it = _engines.find(_curve_names[i]);
+    }
+    if (it == _engines.end() || it->second->spectrogram().empty())
+    {
+      return;
+    }
+    const SpectralEngine& engine = *it->second;
+    const auto& columns = engine.spectrogram();
+
+    // adjacent frequencies are averaged, to limit the size of the image
+    const size_t bins = engine.binCount();
+    const size_t bins_per_row = (bins + MAX_SPECTROGRAM_ROWS - 1) / MAX_SPECTROGRAM_ROWS;
+    const size_t rows = (bins + bins_per_row - 1) / bins_per_row;
+    const size_t cols = columns.size();
+
+    QVector<double> values(int(rows * cols));
+    double max_db = std::numeric_limits<double>::lowest();
+    for (size_t c = 0; c < cols; c++)
+    {
+      const auto& psd = columns[c].psd;
+      for (size_t r = 0; r < rows; r++)
+      {
+        const size_t first = r * bins_per_row;
+        const size_t last = std::min(first + bins_per_row, bins);
+        double sum = 0;
+        for (size_t k = first; k < last; k++)
+        {
+          sum += psd[k];
+        }
+        const double db = 10.0 * std::log10(std::max(sum / double(last - first), 1e-30));
+        values[int(r * cols + c)] = db;
+        max_db = std::max(max_db, db);
+      }
+    }
+    _plot_widget_B->setSpectrogram(
+        values, int(cols), QwtInterval(columns.front().start_time, columns.back().end_time),
+        QwtInterval(0, engine.frequency(bins - 1)),
+        QwtInterval(max_db - SPECTROGRAM_RANGE_DB, max_db));
+    return;
+  }
+
+  for (const auto& curve_id : _curve_names)
+  {
+    auto it = _engines.find(curve_id);
+    if (it == _engines.end())
+    {
+      continue;
+    }
+    const SpectralEngine& engine = *it->second;
+    const auto psd = engine.powerSpectralDensity();
+
+    auto& curve_psd = _local_data.getOrCreateScatterXY(curve_id);
+    curve_psd.clear();
+    for (size_t k = 0; k < psd.size() && engine.segmentCount() > 0; k++)
+    {
+      curve_psd.pushBack({ engine.frequency(k), psd[k] });
+    }
+
+    const std::string curve_name = curve_id + "_PSD";
+    if (!_plot_widget_B->curveFromTitle(QString::fromStdString(curve_name)))
+    {
+      QColor color = Qt::transparent;
+      auto colorHint = _plot_data->numeric.at(curve_id).attribute(COLOR_HINT);
+      if (colorHint.isValid())
+      {
+        color = colorHint.value<QColor>();
+      }
+      _plot_widget_B->addCurve(curve_name, curve_psd, color);
+    }
+  }
+  _plot_widget_B->replot();
+}
+
+void ToolboxFFT::onMethodChanged()
+{
+  const bool segments = (ui->comboMethod->currentIndex() != FFT_WHOLE_RANGE);
+  ui->comboSegmentSize->setEnabled(segments);
+  ui->checkLiveUpdate->setEnabled(segments);
+  if (!segments)
+  {
+    ui->checkLiveUpdate->setChecked(false);
+  }
+  // a spectrogram can't be saved as a curve
+  const bool can_save = (ui->comboMethod->currentIndex() != SPECTROGRAM);
+  ui->pushButtonSave->setEnabled(can_save && !_curve_names.empty());
+  ui->lineEditSuffix->setEnabled(can_save && !_curve_names.empty());
+}
+
+void ToolboxFFT::onLiveUpdate()
+{
+  size_t new_segments = 0;
+  for (auto& it : _engines)
+  {
+    auto data_it = _plot_data->numeric.find(it.first);
+    if (data_it != _plot_data->numeric.end())
+    {
+      new_segments += it.second->update(data_it->second, _engines_range.min, _engines_range.max);
+    }
+  }
+  if (new_segments > 0)
+  {
+    updateSpectralOutput();
+  }
 }
 
 void ToolboxFFT::onClearCurves()
@@ -189,6 +387,8 @@ void ToolboxFFT::onClearCurves()
   ui->lineEditSuffix->setText("_FFT");
 
   _curve_names.clear();
+  _engines.clear();
+  _plot_widget_B->clearSpectrogram();
 }
 
 void ToolboxFFT::onDragEnterEvent(QDragEnterEvent* event)
@@ -237,9 +437,8 @@ void ToolboxFFT::onDropEvent(QDropEvent*)
     _zoom_range.max = std::max(_zoom_range.max, curve_data.back().x);
   }
 
-  ui->pushButtonSave->setEnabled(true);
   ui->pushButtonCalculate->setEnabled(true);
-  ui->lineEditSuffix->setEnabled(true);
+  onMethodChanged();
 
   _dragging_curves.clear();
   _plot_widget_A->resetZoom();
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <QtPlugin>
+#include <QTimer>
+#include <memory>
 #include <thread>
 #include "PlotJuggler/toolbox_base.h"
 #include "PlotJuggler/plotwidget_base.h"
+#include "spectral_engine.h"
+#include "spectrogram_plot.h"
 
 namespace Ui
 {
@@ -13,7 +17,7 @@ class toolbox_fft;
 class ToolboxFFT : public PJ::ToolboxPlugin
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.Toolbox")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.Toolbox/2")
   Q_INTERFACES(PJ::ToolboxPlugin)
 
 public:
@@ -43,7 +47,7 @@ private:
   QStringList _dragging_curves;
 
   PJ::PlotWidgetBase* _plot_widget_A = nullptr;
-  PJ::PlotWidgetBase* _plot_widget_B = nullptr;
+  SpectrogramPlot* _plot_widget_B = nullptr;
 
   PJ::PlotDataMapRef* _plot_data = nullptr;
   PJ::TransformsMap* _transforms = nullptr;
@@ -54,6 +58,27 @@ private:
 
   std::vector<std::string> _curve_names;
 
+  enum Method
+  {
+    FFT_WHOLE_RANGE = 0,
+    WELCH_PSD = 1,
+    SPECTROGRAM = 2
+  };
+
+  FFTPlanCache _fft_plans;
+
+  // one per curve, used by WELCH_PSD and SPECTROGRAM
+  std::map<std::string, std::unique_ptr<SpectralEngine>> _engines;
+
+  Range _engines_range;
+  Method _engines_method = WELCH_PSD;
+
+  QTimer _live_timer;
+
+  void calculateWholeRangeFFT();
+
+  void updateSpectralOutput();
+
 private slots:
 
   void onDragEnterEvent(QDragEnterEvent* event);
@@ -62,4 +87,6 @@ private slots:
   void onSaveCurve();
   void calculateCurveFFT();
   void onClearCurves();
+  void onMethodChanged();
+  void onLiveUpdate();
 };
@@ -21,7 +21,7 @@ class LuaEditor;
 class ToolboxLuaEditor : public PJ::ToolboxPlugin
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.Toolbox")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.Toolbox/2")
   Q_INTERFACES(PJ::ToolboxPlugin)
 
 public:
@@ -1,4 +1,5 @@
 #include "quaternion_to_rpy.h"
+#include <algorithm>
 #include <array>
 #include <math.h>
 
@@ -16,6 +17,7 @@ void QuaternionToRollPitchYaw::reset()
   _pitch_offset = 0;
   _yaw_offset = 0;
   _last_timestamp = std::numeric_limits<double>::lowest();
+  _last_timestamp_count = 0;
 }
 
 void QuaternionToRollPitchYaw::calculate()
@@ -33,118 +35,155 @@ void QuaternionToRollPitchYaw::calculate()
   data_pitch.setMaximumRangeX(data_x.maximumRangeX());
   data_yaw.setMaximumRangeX(data_x.maximumRangeX());
 
-  data_roll.clear();
-  data_pitch.clear();
-  data_yaw.clear();
-
   if (data_x.size() == 0 || data_x.size() != data_y.size() || data_y.size() != data_z.size() ||
       data_z.size() != data_w.size())
   {
     return;
   }
 
-  int pos = data_x.getIndexFromX(_last_timestamp);
-  size_t index = pos < 0 ? 0 : static_cast<size_t>(pos);
+  if (data_roll.size() == 0 && _last_timestamp != std::numeric_limits<double>::lowest())
+  {
+    // the output was cleared: convert everything again
+    reset();
+  }
+
+  // first sample not converted yet. The samples with the last timestamp are counted,
+  // because the next ones may share it
+  auto first = std::lower_bound(data_x.begin(), data_x.end(), _last_timestamp,
+                                [](const PJ::PlotData::Point& p, double t) { return p.x < t; });
+  const size_t size = data_x.size();
+  size_t index = std::min(size_t(first - data_x.begin()) + _last_timestamp_count, size);
 
-  while (index < data_x.size())
+  while (index < size)
   {
-    auto& point_x = data_x.at(index);
-    double timestamp = point_x.x;
-    double q_x = point_x.y;
-    double q_y = data_y.at(index).y;
-    double q_z = data_z.at(index).y;
-    double q_w = data_w.at(index).y;
-
-    if (timestamp >= _last_timestamp)
+    const size_t count = std::min(BLOCK_SIZE, size - index);
+    _block_time.resize(count);
+    for (auto& vect : _block_quat)
+    {
+      vect.resize(count);
+    }
+    for (auto& vect : _block_rpy)
+    {
+      vect.resize(count);
+    }
+    for (size_t i = 0; i < count; i++)
     {
-      std::array<double, 3> RPY;
-      calculateNextPoint(index, { q_x, q_y, q_z, q_w }, RPY);
+      const auto& point_x = data_x[index + i];
+      _block_time[i] = point_x.x;
+      _block_quat[0][i] = point_x.y;
+      _block_quat[1][i] = data_y[index + i].y;
+      _block_quat[2][i] = data_z[index + i].y;
+      _block_quat[3][i] = data_w[index + i].y;
+    }
 
-      data_roll.pushBack({ timestamp, _scale * (RPY[0] + _roll_offset) });
-      data_pitch.pushBack({ timestamp, _scale * (RPY[1] + _pitch_offset) });
-      data_yaw.pushBack({ timestamp, _scale * (RPY[2] + _yaw_offset) });
+    quaternionToRPY(_block_quat[0].data(), _block_quat[1].data(), _block_quat[2].data(),
+                    _block_quat[3].data(), count, _block_rpy[0].data(), _block_rpy[1].data(),
+                    _block_rpy[2].data());
 
-      _last_timestamp = timestamp;
+    // unwrapping depends on the previous sample: sequential
+    for (size_t i = 0; i < count; i++)
+    {
+      double& roll = _block_rpy[0][i];
+      double& pitch = _block_rpy[1][i];
+      double& yaw = _block_rpy[2][i];
+      if (_last_timestamp != std::numeric_limits<double>::lowest() && _wrap)
+      {
+        unwrap(roll, pitch, yaw);
+      }
+      _prev_roll = roll;
+      _prev_pitch = pitch;
+      _prev_yaw = yaw;
+      _last_timestamp_count = (_block_time[i] == _last_timestamp) ? _last_timestamp_count + 1 : 1;
+      _last_timestamp = _block_time[i];
+
+      roll = _scale * (roll + _roll_offset);
+      pitch = _scale * (pitch + _pitch_offset);
+      yaw = _scale * (yaw + _yaw_offset);
     }
-    index++;
+
+    data_roll.appendSorted(_block_time.data(), _block_rpy[0].data(), count);
+    data_pitch.appendSorted(_block_time.data(), _block_rpy[1].data(), count);
+    data_yaw.appendSorted(_block_time.data(), _block_rpy[2].data(), count);
+    index += count;
   }
 }
 
-void QuaternionToRollPitchYaw::calculateNextPoint(size_t index, const std::array<double, 4>& quat,
-                                                  std::array<double, 3>& rpy)
+void QuaternionToRollPitchYaw::quaternionToRPY(const double* q_x, const double* q_y,
+                                               const double* q_z, const double* q_w, size_t count,
+                                               double* roll, double* pitch, double* yaw)
 {
-  double q_x = quat[0];
-  double q_y = quat[1];
-  double q_z = quat[2];
-  double q_w = quat[3];
-
-  double quat_norm2 = (q_w * q_w) + (q_x * q_x) + (q_y * q_y) + (q_z * q_z);
-  if (std::abs(quat_norm2 - 1.0) > std::numeric_limits<double>::epsilon())
+  for (size_t i = 0; i < count; i++)
   {
-    double mult = 1.0 / std::sqrt(quat_norm2);
-    q_x *= mult;
-    q_y *= mult;
-    q_z *= mult;
-    q_w *= mult;
+    const double norm2 = (q_w[i] * q_w[i]) + (q_x[i] * q_x[i]) + (q_y[i] * q_y[i]) +
+                         (q_z[i] * q_z[i]);
+    const double mult = 1.0 / std::sqrt(norm2);
+    const double x = q_x[i] * mult;
+    const double y = q_y[i] * mult;
+    const double z = q_z[i] * mult;
+    const double w = q_w[i] * mult;
+
+    // roll (x-axis rotation)
+    const double sinr_cosp = 2 * (w * x + y * z);
+    const double cosr_cosp = 1 - 2 * (x * x + y * y);
+    roll[i] = std::atan2(sinr_cosp, cosr_cosp);
+
+    // pitch (y-axis rotation), 90 degrees if out of range. NaN is kept
+    const double sinp = 2 * (w * y - z * x);
+    pitch[i] = (std::abs(sinp) >= 1) ? std::copysign(M_PI_2, sinp) : std::asin(sinp);
+
+    // yaw (z-axis rotation)
+    const double siny_cosp = 2 * (w * z + x * y);
+    const double cosy_cosp = 1 - 2 * (y * y + z * z);
+    yaw[i] = std::atan2(siny_cosp, cosy_cosp);
   }
+}
+
+void QuaternionToRollPitchYaw::calculateNextPoint(size_t index, const std::array<double, 4>& quat,
+                                                  std::array<double, 3>& rpy)
+{
   double roll, pitch, yaw;
-  // roll (x-axis rotation)
-  double sinr_cosp = 2 * (q_w * q_x + q_y * q_z);
-  double cosr_cosp = 1 - 2 * (q_x * q_x + q_y * q_y);
-  roll = std::atan2(sinr_cosp, cosr_cosp);
-
-  // pitch (y-axis rotation)
-  double sinp = 2 * (q_w * q_y - q_z * q_x);
-  if (std::abs(sinp) >= 1)
-  {
-    pitch = std::copysign(M_PI_2, sinp);  // use 90 degrees if out of range
-  }
-  else
+  quaternionToRPY(&quat[0], &quat[1], &quat[2], &quat[3], 1, &roll, &pitch, &yaw);
+
+  if (index != 0 && _wrap)
   {
-    pitch = std::asin(sinp);
+    unwrap(roll, pitch, yaw);
   }
-  // yaw (z-axis rotation)
-  double siny_cosp = 2 * (q_w * q_z + q_x * q_y);
-  double cosy_cosp = 1 - 2 * (q_y * q_y + q_z * q_z);
-  yaw = std::atan2(siny_cosp, cosy_cosp);
+  _prev_pitch = pitch;
+  _prev_roll = roll;
+  _prev_yaw = yaw;
 
+  rpy = { roll, pitch, yaw };
+}
+
+void QuaternionToRollPitchYaw::unwrap(double roll, double pitch, double yaw)
+{
   const double WRAP_ANGLE = M_PI * 2.0;
   const double WRAP_THRESHOLD = M_PI * 1.95;
 
-  //--------- wrap ------
-  if (index != 0 && _wrap)
+  if ((roll - _prev_roll) > WRAP_THRESHOLD)
   {
-    if ((roll - _prev_roll) > WRAP_THRESHOLD)
-    {
-      _roll_offset -= WRAP_ANGLE;
-    }
-    else if ((_prev_roll - roll) > WRAP_THRESHOLD)
-    {
-      _roll_offset += WRAP_ANGLE;
-    }
-
-    if ((pitch - _prev_pitch) > WRAP_THRESHOLD)
-    {
-      _pitch_offset -= WRAP_ANGLE;
-    }
-    else if ((_prev_pitch - pitch) > WRAP_THRESHOLD)
-    {
-      _pitch_offset += WRAP_ANGLE;
-    }
-
-    if ((yaw - _prev_yaw) > WRAP_THRESHOLD)
-    {
-      _yaw_offset -= WRAP_ANGLE;
-    }
-    else if ((_prev_yaw - yaw) > WRAP_THRESHOLD)
-    {
-      _yaw_offset += WRAP_ANGLE;
-    }
+    _roll_offset -= WRAP_ANGLE;
+  }
+  else if ((_prev_roll - roll) > WRAP_THRESHOLD)
+  {
+    _roll_offset += WRAP_ANGLE;
   }
 
-  _prev_pitch = pitch;
-  _prev_roll = roll;
-  _prev_yaw = yaw;
+  if ((pitch - _prev_pitch) > WRAP_THRESHOLD)
+  {
+    _pitch_offset -= WRAP_ANGLE;
+  }
+  else if ((_prev_pitch - pitch) > WRAP_THRESHOLD)
+  {
+    _pitch_offset += WRAP_ANGLE;
+  }
 
-  rpy = { roll, pitch, yaw };
+  if ((yaw - _prev_yaw) > WRAP_THRESHOLD)
+  {
+    _yaw_offset -= WRAP_ANGLE;
+  }
+  else if ((_prev_yaw - yaw) > WRAP_THRESHOLD)
+  {
+    _yaw_offset += WRAP_ANGLE;
+  }
 }
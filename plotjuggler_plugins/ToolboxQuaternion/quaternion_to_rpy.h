@@ -1,6 +1,8 @@
 #ifndef QUATERNION_TO_RPY_H
 #define QUATERNION_TO_RPY_H
 
+#include <array>
+#include <vector>
 #include "PlotJuggler/transform_function.h"
 
 class QuaternionToRollPitchYaw : public PJ::TransformFunction
@@ -35,12 +37,29 @@ public:
     _wrap = wrap;
   }
 
+  /// Convert the samples received since the previous call. The four sources must
+  /// share their timestamps.
   void calculate() override;
 
   void calculateNextPoint(size_t index, const std::array<double, 4>& quat,
                           std::array<double, 3>& rpy);
 
+  /// Convert "count" quaternions to roll, pitch and yaw, without unwrapping.
+  /// The elements are independent, so that the loop can be vectorized.
+  static void quaternionToRPY(const double* q_x, const double* q_y, const double* q_z,
+                              const double* q_w, size_t count, double* roll, double* pitch,
+                              double* yaw);
+
 private:
+  // update the offsets that unwrap the angles, comparing them with the previous ones
+  void unwrap(double roll, double pitch, double yaw);
+
+  // samples converted at once
+  static constexpr size_t BLOCK_SIZE = 4096;
+  std::array<std::vector<double>, 4> _block_quat;
+  std::array<std::vector<double>, 3> _block_rpy;
+  std::vector<double> _block_time;
+
   double _prev_roll = 0;
   double _prev_yaw = 0;
   double _prev_pitch = 0;
@@ -50,6 +69,8 @@ private:
   double _scale = 1.0;
   bool _wrap = true;
   double _last_timestamp = std::numeric_limits<double>::lowest();
+  // converted samples with timestamp equal to _last_timestamp
+  size_t _last_timestamp_count = 0;
 };
 
 #endif  // QUATERNION_TO_RPY_H
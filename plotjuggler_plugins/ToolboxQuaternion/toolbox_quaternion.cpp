@@ -5,7 +5,10 @@
 #include <QEvent>
 #include <QMimeData>
 #include <QDragEnterEvent>
+#include <QRegExp>
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <math.h>
 #include "quaternion_to_rpy.h"
 
@@ -30,6 +33,12 @@ ToolboxQuaternion::ToolboxQuaternion()
 
   connect(ui->pushButtonSave, &QPushButton::clicked, this,
           &ToolboxQuaternion::on_pushButtonSave_clicked);
+
+  connect(ui->lineEditPattern, &QLineEdit::textChanged, this,
+          &ToolboxQuaternion::onPatternChanged);
+
+  connect(ui->pushButtonApplyAll, &QPushButton::clicked, this,
+          &ToolboxQuaternion::onApplyToAllClicked);
 }
 
 ToolboxQuaternion::~ToolboxQuaternion()
@@ -249,3 +258,125 @@ void ToolboxQuaternion::onClosed()
 {
   emit this->closed();
 }
+
+std::vector<std::string> ToolboxQuaternion::matchingPrefixes(const QString& pattern) const
+{
+  std::vector<std::string> prefixes;
+  QRegExp rx(pattern, Qt::CaseSensitive, QRegExp::Wildcard);
+  if (pattern.isEmpty() || !rx.isValid())
+  {
+    return prefixes;
+  }
+
+  for (const auto& it : _plot_data->numeric)
+  {
+    const std::string& name = it.first;
+    if (name.size() < 2 || name.back() != 'x')
+    {
+      continue;
+    }
+    const std::string prefix = name.substr(0, name.size() - 1);
+    const QString qprefix = QString::fromStdString(prefix);
+
+    // "*/orientation" should match the prefix "/imu/orientation/" too
+    if (!rx.exactMatch(qprefix) && !rx.exactMatch(qprefix.left(qprefix.size() - 1)))
+    {
+      continue;
+    }
+    bool complete = true;
+    for (const char* suffix : { "y", "z", "w" })
+    {
+      complete &= (_plot_data->numeric.count(prefix + suffix) != 0);
+    }
+    if (complete)
+    {
+      prefixes.push_back(prefix);
+    }
+  }
+  std::sort(prefixes.begin(), prefixes.end());
+  return prefixes;
+}
+
+void ToolboxQuaternion::onPatternChanged()
+{
+  const auto prefixes = matchingPrefixes(ui->lineEditPattern->text());
+  if (ui->lineEditPattern->text().isEmpty())
+  {
+    ui->labelMatches->clear();
+  }
+  else
+  {
+    ui->labelMatches->setText(tr("%1 found").arg(prefixes.size()));
+  }
+  ui->pushButtonApplyAll->setEnabled(!prefixes.empty());
+}
+
+void ToolboxQuaternion::onApplyToAllClicked()
+{
+  using namespace PJ;
+
+  const bool wrap = ui->checkBoxUnwrap->isChecked();
+  const double unit_scale = ui->radioButtonDegrees->isChecked() ? (180.0 / M_PI) : 1.0;
+
+  // create the transforms and their outputs here: the map of the series can't be
+  // modified by the worker threads
+  std::vector<std::pair<std::string, std::shared_ptr<QuaternionToRollPitchYaw>>> created;
+  for (const auto& prefix : matchingPrefixes(ui->lineEditPattern->text()))
+  {
+    if (_transforms->count(prefix + "RPY") != 0)
+    {
+      continue;  // converted already
+    }
+    std::vector<const PlotData*> src_data;
+    for (const char* suffix : { "x", "y", "z", "w" })
+    {
+      const PlotData& data = _plot_data->numeric.at(prefix + suffix);
+      // size() merges the pending samples: the workers will only read the series
+      data.size();
+      src_data.push_back(&data);
+    }
+    std::vector<PlotData*> dst_vector = { &_plot_data->getOrCreateNumeric(prefix + "roll", {}),
+                                          &_plot_data->getOrCreateNumeric(prefix + "pitch", {}),
+                                          &_plot_data->getOrCreateNumeric(prefix + "yaw", {}) };
+
+    auto transform = std::make_shared<QuaternionToRollPitchYaw>();
+    transform->setData(_plot_data, src_data, dst_vector);
+    transform->setWarp(wrap);
+    transform->setScale(unit_scale);
+    created.push_back({ prefix, transform });
+  }
+
+  // each transform writes only its own outputs: they are computed in parallel
+  std::atomic<size_t> next_index(0);
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < created.size(); i = next_index++)
+    {
+      created[i].second->calculate();
+    }
+  };
+  const size_t threads =
+      std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), created.size());
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; t++)
+  {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : workers)
+  {
+    thread.join();
+  }
+
+  // from now on, they are updated as any other transform
+  for (const auto& [prefix, transform] : created)
+  {
+    _transforms->insert({ prefix + "RPY", transform });
+
+    emit plotCreated(prefix + "roll");
+    emit plotCreated(prefix + "pitch");
+    emit plotCreated(prefix + "yaw");
+  }
+
+  ui->lineEditPattern->setText({});
+  emit this->closed();
+}
@@ -14,7 +14,7 @@ class quaternion_to_RPY;
 class ToolboxQuaternion : public PJ::ToolboxPlugin
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.Toolbox")
+  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.Toolbox/2")
   Q_INTERFACES(PJ::ToolboxPlugin)
 
 public:
@@ -43,6 +43,10 @@ private slots:
 
   void onClosed();
 
+  void onPatternChanged();
+
+  void onApplyToAllClicked();
+
 private:
   QWidget* _widget;
   Ui::quaternion_to_RPY* ui;
@@ -70,4 +74,7 @@ private:
   };
 
   bool generateRPY(GenerateType type);
+
+  // prefixes of the quaternions (series ending with x, y, z and w) that match "pattern"
+  std::vector<std::string> matchingPrefixes(const QString& pattern) const;
 };